@@ -0,0 +1,244 @@
+/****************************************************************************************
+* LcdEmu.c - Host emulation of a Hitachi HD44780-type LCD controller
+*
+*            Stands in for the GPIO bus layer of LcdLayered.c when
+*            APP_CFG_LCD_EMU_EN is enabled in app_cfg.h. Every lcdWrite() is
+*            decoded into an emulated DDRAM/CGRAM so the visible 2x16 text and
+*            cursor state can be read back without hardware.
+*
+*            Only the 2-line, 4-bit configuration that LcdInit() sets up is
+*            modelled. Busy time is not modelled, the LcdLayered delays are
+*            compiled out in emulation.
+*
+*            Needs only the MCUType.h types, no OS or app_cfg.h, so the host
+*            tests build it as it is. LcdLayered.c decides whether it is used.
+*
+* 10/19/2026 First release
+* 10/19/2026 No OS dependency or APP_CFG_LCD_EMU_EN gate
+*****************************************************************************************
+* Header Files - Dependencies
+*****************************************************************************************/
+#include "MCUType.h"
+#include "LcdEmu.h"
+
+/*****************************************************************************************
+* Controller Defines
+*****************************************************************************************/
+#define EMU_DDRAM_SIZE      0x80    /* 7-bit address counter             */
+#define EMU_CGRAM_SIZE      0x40    /* 8 characters x 8 rows             */
+#define EMU_LINE_LEN        40      /* DDRAM characters per line         */
+#define EMU_LINE2_ADDR      0x40
+#define EMU_CLEAR_CHAR      0x20
+
+typedef struct {
+    INT8U ddram[EMU_DDRAM_SIZE];
+    INT8U cgram[EMU_CGRAM_SIZE];
+    INT8U ac;                       /* address counter                   */
+    INT8U cg_sel;                   /* TRUE when AC addresses CGRAM      */
+    INT8U inc;                      /* entry mode I/D                    */
+    INT8U shift_en;                 /* entry mode S                      */
+    INT8U shift;                    /* display shift, 0 - 39             */
+    INT8U disp_on;
+    INT8U cur_on;
+    INT8U blink;
+    INT32U writes;
+} LCD_EMU;
+
+/*************************************************************************
+  Private Resources
+*************************************************************************/
+static LCD_EMU lcdEmu;
+static const INT8U lcdEmuRowAddr[LCD_EMU_ROWS] = {0x00, EMU_LINE2_ADDR};
+
+static void lcdEmuStepAc(void);
+static void lcdEmuShiftDisp(INT8U right);
+
+/*************************************************************************
+  LcdEmuReset() - Puts the controller in its power-on state     (Public)
+*************************************************************************/
+void LcdEmuReset(void) {
+    INT8U i;
+
+    for(i = 0; i < EMU_DDRAM_SIZE; i++) {
+        lcdEmu.ddram[i] = EMU_CLEAR_CHAR;
+    }
+    for(i = 0; i < EMU_CGRAM_SIZE; i++) {
+        lcdEmu.cgram[i] = 0;
+    }
+    lcdEmu.ac = 0;
+    lcdEmu.cg_sel = FALSE;
+    lcdEmu.inc = TRUE;
+    lcdEmu.shift_en = FALSE;
+    lcdEmu.shift = 0;
+    lcdEmu.disp_on = FALSE;
+    lcdEmu.cur_on = FALSE;
+    lcdEmu.blink = FALSE;
+    lcdEmu.writes = 0;
+}
+
+/*************************************************************************
+  LcdEmuWrite() - Decodes one bus write                          (Public)
+
+        data is in the lcdWrite() format: bit 8 is the register select,
+        bits 0-7 are the character or command. Commands are decoded from
+        the highest set bit down, as on the real controller.
+*************************************************************************/
+void LcdEmuWrite(INT16U data) {
+    INT8U c = (INT8U)data;
+    INT8U entry_inc;
+    INT8U i;
+
+    lcdEmu.writes++;
+    if((data & 0x0100) != 0) {                          /* Data write    */
+        if(lcdEmu.cg_sel) {
+            lcdEmu.cgram[lcdEmu.ac & (EMU_CGRAM_SIZE - 1)] = c;
+        } else {
+            lcdEmu.ddram[lcdEmu.ac & (EMU_DDRAM_SIZE - 1)] = c;
+            if(lcdEmu.shift_en) {
+                lcdEmuShiftDisp(!lcdEmu.inc);
+            } else {
+            }
+        }
+        lcdEmuStepAc();
+    } else if((c & 0x80) != 0) {                        /* Set DDRAM address */
+        lcdEmu.ac = c & 0x7F;
+        lcdEmu.cg_sel = FALSE;
+    } else if((c & 0x40) != 0) {                        /* Set CGRAM address */
+        lcdEmu.ac = c & 0x3F;
+        lcdEmu.cg_sel = TRUE;
+    } else if((c & 0x20) != 0) {                        /* Function set  */
+        /* Only 4-bit, 2-line, 5x8 is modelled */
+    } else if((c & 0x10) != 0) {                        /* Cursor/display shift */
+        if((c & 0x08) != 0) {
+            lcdEmuShiftDisp((c & 0x04) != 0);
+        } else {                                        /* Cursor move, I/D kept */
+            entry_inc = lcdEmu.inc;
+            lcdEmu.inc = ((c & 0x04) != 0);
+            lcdEmuStepAc();
+            lcdEmu.inc = entry_inc;
+        }
+    } else if((c & 0x08) != 0) {                        /* Display on/off */
+        lcdEmu.disp_on = ((c & 0x04) != 0);
+        lcdEmu.cur_on = ((c & 0x02) != 0);
+        lcdEmu.blink = ((c & 0x01) != 0);
+    } else if((c & 0x04) != 0) {                        /* Entry mode set */
+        lcdEmu.inc = ((c & 0x02) != 0);
+        lcdEmu.shift_en = ((c & 0x01) != 0);
+    } else if((c & 0x02) != 0) {                        /* Return home   */
+        lcdEmu.ac = 0;
+        lcdEmu.cg_sel = FALSE;
+        lcdEmu.shift = 0;
+    } else if((c & 0x01) != 0) {                        /* Clear display */
+        for(i = 0; i < EMU_DDRAM_SIZE; i++) {
+            lcdEmu.ddram[i] = EMU_CLEAR_CHAR;
+        }
+        lcdEmu.ac = 0;
+        lcdEmu.cg_sel = FALSE;
+        lcdEmu.inc = TRUE;
+        lcdEmu.shift = 0;
+    } else {
+    }
+}
+
+/*************************************************************************
+  LcdEmuGetRow() - Copies the visible text of a row              (Public)
+*************************************************************************/
+void LcdEmuGetRow(INT8U row, INT8C *str) {
+    INT8U col;
+
+    for(col = 0; col < LCD_EMU_COLS; col++) {
+        if((row >= 1) && (row <= LCD_EMU_ROWS) && lcdEmu.disp_on) {
+            str[col] = (INT8C)lcdEmu.ddram[lcdEmuRowAddr[row - 1] +
+                                           ((col + lcdEmu.shift) % EMU_LINE_LEN)];
+        } else {
+            str[col] = (INT8C)EMU_CLEAR_CHAR;
+        }
+    }
+    str[LCD_EMU_COLS] = '\0';
+}
+
+/*************************************************************************
+  LcdEmuGetCursor() - Returns the cursor as seen on the glass    (Public)
+*************************************************************************/
+LCD_EMU_CURSOR LcdEmuGetCursor(void) {
+    LCD_EMU_CURSOR cursor;
+    INT8U row;
+    INT8U col;
+
+    cursor.row = 0;
+    cursor.col = 0;
+    cursor.on = lcdEmu.cur_on;
+    cursor.blink = lcdEmu.blink;
+    cursor.disp_on = lcdEmu.disp_on;
+    if(!lcdEmu.cg_sel) {
+        for(row = 0; row < LCD_EMU_ROWS; row++) {
+            if((lcdEmu.ac >= lcdEmuRowAddr[row]) &&
+               (lcdEmu.ac < (lcdEmuRowAddr[row] + EMU_LINE_LEN))) {
+                col = (INT8U)(((lcdEmu.ac - lcdEmuRowAddr[row]) + EMU_LINE_LEN -
+                               lcdEmu.shift) % EMU_LINE_LEN);
+                if(col < LCD_EMU_COLS) {
+                    cursor.row = row + 1;
+                    cursor.col = col + 1;
+                } else {
+                }
+            } else {
+            }
+        }
+    } else {
+    }
+    return cursor;
+}
+
+/*************************************************************************
+  LcdEmuGetCgram() - Reads back one byte of CGRAM                (Public)
+*************************************************************************/
+INT8U LcdEmuGetCgram(INT8U addr) {
+    return lcdEmu.cgram[addr & (EMU_CGRAM_SIZE - 1)];
+}
+
+/*************************************************************************
+  LcdEmuGetWrites() - Total bus writes since reset                (Public)
+*************************************************************************/
+INT32U LcdEmuGetWrites(void) {
+    return lcdEmu.writes;
+}
+
+/*************************************************************************
+  lcdEmuStepAc() - Moves the address counter per I/D            (Private)
+
+        In 2-line mode DDRAM is two 40 byte lines at 0x00 and 0x40.
+        Stepping past the end of one line lands on the start of the other.
+*************************************************************************/
+static void lcdEmuStepAc(void) {
+    if(lcdEmu.cg_sel) {
+        lcdEmu.ac = (lcdEmu.ac + (lcdEmu.inc ? 1 : (EMU_CGRAM_SIZE - 1))) &
+                    (EMU_CGRAM_SIZE - 1);
+    } else if(lcdEmu.inc) {
+        if(lcdEmu.ac == (EMU_LINE_LEN - 1)) {
+            lcdEmu.ac = EMU_LINE2_ADDR;
+        } else if(lcdEmu.ac == (EMU_LINE2_ADDR + EMU_LINE_LEN - 1)) {
+            lcdEmu.ac = 0x00;
+        } else {
+            lcdEmu.ac++;
+        }
+    } else {
+        if(lcdEmu.ac == 0x00) {
+            lcdEmu.ac = EMU_LINE2_ADDR + EMU_LINE_LEN - 1;
+        } else if(lcdEmu.ac == EMU_LINE2_ADDR) {
+            lcdEmu.ac = EMU_LINE_LEN - 1;
+        } else {
+            lcdEmu.ac--;
+        }
+    }
+}
+
+/*************************************************************************
+  lcdEmuShiftDisp() - Shifts the display window one position    (Private)
+*************************************************************************/
+static void lcdEmuShiftDisp(INT8U right) {
+    if(right) {
+        lcdEmu.shift = (INT8U)((lcdEmu.shift + EMU_LINE_LEN - 1) % EMU_LINE_LEN);
+    } else {
+        lcdEmu.shift = (INT8U)((lcdEmu.shift + 1) % EMU_LINE_LEN);
+    }
+}
@@ -0,0 +1,51 @@
+/****************************************************************************************
+* LcdEmu.h - Host emulation of a Hitachi HD44780-type LCD controller
+*
+*            Stands in for the GPIO bus layer of LcdLayered.c when
+*            APP_CFG_LCD_EMU_EN is enabled in app_cfg.h. Every lcdWrite() is
+*            decoded into an emulated DDRAM/CGRAM so the visible 2x16 text and
+*            cursor state can be read back without hardware.
+*
+* 10/19/2026 First release
+****************************************************************************************/
+#ifndef LCD_EMU_DEF
+#define LCD_EMU_DEF
+
+#define LCD_EMU_ROWS        2
+#define LCD_EMU_COLS        16
+
+/*************************************************************************
+* Cursor and display state as seen by the LCD controller
+*************************************************************************/
+typedef struct {
+    INT8U row;              /* 1 or 2, 0 if the address counter is off-screen */
+    INT8U col;              /* 1 - 16, 0 if the address counter is off-screen */
+    INT8U on;
+    INT8U blink;
+    INT8U disp_on;
+} LCD_EMU_CURSOR;
+
+/*************************************************************************
+  Public Functions
+*************************************************************************/
+
+/* Power-on state: DDRAM cleared to spaces, display off, AC = 0 */
+void LcdEmuReset(void);
+
+/* Decodes one bus write. Same format as lcdWrite(): bit 8 is RS,   */
+/* bits 0-7 are the command or character                            */
+void LcdEmuWrite(INT16U data);
+
+/* Copies the visible text of row (1 or 2) into str, NUL terminated */
+/* str must hold LCD_EMU_COLS+1 characters                          */
+void LcdEmuGetRow(INT8U row, INT8C *str);
+
+LCD_EMU_CURSOR LcdEmuGetCursor(void);
+
+/* Reads back one byte of character generator RAM (0 - 63)          */
+INT8U LcdEmuGetCgram(INT8U addr);
+
+/* Total bus writes decoded since the last LcdEmuReset()            */
+INT32U LcdEmuGetWrites(void);
+
+#endif
@@ -23,6 +23,7 @@
 * 03/09/2019 Changed parameters for LcdDispDecWord. Brad Cowgill
 * 03/13/2019 Changed LcdCursorDispMode() to be private, now lcdCursorDispMode(). BJC
 * 02/18/2020 Fixed col input error check. TDM
+* 10/19/2026 Added bus write statistics and the LcdEmu host bus layer.
 *****************************************************************************************
 * Header Files - Dependencies
 *****************************************************************************************/
@@ -32,6 +33,9 @@
 #include "LcdLayered.h"
 #include "K65TWR_GPIO.h"
 #include "math.h"
+#if (APP_CFG_LCD_EMU_EN == DEF_ENABLED)
+#include "LcdEmu.h"
+#endif
 
 /*****************************************************************************************
 * LCD Port Defines 
@@ -106,6 +110,8 @@ static const INT8U lcdRowAddress[LCD_NUM_ROWS] = {0x00, 0x40};
 static LCD_BUFFER lcdBuffer;
 static LCD_BUFFER lcdPreviousBuffer;
 static LCD_BUFFER lcdLayers[LCD_NUM_LAYERS];
+static INT16U lcdFrameWrites;           /* lcdWrite() calls in the current frame */
+static LCD_BUS_STATS lcdBusStats;       /* Protected by lcdLayersKey             */
 
 /*************************************************************************
   LCD Command Macros
@@ -166,11 +172,36 @@ static void lcdLayeredTask(void *p_arg) {
         OSTaskSemPend(0,OS_OPT_PEND_BLOCKING,(CPU_TS *)0, &os_err);
     	DB4_TURN_ON();
         
+        lcdFrameWrites = 0;
         lcdFlattenLayers(&lcdBuffer, (LCD_BUFFER *)&lcdLayers);
         lcdWriteBuffer(&lcdBuffer);
+
+        // Account the bus writes this frame cost
+        OSMutexPend(&lcdLayersKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+        lcdBusStats.frames++;
+        lcdBusStats.writes += lcdFrameWrites;
+        lcdBusStats.last_frame_writes = lcdFrameWrites;
+        (void)OSMutexPost(&lcdLayersKey, OS_OPT_POST_NONE, &os_err);
     }
 }
 
+/*************************************************************************
+  LcdGetBusStats                                                  (Public)
+
+  DESCRIPTION: Copies the LCD bus write counters into *stats. The
+               cost of a UI interaction is the difference in writes
+               between a call before and a call after it.
+
+  RETURNS: None
+*************************************************************************/
+void LcdGetBusStats(LCD_BUS_STATS *stats){
+    OS_ERR os_err;
+
+    OSMutexPend(&lcdLayersKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    *stats = lcdBusStats;
+    (void)OSMutexPost(&lcdLayersKey, OS_OPT_POST_NONE, &os_err);
+}
+
 /*************************************************************************
   LcdCursor                                                       (Public)
 
@@ -596,6 +627,9 @@ void LcdInit(void) {
     while(os_err != OS_ERR_NONE){           /* Error Trap                        */
     }
 
+#if (APP_CFG_LCD_EMU_EN == DEF_ENABLED)
+    LcdEmuReset();
+#else
     // Perform LCD hardware initialisation
     SIM->SCGC5 |= SIM_SCGC5_PORTD_MASK;              /* Enable clock gate for PORTD */
     PORTD->PCR[1]=(0|PORT_PCR_MUX(1));
@@ -633,6 +667,7 @@ void LcdInit(void) {
     lcdDly500ns();
     LCD_CLR_E();
     lcdDlyus(41);
+#endif
   
     lcdWrite(LCD_FUNCTION(0, 1, 0));     /*Send command for 4-bit mode */
     lcdWrite(LCD_ENTRY_MODE(1, 0)); // Increment, no shift
@@ -789,7 +824,12 @@ static void lcdWriteBuffer(LCD_BUFFER *buffer) {
                
 ******************************************************************************/
 static void lcdWrite(INT16U data) {
+#if (APP_CFG_LCD_EMU_EN == DEF_ENABLED)
+    lcdFrameWrites++;
+    LcdEmuWrite(data);
+#else
     INT8U c;
+    lcdFrameWrites++;
     // Set/Reset RS
     if((data & 0x0100) == 0x0100){
         LCD_SET_RS(); //data write
@@ -810,6 +850,7 @@ static void lcdWrite(INT16U data) {
     lcdDly500ns();
     LCD_CLR_E();
     lcdDlyus(41);
+#endif
 }
 
 
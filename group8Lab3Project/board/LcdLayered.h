@@ -21,6 +21,7 @@
 * 01/18/2018 Changed to replace includes.h TDM
 * 01/20/2019 Changed for MCUXpresso and added LcdDispDecWord(). TDM
 * 03/09/2019 Added additional defines and modified LcdDispDecWord. Brad Cowgill
+* 10/19/2026 Added LcdGetBusStats().
 ****************************************************************************************/
 
 #ifndef LCD_DEF
@@ -74,6 +75,16 @@ typedef enum {
     LCD_DEC_MODE_AL
 } LCD_MODE;
 
+/*************************************************************************
+* LCD bus write counters, see LcdGetBusStats()
+*
+*************************************************************************/
+typedef struct {
+    INT32U writes;              /* lcdWrite() calls since LcdInit()     */
+    INT32U frames;              /* screen refreshes since LcdInit()     */
+    INT16U last_frame_writes;   /* lcdWrite() calls of the last refresh */
+} LCD_BUS_STATS;
+
 /*************************************************************************
   Public Functions
 *************************************************************************/
@@ -98,5 +109,6 @@ INT8U LcdCursor(INT8U row, INT8U col, INT8U layer, INT8U on, INT8U blink);
 void LcdHideLayer(INT8U layer);
 void LcdShowLayer(INT8U layer);
 void LcdToggleLayer(INT8U layer);
+void LcdGetBusStats(LCD_BUS_STATS *stats);
 #endif
 
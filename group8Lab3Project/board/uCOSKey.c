@@ -1,9 +1,9 @@
 /********************************************************************
 * uCOSKey.c - A keypad module that runs under MicroC/OS for a 4x4 
 * matrix keypad.
-* This version allows for multiple column keys to be pressed and 
-* mapped to a different code by changing ColTable[] in keyScan().
-* Multiple rows can not be resolved. The topmost button will be used.
+* All 16 keys are scanned into a bit mask so two-key chords are
+* delivered as KEY_EV_CHORD events. Three-key patterns that ghost in
+* the diode-less matrix are rejected.
 * The keyCodeTable[] is currently set to generate ASCII codes.
 *
 * Requires the following be defined in app_cfg.h:
@@ -15,6 +15,15 @@
 * 02/12/2013 TDM Modified to run under MicroC/OS-III
 * 01/18/2018 Changed to replace includes.h TDM
 * 01/20/2019 Changed for MCUXpresso TDM
+* 10/19/2026 Added interrupt driven scanning, APP_CFG_KEY_IRQ_EN.
+*            With it enabled the rows are held low while idle and a
+*            PORTC column interrupt wakes keyTask for a scan burst.
+* 10/19/2026 Replaced the single key buffer with an SPSC event ring
+*            carrying press, release, long-press and auto-repeat events.
+* 10/19/2026 keyScan() returns a 16-bit mask of every key down, with
+*            ghost detection, and keyTask posts chord events.
+* 10/19/2026 A key left down after a chord is not pressed again until
+*            every key is up.
 *********************************************************************
 * Header Files - Dependencies
 ********************************************************************/
@@ -36,20 +45,46 @@ typedef enum{KEY_OFF,KEY_EDGE,KEY_VERF} KEYSTATES;
 #define KEY_PORT_IN	   GPIOC->PDIR
 #define COLS_MASK 0x00000078
 #define ROWS_MASK 0x00000780
+#define COL1_PIN  3U                /* first column pin, columns are contiguous */
+#define NUM_COLS  4U
+#define KEY_SCAN_PERIOD 8U          /* ticks between scans, > switch bounce */
 
+#define KEY_EV_QSIZE       16U      /* event ring size, power of two      */
+#define KEY_LONG_TICKS     600U     /* hold time for KEY_EV_LONG          */
+#define KEY_REPEAT_DELAY   400U     /* hold time to the first repeat      */
+#define KEY_REPEAT_START   200U     /* first repeat interval              */
+#define KEY_REPEAT_MIN     40U      /* fastest repeat interval            */
+
+/* Single producer (keyTask), single consumer ring. head is only written */
+/* by the producer and tail only by the consumer so no lock is needed.   */
 typedef struct{
-    INT8C buffer;
-    OS_SEM flag;
+    KEY_EVENT queue[KEY_EV_QSIZE];
+    volatile INT8U head;
+    volatile INT8U tail;
+    OS_SEM flag;                    /* counts posted events */
 }KEY_BUFFER;
 /********************************************************************
 * Private Resources
 ********************************************************************/
-static INT8U keyScan(void);         /* Makes a single keypad scan  */
+static INT16U keyScan(INT8U *ghost);    /* Makes a single keypad scan  */
 static const INT8C keyCodeTable[16] =
    {'1','2','3',DC1,'4','5','6',DC2,'7','8','9',DC3,'*','0','#',DC4};
+/* Keys that auto-repeat while held: the digits and backspace */
+static const INT8U keyRepeatTable[16] =
+   {1,1,1,0,1,1,1,0,1,1,1,1,0,1,0,0};
 static void keyDly(void);  /* Added for GPIO to settle before read */
+static void keyPostEvent(INT8C code, KEY_EV_TYPE type, INT16U mask);
+static INT8U keyMaskIndex(INT16U mask);
+static void keyLogLatency(void);
 static void keyTask(void *p_arg);
 static KEY_BUFFER keyBuffer;
+static KEY_STATS keyStats;
+static OS_TICK keyPressTick;        /* tick the current press was first seen */
+#if (APP_CFG_KEY_IRQ_EN == DEF_ENABLED)
+static void keyArm(void);
+static void keyColIrq(INT8U irqc);
+void PORTC_IRQHandler(void);
+#endif
 /**********************************************************************************
 * Allocate task control blocks
 **********************************************************************************/
@@ -60,13 +95,109 @@ static OS_TCB keyTaskTCB;
 static CPU_STK keyTaskStk[APP_CFG_KEY_TASK_STK_SIZE];
 
 /********************************************************************
-* KeyPend() - A function to provide access to the key buffer via a
-*             semaphore.
+* KeyPend() - Blocks until the next press or repeat event and returns
+*             its key code. Release and long-press events are dropped.
+*             Do not mix with KeyEventWait() on the same keypad.
 *    - Public
 ********************************************************************/
 INT8C KeyPend(INT16U tout, OS_ERR *os_err){
-    OSSemPend(&(keyBuffer.flag),tout, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, os_err);
-    return(keyBuffer.buffer);
+    KEY_EVENT event;
+    INT8C key = 0;
+    *os_err = OS_ERR_NONE;
+    while((key == 0) && (*os_err == OS_ERR_NONE)){
+        if(KeyEventGet(&event)){
+            if((event.type == KEY_EV_PRESS) || (event.type == KEY_EV_REPEAT)){
+                key = event.code;
+            }else{
+            }
+        }else{
+            OSSemPend(&(keyBuffer.flag),tout, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, os_err);
+        }
+    }
+    return(key);
+}
+
+/********************************************************************
+* KeyEventWait() - Blocks until at least one key event is queued.
+*                  The caller must then drain the ring with
+*                  KeyEventGet() until it returns FALSE. Events posted
+*                  during the drain may cause one empty wakeup.
+*    - Public
+********************************************************************/
+void KeyEventWait(INT16U tout, OS_ERR *os_err){
+    OS_ERR set_err;
+    (void)OSSemPend(&(keyBuffer.flag),tout, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, os_err);
+    if(*os_err == OS_ERR_NONE){
+        OSSemSet(&(keyBuffer.flag), 0, &set_err);   /* one wakeup drains them all */
+    }else{
+    }
+}
+
+/********************************************************************
+* KeyEventGet() - Removes the oldest event from the ring.
+*                 Returns FALSE if the ring is empty. Never blocks.
+*    - Public
+********************************************************************/
+INT8U KeyEventGet(KEY_EVENT *event){
+    INT8U tail = keyBuffer.tail;
+    if(tail == keyBuffer.head){
+        return FALSE;
+    }else{
+    }
+    *event = keyBuffer.queue[tail & (KEY_EV_QSIZE - 1)];
+    __DMB();                        /* read the slot before freeing it */
+    keyBuffer.tail = tail + 1;
+    return TRUE;
+}
+
+/********************************************************************
+* keyPostEvent() - Producer side of the event ring. A full ring drops
+*                  the new event and counts it in keyStats.
+*    - Private
+********************************************************************/
+static void keyPostEvent(INT8C code, KEY_EV_TYPE type, INT16U mask){
+    OS_ERR os_err;
+    INT8U head = keyBuffer.head;
+    if((INT8U)(head - keyBuffer.tail) >= KEY_EV_QSIZE){
+        keyStats.dropped++;
+    }else{
+        keyBuffer.queue[head & (KEY_EV_QSIZE - 1)].code = code;
+        keyBuffer.queue[head & (KEY_EV_QSIZE - 1)].type = type;
+        keyBuffer.queue[head & (KEY_EV_QSIZE - 1)].mask = mask;
+        keyBuffer.queue[head & (KEY_EV_QSIZE - 1)].ts = OSTimeGet(&os_err);
+        __DMB();                    /* publish the slot before the index */
+        keyBuffer.head = head + 1;
+        (void)OSSemPost(&(keyBuffer.flag), OS_OPT_POST_1, &os_err);
+    }
+}
+
+/********************************************************************
+* KeyCodeMask() - Returns the KEY_EVENT mask bit of a key code, zero
+*                 if the code is not on the keypad. Used to match
+*                 KEY_EV_CHORD masks.
+*    - Public
+********************************************************************/
+INT16U KeyCodeMask(INT8C code){
+    INT8U i;
+    INT16U mask = 0;
+    for(i = 0; i < 16; i++){
+        if(keyCodeTable[i] == code){
+            mask = (INT16U)(1U << i);
+        }else{
+        }
+    }
+    return mask;
+}
+
+/********************************************************************
+* KeyGetStats() - Copies the keypad wakeup and latency counters.
+*    - Public
+********************************************************************/
+void KeyGetStats(KEY_STATS *stats){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *stats = keyStats;
+    CPU_CRITICAL_EXIT();
 }
 
 /********************************************************************
@@ -90,8 +221,13 @@ void KeyInit(void){
 	PORTC->PCR[9]=PORT_PCR_MUX(1);
 	PORTC->PCR[10]=PORT_PCR_MUX(1);
     KEY_PORT_OUT &= ~ROWS_MASK;            /* Preset all rows to zero    */
+#if (APP_CFG_KEY_IRQ_EN == DEF_ENABLED)
+    keyColIrq(PORT_IRQ_OFF);               /* Armed by keyTask when idle */
+    NVIC_EnableIRQ(PORTC_IRQn);
+#endif
     // Initialize the Key Buffer and semaphore
-    keyBuffer.buffer = 0x00;           /* Init KeyBuffer      */
+    keyBuffer.head = 0;                /* Init KeyBuffer      */
+    keyBuffer.tail = 0;
     OSSemCreate(&(keyBuffer.flag),"Key Semaphore",0,&os_err);
     while(os_err != OS_ERR_NONE){           /* Error Trap                        */
     }
@@ -127,83 +263,242 @@ void KeyInit(void){
 static void keyTask(void *p_arg) {
 
     OS_ERR os_err;
-    INT8U cur_key;
-    INT8U last_key = 0;
+    INT16U cur_mask;
+    INT16U last_mask = 0;
+    INT8U ghost;
+    INT8U down = 0;                     /* keyCodeTable index+1 of the pressed key */
+    INT8U chord = FALSE;                /* a chord was seen since all keys were up */
     KEYSTATES KeyState = KEY_OFF;
+    OS_TICK verf_tick = 0;              /* tick the held key was verified */
+    OS_TICK held;
+    OS_TICK next_repeat = 0;
+    OS_TICK repeat_int = 0;
+    INT8U long_sent = FALSE;
     (void)p_arg;
     while(1){
+#if (APP_CFG_KEY_IRQ_EN == DEF_ENABLED)
+        if((KeyState == KEY_OFF) && (last_mask == 0)){  /* Keypad idle, sleep until a column interrupt */
+            DB3_TURN_OFF();
+            keyArm();
+            (void)OSTaskSemPend(0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+            DB3_TURN_ON();
+        }else{                                          /* Debounce and scan burst */
+            DB3_TURN_OFF();
+            OSTimeDly(KEY_SCAN_PERIOD,OS_OPT_TIME_DLY,&os_err);
+            DB3_TURN_ON();
+        }
+#else
 		DB3_TURN_OFF();
-        OSTimeDly(8,OS_OPT_TIME_PERIODIC,&os_err);
+        OSTimeDly(KEY_SCAN_PERIOD,OS_OPT_TIME_PERIODIC,&os_err);
 		DB3_TURN_ON();
+#endif
         while(os_err != OS_ERR_NONE){           /* Error Trap                        */
         }
-        cur_key = keyScan();
+        keyStats.wakeups++;
+        cur_mask = keyScan(&ghost);
+        if(ghost){                              /* Ambiguous, treat as unchanged     */
+            keyStats.ghosts++;
+            cur_mask = last_mask;
+        }else{
+        }
         if(KeyState == KEY_OFF){    /* Key released state */
-            if(cur_key != 0){
+            if(cur_mask != 0){
                 KeyState = KEY_EDGE;
+                if(last_mask != 0){         /* Key changed without release, no new IRQ */
+                    keyPressTick = OSTimeGet(&os_err);
+                }else{
+#if (APP_CFG_KEY_IRQ_EN == DEF_DISABLED)
+                    keyPressTick = OSTimeGet(&os_err);
+#endif
+                }
             }else{ /* wait for key press */
             }
         }else if(KeyState == KEY_EDGE){     /* Keypress detected state*/
-            if(cur_key == last_key){        /* Keypress verified */
+            if(cur_mask == 0){              /* Unvalidated or released, start over */
+                KeyState = KEY_OFF;
+                chord = FALSE;
+                if(down != 0){
+                    keyPostEvent(keyCodeTable[down - 1], KEY_EV_RELEASE, (INT16U)(1U << (down - 1)));
+                    down = 0;
+                }else{
+                }
+            }else if(cur_mask == last_mask){    /* Keys verified */
                 KeyState = KEY_VERF;
-                keyBuffer.buffer = keyCodeTable[cur_key - 1]; /*update buffer */
-                (void)OSSemPost(&(keyBuffer.flag), OS_OPT_POST_1, &os_err);   /* Signal new data in buffer */
-                while(os_err != OS_ERR_NONE){           /* Error Trap                        */
+                if((cur_mask & (cur_mask - 1)) != 0){   /* Two or more keys: chord */
+                    keyPostEvent(0, KEY_EV_CHORD, cur_mask);
+                    chord = TRUE;
+                    keyLogLatency();
+                }else if((keyMaskIndex(cur_mask) + 1) != down){
+                    if(down != 0){
+                        keyPostEvent(keyCodeTable[down - 1], KEY_EV_RELEASE, (INT16U)(1U << (down - 1)));
+                    }else{
+                    }
+                    if(chord){              /* Left of a chord, not a press */
+                        down = 0;
+                    }else{
+                        down = keyMaskIndex(cur_mask) + 1;
+                        keyPostEvent(keyCodeTable[down - 1], KEY_EV_PRESS, cur_mask);
+                        verf_tick = OSTimeGet(&os_err);
+                        next_repeat = KEY_REPEAT_DELAY;
+                        repeat_int = KEY_REPEAT_START;
+                        long_sent = FALSE;
+                        keyLogLatency();
+                    }
+                }else{                      /* Chord reduced back to the held key */
                 }
-            }else if( cur_key == 0){        /* Unvalidated, start over */
-                KeyState = KEY_OFF;
             }else{                          /*Unvalidated, diff key edge*/
             }
         }else if(KeyState == KEY_VERF){     /* Keypress verified state */
-            if((cur_key == 0) || (cur_key != last_key)){
+            if(cur_mask == 0){
                 KeyState = KEY_OFF;
+                chord = FALSE;
+                if(down != 0){
+                    keyPostEvent(keyCodeTable[down - 1], KEY_EV_RELEASE, (INT16U)(1U << (down - 1)));
+                    down = 0;
+                }else{
+                }
+            }else if(cur_mask != last_mask){    /* Keys added or removed, verify again */
+                KeyState = KEY_EDGE;
+                keyPressTick = OSTimeGet(&os_err);
+            }else if((down != 0) && !chord){    /* Held, generate long-press and accelerating repeats */
+                held = OSTimeGet(&os_err) - verf_tick;
+                if((held >= KEY_LONG_TICKS) && !long_sent){
+                    keyPostEvent(keyCodeTable[down - 1], KEY_EV_LONG, cur_mask);
+                    long_sent = TRUE;
+                }else{
+                }
+                if(keyRepeatTable[down - 1] && (held >= next_repeat)){
+                    keyPostEvent(keyCodeTable[down - 1], KEY_EV_REPEAT, cur_mask);
+                    next_repeat += repeat_int;
+                    repeat_int -= (repeat_int >> 2);        /* 25% faster each repeat */
+                    if(repeat_int < KEY_REPEAT_MIN){
+                        repeat_int = KEY_REPEAT_MIN;
+                    }else{
+                    }
+                }else{
+                }
             }else{ /* wait for release or key change */
             }
         }else{ /* In case of error */
             KeyState = KEY_OFF;             /* Should never get here */
         }
-        last_key = cur_key;                 /* Save key for next time */
+        last_mask = cur_mask;               /* Save keys for next time */
     
     }
 }
 
 /********************************************************************
-* keyScan() - Scans the keypad and returns a keycode.
+* keyLogLatency() - Counts a press or chord and its latency from
+*                   keyPressTick.
+* (Private)
+********************************************************************/
+static void keyLogLatency(void){
+    OS_ERR os_err;
+    keyStats.presses++;
+    keyStats.last_latency = OSTimeGet(&os_err) - keyPressTick;
+    if(keyStats.last_latency > keyStats.max_latency){
+        keyStats.max_latency = keyStats.last_latency;
+    }else{
+    }
+}
+
+#if (APP_CFG_KEY_IRQ_EN == DEF_ENABLED)
+/********************************************************************
+* keyArm() - Holds all rows low and enables the column interrupts so
+*            any keypress pulls a column low and wakes keyTask.
+*            The interrupt is level sensitive so a key that is
+*            already down when armed wakes the task immediately.
+* (Private)
+********************************************************************/
+static void keyArm(void){
+    KEY_PORT_OUT &= ~ROWS_MASK;
+    KEY_PORT_DIR |= ROWS_MASK;              /* Drive all rows low        */
+    keyDly();                               /* Let the columns settle    */
+    PORTC->ISFR = COLS_MASK;
+    keyColIrq(PORT_IRQ_ZERO);
+}
+
+/********************************************************************
+* keyColIrq() - Sets the IRQC field of all column pins.
+* (Private)
+********************************************************************/
+static void keyColIrq(INT8U irqc){
+    INT8U pin;
+    for(pin = COL1_PIN; pin < (COL1_PIN + NUM_COLS); pin++){
+        PORTC->PCR[pin] = (PORTC->PCR[pin] & ~(PORT_PCR_IRQC_MASK|PORT_PCR_ISF_MASK)) |
+                          PORT_PCR_IRQC(irqc);
+    }
+}
+
+/********************************************************************
+* PORTC_IRQHandler() - A column went low while the keypad was idle.
+*                      Disarms the columns so keyScan() can drive the
+*                      rows and wakes keyTask for a scan burst.
+* (Public, ISR)
+********************************************************************/
+void PORTC_IRQHandler(void){
+    OS_ERR os_err;
+    OSIntEnter();
+    keyColIrq(PORT_IRQ_OFF);
+    PORTC->ISFR = COLS_MASK;
+    keyPressTick = OSTimeGet(&os_err);
+    (void)OSTaskSemPost(&keyTaskTCB, OS_OPT_POST_NONE, &os_err);
+    OSIntExit();
+}
+#endif
+
+/********************************************************************
+* keyScan() - Scans the keypad and returns a mask of the keys down.
 *           - Designed for 4x4 keypad with columns pulled high.
-*           - Current keycodes follow:
-*               1->0x01,2->0x02,3->0x03,A->0x04
-*               4->0x05,5->0x06,6->0x07,B->0x08
-*               7->0x09,8->0x0A,9->0x0B,C->0x0C
-*               *->0x0D,0->0x0E,#->0x0F,D->0x10
+*           - Bit n of the mask is keyCodeTable[n]:
+*               1->b0, 2->b1, 3->b2, A->b3
+*               4->b4, 5->b5, 6->b6, B->b7
+*               7->b8, 8->b9, 9->b10,C->b11
+*               *->b12,0->b13,#->b14,D->b15
 *           - Returns zero if no key is pressed.
-*           - ColTable[] can be changed to distinguish multiple keys
-*             pressed in the same row.
+*           - Sets *ghost if a row shares two or more columns with the
+*             rows above it. With no diodes in the matrix that pattern
+*             can be produced by three keys, so the fourth key read is
+*             not trustworthy.
+*           - All four rows are always driven, the same as the worst
+*             case of the old first-row-wins scan.
 * (Private)
 ********************************************************************/
-static INT8U keyScan(void) {
+static INT16U keyScan(INT8U *ghost) {
 
-    INT8U kcode;
+    INT16U kmask = 0;
+    INT8U cols;
+    INT8U seen = 0;                 /* OR of the columns of earlier rows */
     INT8U roff;
     INT32U rbit;
 
-    const INT8U ColTable[16] = {0,1,2,2,3,3,3,3,4,4,4,4,4,4,4,4};
-
+    *ghost = FALSE;
     rbit = 0x00000080;
     roff = 0x00;
     while(rbit != 0){ /* Until all rows are scanned */
         KEY_PORT_OUT &= ~ROWS_MASK;
         KEY_PORT_DIR = (KEY_PORT_DIR & ~ROWS_MASK)|rbit;    /* Pull row low */
         keyDly();	// wait for direction and col inputs to settle
-        kcode = (INT8U)(((~KEY_PORT_IN) & COLS_MASK)>>3);  /*Read columns */
+        cols = (INT8U)(((~KEY_PORT_IN) & COLS_MASK)>>3);  /*Read columns */
         KEY_PORT_DIR = (KEY_PORT_DIR &~ROWS_MASK); 
-        if(kcode != 0){        /* generate key code if key pressed */
-            kcode = roff + ColTable[kcode];
-            break;
+        if(((cols & seen) & ((cols & seen) - 1)) != 0){   /* two shared columns */
+            *ghost = TRUE;
+        }else{
         }
+        seen |= cols;
+        kmask |= (INT16U)cols << roff;
         rbit = ROWS_MASK & (rbit<<1);       /* setup for next row */
         roff += 4;
     }
-    return (kcode); 
+    return (kmask); 
+}
+
+/********************************************************************
+* keyMaskIndex() - Index of the lowest key set in a non-zero mask.
+* (Private)
+********************************************************************/
+static INT8U keyMaskIndex(INT16U mask) {
+    return (INT8U)(31U - __CLZ((INT32U)(mask & (~mask + 1U))));
 }
 /********************************************************************
  * keyDly() a software delay for keyScan() to wait until port row
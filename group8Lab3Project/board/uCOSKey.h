@@ -1,9 +1,9 @@
 /********************************************************************
 * uCOSKey.h - A keypad module that runs under MicroC/OS for a 4x4
 * matrix keypad.
-* This version allows for multiple column keys to be pressed and
-* mapped to a different code by changing ColTable[] in keyScan().
-* Multiple rows can not be resolved. The topmost button will be used.
+* All 16 keys are scanned into a bit mask so two-key chords are
+* delivered as KEY_EV_CHORD events. Three-key patterns that ghost in
+* the diode-less matrix are rejected.
 * The keyCodeTable[] is currently set to generate ASCII codes.
 *
 * Requires the following be defined in app_cfg.h:
@@ -15,6 +15,9 @@
 * 02/12/2013 TDM Modified to run under MicroC/OS-III
 * 01/18/2018 Changed to replace includes.h TDM
 * 01/20/2019 Changed for MCUXpresso TDM
+* 10/19/2026 Added interrupt driven scanning and KeyGetStats()
+* 10/19/2026 Added the key event ring, KeyEventWait()/KeyEventGet()
+* 10/19/2026 Added bit mask scanning and KEY_EV_CHORD
 *********************************************************************
 * Public Resources
 ********************************************************************/
@@ -30,6 +33,32 @@
 #define DC3 (INT8C)0x13     /*ASCII control code for the C button */
 #define DC4 (INT8C)0x14     /*ASCII control code for the D button */
 
+/*****************************************************************************************
+* Key events. Codes are the same ASCII codes KeyPend() returns.
+* ts is the OS tick the event was generated. mask has one bit per key
+* down, see KeyCodeMask().
+*   KEY_EV_PRESS    verified keypress
+*   KEY_EV_RELEASE  key released or changed
+*   KEY_EV_LONG     key held for the long-press time, sent once per press
+*   KEY_EV_REPEAT   auto-repeat while a repeating key is held, accelerating
+*   KEY_EV_CHORD    two or more keys verified down together, code is 0.
+*                   If one key went down first its PRESS was already sent,
+*                   its RELEASE follows when the last key is let go. A key
+*                   still down when the others are let go sends no PRESS,
+*                   every key must be up first.
+*****************************************************************************************/
+typedef enum {KEY_EV_PRESS, KEY_EV_RELEASE, KEY_EV_LONG, KEY_EV_REPEAT, KEY_EV_CHORD} KEY_EV_TYPE;
+typedef struct{
+    INT8C code;
+    KEY_EV_TYPE type;
+    INT16U mask;
+    OS_TICK ts;
+}KEY_EVENT;
+
+void KeyEventWait(INT16U tout, OS_ERR *os_err); /* Pend until events are queued */
+INT8U KeyEventGet(KEY_EVENT *event);            /* Pop one, FALSE if none       */
+INT16U KeyCodeMask(INT8C code);                 /* KEY_EVENT mask bit of a code */
+
 INT8C KeyPend(INT16U tout, OS_ERR *os_err); /* Pend on key press*/
                              /* tout - semaphore timeout           */
                              /* *err - destination of err code     */
@@ -37,4 +66,20 @@ INT8C KeyPend(INT16U tout, OS_ERR *os_err); /* Pend on key press*/
 
 void KeyInit(void);             /* Keypad Initialization    */
 
+/*****************************************************************************************
+* Keypad activity counters, see KeyGetStats()
+* Latencies are in OS ticks, from the column interrupt (or the first
+* scan that saw the key when polling) to the key being posted.
+*****************************************************************************************/
+typedef struct{
+    INT32U wakeups;             /* keyTask scans since KeyInit()    */
+    INT32U presses;             /* verified keypresses              */
+    INT32U dropped;             /* events lost to a full ring       */
+    INT32U ghosts;              /* scans rejected for ghosting      */
+    OS_TICK last_latency;
+    OS_TICK max_latency;
+}KEY_STATS;
+
+void KeyGetStats(KEY_STATS *stats);  /* Copy of the counters */
+
 #endif
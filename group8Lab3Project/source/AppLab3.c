@@ -3,6 +3,20 @@
  * A function generator that runs under MicroC/OS, a preemptive multitasking kernel.
  *
  * 01/25/2022 Aili Emory, Dominic Danis, Nick Coyle
+ * 10/19/2026 UI tasks post parameter commands to appParamTask, which applies them to the
+ *            generators, redraws and saves to EEPROM
+ * 10/19/2026 DAC waveform and square duty, selected with the * key and saved
+ * 10/19/2026 Sine sweep to the entered frequency, started and stopped with * + C
+ * 10/19/2026 Sine modulation, * + D steps through off, AM, FM and PM
+ * 10/19/2026 Bursts on SW2/SW3, * + B steps through off, counted and gated, * + 0 fires
+ * 10/19/2026 Holding A turns the quadrature sine on DAC1 on and off
+ * 10/19/2026 DAC calibration, loaded at start and stepped through with * + A
+ * 10/19/2026 Pulse duty in permille with *, or as a width in us with * + 1, saved
+ * 10/19/2026 The * cycle skips ARB and ARB is never saved or loaded, there is no loader
+ * 10/19/2026 appParamTask is created after the saved configuration is loaded
+ * 10/19/2026 Sweep and burst trigger chords are posted to appParamTask too
+ * 10/19/2026 ARB tables are loaded over UART2 by AwgLoader, the * cycle offers ARB once
+ *            a table is loaded. ARB is still not saved.
  *****************************************************************************************/
 #include "os.h"
 #include "app_cfg.h"
@@ -13,23 +27,70 @@
 #include "uCOSKey.h"
 #include "uCOSTSI.h"
 #include "DMA.h"
+#include "EEPROM.h"
 #include "SineGeneration.h"
 #include "PulseTrain.h"
-#include "EEPROM.h"
 #include "MemoryTools.h"
+#include "AwgLoader.h"
 
 #define FREQ_LIMIT_HIGH 10000
 #define FREQ_LIMIT_LOW 10
 #define ASCII_CODE_ZERO 48
 #define DEFAULT_FREQ 1000
 #define DEFAULT_LEVEL 10
+#define DEFAULT_DUTY 50
+#define SWEEP_TIME_MS 2000          /* UI sweep, log and repeating                      */
+#define MOD_RATE_DEFAULT 50         /* UI modulation, 5Hz sine LFO                      */
+#define MOD_AM_DEFAULT 50           /* Percent                                          */
+#define MOD_FM_DEFAULT 100          /* Hz                                               */
+#define MOD_PM_DEFAULT 90           /* Degrees                                          */
+#define BURST_CYCLES_DEFAULT 10     /* UI burst, SW2 and SW3 trigger                    */
+#define BURST_GATE_CYCLES 1         /* Gate resolution, whole cycles                    */
+#define DUAL_PHASE_DEG 90           /* UI dual output, DAC1 sine in quadrature          */
+#define TOUCH_POLL_PERIOD 20        /* Ticks between pad reads during a touch gesture   */
+#define TOUCH_UPDATE_PERIOD 50      /* Minimum ticks between level changes              */
+#define TOUCH_RAMP_DELAY 400        /* Hold time before ramping starts                  */
+#define TOUCH_RAMP_START 200        /* First ramp interval, shrinks 25% per step        */
+#define TOUCH_RAMP_MIN 50           /* Fastest ramp interval                            */
+
+#define PARAM_Q_SIZE 8
 
 typedef enum {SINEWAVE, PULSE_TRAIN} UI_STATES_T;
+/*****************************************************************************************
+ * Parameter commands to appParamTask. A command is packed into the message pointer:
+ * bits 31-28 command, bit 27 save to EEPROM, bits 24-26 output, bits 0-15 value.
+ * SET_MODE selects the output in the UI, DEFAULTS restores every parameter.
+ * SET_WAVE and SET_DUTY are the DAC waveform and square duty, output is ignored.
+ * CAL is a calibration step, PARAM_SEL_VAL() of a CAL_STEP_T and the measured mV.
+ * PULSE_DUTY is PARAM_SEL_VAL() of a PULSE_DUTY_MODE and the permille or us.
+ * SWEEP sweeps to the value from the set frequency, or stops with 0. BURST_FIRE is the
+ * software burst trigger, each one posted is fired.
+ *****************************************************************************************/
+typedef enum {PARAM_SET_FREQ, PARAM_SET_LEVEL, PARAM_SET_MODE, PARAM_DEFAULTS,
+              PARAM_SET_WAVE, PARAM_SET_DUTY, PARAM_SWEEP, PARAM_MOD, PARAM_BURST,
+              PARAM_DUAL, PARAM_CAL, PARAM_PULSE_DUTY, PARAM_BURST_FIRE} PARAM_CMD_T;
+/* Calibration steps: hold the low code, low reading in and hold the high code, */
+/* high reading in and save, or cancel */
+typedef enum {CAL_START, CAL_LO_READ, CAL_HI_READ, CAL_CANCEL} CAL_STEP_T;
+#define PARAM_SAVE          1U
+#define PARAM_NO_SAVE       0U
+#define PARAM_MSG(cmd,out,save,val) ((void *)(((INT32U)(cmd)<<28)|((INT32U)(save)<<27)| \
+                                              ((INT32U)(out)<<24)|(INT16U)(val)))
+#define PARAM_MSG_CMD(msg)  ((PARAM_CMD_T)((INT32U)(msg)>>28))
+#define PARAM_MSG_SAVE(msg) (((INT32U)(msg)>>27) & 1U)
+#define PARAM_MSG_OUT(msg)  ((UI_STATES_T)(((INT32U)(msg)>>24) & 7U))
+#define PARAM_MSG_VAL(msg)  ((INT16U)(INT32U)(msg))
+#define PARAM_SEL_VAL(sel,arg)      ((INT16U)(((INT16U)(sel)<<14)|(arg)))  /* 2-bit selector, arg < 2^14 */
+#define PARAM_SEL(val)              ((val)>>14)
+#define PARAM_ARG(val)              ((val) & 0x3FFFU)
 /*****************************************************************************************
  * Private Resources
  *****************************************************************************************/
 static UI_STATES_T appUIState;								 /* UI state machine 	     	 */
 static OS_MUTEX appUIStateKey;							 /* MUTEX key for the appUIState    */
+static SAVED_CONFIG appSavedConfig;						 /* EEPROM image, appParamTask only */
+static INT32U appParamDropped;							 /* Commands lost to a full queue   */
+static const INT8C *const appWaveNames[WAVE_NUM] = {" SINE", "  TRI", "  SAW", " RAMP", "SQ   ", "  ARB", "MULTI", "WHITE", " PINK"};
 
 /*****************************************************************************************
  * Allocate task control blocks
@@ -37,6 +98,7 @@ static OS_MUTEX appUIStateKey;							 /* MUTEX key for the appUIState    */
 static OS_TCB appStartTaskTCB;
 static OS_TCB appProcessKeyTaskTCB;
 static OS_TCB appTouchSensorTaskTCB;
+static OS_TCB appParamTaskTCB;
 
 /*****************************************************************************************
  * Allocate task stack space.
@@ -44,6 +106,7 @@ static OS_TCB appTouchSensorTaskTCB;
 static CPU_STK appStartTaskStk[APP_CFG_START_TASK_STK_SIZE];
 static CPU_STK appProcessKeyTaskStk[APP_CFG_APP_PROCESS_KEY_TASK_STK_SIZE];
 static CPU_STK appTouchSensorTaskStk[APP_CFG_APP_TOUCH_SENSOR_TASK_STK_SIZE];
+static CPU_STK appParamTaskStk[APP_CFG_APP_PARAM_TASK_STK_SIZE];
 
 /*****************************************************************************************
  * Task Function Prototypes.
@@ -51,12 +114,17 @@ static CPU_STK appTouchSensorTaskStk[APP_CFG_APP_TOUCH_SENSOR_TASK_STK_SIZE];
 static void  appStartTask(void *p_arg);
 static void  appProcessKeyTask(void *p_arg);
 static void  appTouchSensorTask(void *p_arg);
+static void  appParamTask(void *p_arg);
 
 /*****************************************************************************************
  * Other Function Prototypes.
  *****************************************************************************************/
 static void appDispHelper(UI_STATES_T current_state);
 static INT8U appIntLen(INT16U input);
+static INT8U appTouchStep(INT8U level, INT8U up);
+static void appParamPost(PARAM_CMD_T cmd, UI_STATES_T out, INT8U save, INT16U val);
+static void appParamSave(PARAM_CMD_T cmd, UI_STATES_T out, INT16U val);
+static INT32U appPulseDuty(INT16U val);
 
 /*****************************************************************************************
  * main()
@@ -88,11 +156,14 @@ void main(void) {
 /*****************************************************************************************
  * STARTUP TASK
  * This should run once and be deleted. Could restart everything by creating.
+ * appParamTask is created once appSavedConfig is loaded, it owns it from then on.
  * 02/12/2022 Nick Coyle
+ * 10/19/2026 appParamTask created after the configuration is loaded
  *****************************************************************************************/
 static void appStartTask(void *p_arg) {
 	OS_ERR os_err;
 	SAVED_CONFIG loaded_state;
+	DAC_CAL cal;
 	UI_STATES_T current;
 	(void)p_arg;                       				/* Avoid compiler warning for unused variable   */
 
@@ -132,6 +203,9 @@ static void appStartTask(void *p_arg) {
 	TSIInit();
 	DMAInit();
     SineGenInit();
+#if (APP_CFG_AWG_LOAD_EN == DEF_ENABLED)
+    AwgLoaderInit();
+#endif
     PulseTrainInit();
     EEPROMInit();
 
@@ -146,8 +220,33 @@ static void appStartTask(void *p_arg) {
     OSMutexPost(&appUIStateKey, OS_OPT_POST_NONE, &os_err);
     SinewaveSetFreq(loaded_state.sine_freq);
     SinewaveSetLevel(loaded_state.sine_level);
-    PulseTrainSetFreq(loaded_state.pulse_freq);
-    PulseTrainSetLevel(loaded_state.pulse_level);
+    PulseTrainSet(loaded_state.pulse_freq, loaded_state.pulse_level);
+    if(loaded_state.pulse_duty_mode != PULSE_DUTY_LEVEL){
+        PulseTrainSetDuty((PULSE_DUTY_MODE)loaded_state.pulse_duty_mode, loaded_state.pulse_duty);
+    }else{
+    }
+    if((loaded_state.sine_wave >= WAVE_NUM) || (loaded_state.sine_wave == WAVE_ARB)){
+        loaded_state.sine_wave = WAVE_SINE;         /* Arbitrary tables are not saved */
+    }else{
+    }
+    WaveformSetType((WAVE_T)loaded_state.sine_wave);
+    WaveformSetDuty(loaded_state.sine_duty);
+    (void)EEPROMGetCal(&cal);                       /* Defaults if never calibrated */
+    SineCalSet(&cal);
+    appSavedConfig = loaded_state;                  /* Loaded before appParamTask is created */
+    OSTaskCreate(&appParamTaskTCB,    			/* Create appParamTask                          */
+			"App Param Task",
+			appParamTask,
+			(void *) 0,
+			APP_CFG_APP_PARAM_TASK_PRIO,
+			&appParamTaskStk[0],
+			(APP_CFG_APP_PARAM_TASK_STK_SIZE / 10u),
+			APP_CFG_APP_PARAM_TASK_STK_SIZE,
+			PARAM_Q_SIZE,                       /* Parameter command queue                      */
+			0,
+			(void *) 0,
+			(OS_OPT_TASK_NONE),
+			&os_err);
     appDispHelper(current);
     OSTaskDel((OS_TCB *)0, &os_err);
 }
@@ -155,101 +254,267 @@ static void appStartTask(void *p_arg) {
  * appProcessKeyTask
  * UI to edit the function generator frequency and type of wave.
  * Display the current appUIState on the LCD.
- * Pends on a keypress from the uCOSKey Module.
+ * Pends on key events from the uCOSKey Module. A key acts when it is released, or at
+ * its first auto-repeat, and holding a digit keeps entering it. A key that is part of a
+ * chord does not act, even if it went down before the *.
+ * Chord * + # mutes the outputs without saving the muted level. Unmuting restores the
+ * levels and the pulse duty, unless they were changed while muted.
+ * Chord * + C sweeps the sine from its frequency to the one entered, restarting a sweep
+ * that runs, or with nothing entered stops the sweep.
+ * Chord * + D steps the sine modulation. A number entered first is used as the depth.
+ * Chord * + B steps the burst mode, a number entered first is the cycle count.
+ * Chord * + 0 fires a burst, or opens and closes the gate.
+ * Chord * + A calibrates DAC0: the first holds SINE_CAL_CODE_LO, then the mV measured
+ * is entered and * + A holds SINE_CAL_CODE_HI, then that mV is entered and * + A saves.
+ * * + A with nothing entered cancels.
+ * Chord * + 1 sets the pulse width to the number entered, in us.
+ * Parameter changes are posted to appParamTask, only the frequency entry is drawn here.
+ * * selects the next DAC waveform when released, or with 1-99 entered sets the square
+ * duty. With the pulse train, * with 1-1000 entered sets its duty in permille, and
+ * with nothing entered goes back to the level's duty. A * that was part of a chord
+ * does neither.
  * 02/12/2022 Nick Coyle
+ * 10/19/2026 Posts parameter commands instead of calling the setters
+ * 10/19/2026 Keys act on release so a chord's first key is not run on its own
+ * 10/19/2026 Unmute restores a permille or pulse width duty
+ * 10/19/2026 * + C and * + 0 are posted, the key task no longer calls the generator
  *****************************************************************************************/
 static void appProcessKeyTask(void *p_arg){
 	OS_ERR os_err;
 	INT8C kchar;
+	KEY_EVENT key_event;
 	INT8U number_value;
 	UI_STATES_T current_state;
     INT16U user_freq = 0;
+	INT8U muted = FALSE;
+	INT8U mute_sine_level = 0;
+	INT8U mute_pulse_level = 0;
+	PULSE_DUTY_MODE mute_pulse_mode = PULSE_DUTY_LEVEL;
+	INT32U mute_pulse_duty = 0;
+	INT8U star_chord = FALSE;
+	INT8C key_pending = 0;                          /* Pressed key, acts on release */
+	INT8U key_acts;
+	WAVE_T wave;
+	MOD_TYPE mod = MOD_OFF;
+	INT16U mod_depth;
+	BURST_MODE burst = BURST_OFF;
+	INT16U burst_cycles;
+	INT8U dual = FALSE;
+	CAL_STEP_T cal_step = CAL_CANCEL;
 	(void)p_arg;
 
 	OSMutexPend(&appUIStateKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
 		current_state = appUIState;
 	OSMutexPost(&appUIStateKey, OS_OPT_POST_NONE, &os_err);
+	wave = WaveformGetType();
 
 	while(1){
 		DB1_TURN_OFF();                             /* Turn off debug bit while waiting */
-		kchar = KeyPend(0, &os_err);
+		KeyEventWait(0, &os_err);
 		DB1_TURN_ON();                         		/* Turn on debug bit while ready/running*/
 
-		switch(kchar) {
-		case '*':	/* * Key Not Used */
-			break;
-		case DC1: 	/* A Key */
-			current_state = SINEWAVE;
-			EEPROMSaveState(0);
-			break;
-		case DC2:	/* B Key */
-			current_state = PULSE_TRAIN;
-			EEPROMSaveState(1);
-			break;
-		case DC4:	/* D Key */
-			current_state = SINEWAVE;
-			EEPROMSaveState(0);
-			SinewaveSetFreq(DEFAULT_FREQ);
-			SinewaveSetLevel(DEFAULT_LEVEL);
-			PulseTrainSetFreq(DEFAULT_FREQ);
-			PulseTrainSetLevel(DEFAULT_LEVEL);
-			EEPROMSaveSineFreq(DEFAULT_FREQ);
-			EEPROMSaveSineLevel(DEFAULT_LEVEL);
-			EEPROMSavePulseFreq(DEFAULT_FREQ);
-			EEPROMSavePulseLevel(DEFAULT_LEVEL);
-			break;
-		case '#': 	/* ENTER Key */
-			if(user_freq >= FREQ_LIMIT_LOW && user_freq <= FREQ_LIMIT_HIGH){
-				LcdDispClear(LCD_LAYER_USER_FREQ);
-				LcdDispClear(LCD_LAYER_FREQ);
-				if(current_state == PULSE_TRAIN) {
-					PulseTrainSetFreq(user_freq);
-					EEPROMSavePulseFreq(user_freq);
+		while(KeyEventGet(&key_event)) {            /* Drain every queued event, one redraw */
+			kchar = key_event.code;
+			key_acts = 0;
+			if(key_event.type == KEY_EV_PRESS) {
+				if(kchar == '*') {                  /* * Key, acts on release */
+					star_chord = FALSE;
 				} else {
-					SinewaveSetFreq(user_freq);
-					EEPROMSaveSineFreq(user_freq);
+					key_pending = kchar;
 				}
-				user_freq = 0;
+			} else if(key_event.type == KEY_EV_REPEAT) {
+				if(key_pending == kchar) {          /* The held press, then the repeat */
+					key_acts = 2;
+				} else {
+					key_acts = 1;
+				}
+				key_pending = 0;
+			} else if((key_event.type == KEY_EV_RELEASE) && (kchar != '*')) {
+				if(key_pending == kchar) {
+					key_acts = 1;
+				} else {
+				}
+				key_pending = 0;
 			} else {
-				// do nothing
 			}
-			break;
-		case DC3: 	/* BACKSPACE Key */
-			if(user_freq > 9) {
-				user_freq = user_freq / 10;
-				LcdDispClear(LCD_LAYER_USER_FREQ);
-				LcdDispDecWord(LCD_ROW_1, LCD_COL_1, LCD_LAYER_USER_FREQ, (INT32U)user_freq, 5, LCD_DEC_MODE_AL);
-			} else {
-				LcdDispClear(LCD_LAYER_USER_FREQ);
-				user_freq = 0;
+			for(; key_acts > 0; key_acts--) {
+				switch(kchar) {
+				case DC1: 	/* A Key */
+					current_state = SINEWAVE;
+					appParamPost(PARAM_SET_MODE, SINEWAVE, PARAM_SAVE, 0);
+					break;
+				case DC2:	/* B Key */
+					current_state = PULSE_TRAIN;
+					appParamPost(PARAM_SET_MODE, PULSE_TRAIN, PARAM_SAVE, 0);
+					break;
+				case DC4:	/* D Key */
+					current_state = SINEWAVE;
+					wave = WAVE_SINE;
+					appParamPost(PARAM_DEFAULTS, SINEWAVE, PARAM_SAVE, 0);
+					break;
+				case '#': 	/* ENTER Key */
+					if(user_freq >= FREQ_LIMIT_LOW && user_freq <= FREQ_LIMIT_HIGH){
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						appParamPost(PARAM_SET_FREQ, current_state, PARAM_SAVE, user_freq);
+						user_freq = 0;
+					} else {
+						// do nothing
+					}
+					break;
+				case DC3: 	/* BACKSPACE Key */
+					if(user_freq > 9) {
+						user_freq = user_freq / 10;
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						LcdDispDecWord(LCD_ROW_1, LCD_COL_1, LCD_LAYER_USER_FREQ, (INT32U)user_freq, 5, LCD_DEC_MODE_AL);
+					} else {
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						user_freq = 0;
+					}
+					break;
+				default:	/* Any Number Keys */
+					number_value = kchar - ASCII_CODE_ZERO;
+					if(user_freq == 0) {
+						if(kchar != '0') {
+							user_freq = number_value;
+							LcdDispDecWord(LCD_ROW_1, LCD_COL_1, LCD_LAYER_USER_FREQ, (INT32U)user_freq, 5, LCD_DEC_MODE_AL);
+						} else {
+							// do nothing
+						}
+					} else {
+						if(((user_freq*10) + number_value) <= FREQ_LIMIT_HIGH){
+							user_freq = (user_freq*10) + number_value;
+							LcdDispDecWord(LCD_ROW_1, LCD_COL_1, LCD_LAYER_USER_FREQ, (INT32U)user_freq, 5, LCD_DEC_MODE_AL);
+						} else {
+							// do nothing
+						}
+					}
+					break;
+				}
 			}
-			break;
-		default:	/* Any Number Keys */
-			number_value = kchar - ASCII_CODE_ZERO;
-			if(user_freq == 0) {
-				if(kchar != '0') {
-					user_freq = number_value;
-					LcdDispDecWord(LCD_ROW_1, LCD_COL_1, LCD_LAYER_USER_FREQ, (INT32U)user_freq, 5, LCD_DEC_MODE_AL);
+			if((key_event.type == KEY_EV_RELEASE) && (key_event.code == '*')) {
+				if((star_chord == FALSE) && (current_state == SINEWAVE)) {
+					if((user_freq >= 1) && (user_freq <= 99)) {		/* Entry is a square duty */
+						appParamPost(PARAM_SET_DUTY, SINEWAVE, PARAM_SAVE, user_freq);
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						user_freq = 0;
+					} else {
+						wave = (WAVE_T)((wave + 1) % WAVE_NUM);
+						if((wave == WAVE_ARB) && (AwgGetLength() == 0)){	/* Skip ARB until a table is loaded */
+							wave = (WAVE_T)(wave + 1);
+						}else{
+						}
+						appParamPost(PARAM_SET_WAVE, SINEWAVE, PARAM_SAVE, wave);
+					}
+				} else if(star_chord == FALSE) {			/* Pulse train */
+					if((user_freq >= 1) && (user_freq <= PULSE_PERMILLE_MAX)) {
+						appParamPost(PARAM_PULSE_DUTY, PULSE_TRAIN, PARAM_SAVE, PARAM_SEL_VAL(PULSE_DUTY_PERMILLE, user_freq));
+					} else {
+						appParamPost(PARAM_PULSE_DUTY, PULSE_TRAIN, PARAM_SAVE, PARAM_SEL_VAL(PULSE_DUTY_LEVEL, 0));
+					}
+					LcdDispClear(LCD_LAYER_USER_FREQ);
+					user_freq = 0;
 				} else {
-					// do nothing
 				}
-			} else {
-				if(((user_freq*10) + number_value) <= FREQ_LIMIT_HIGH){
-					user_freq = (user_freq*10) + number_value;
-					LcdDispDecWord(LCD_ROW_1, LCD_COL_1, LCD_LAYER_USER_FREQ, (INT32U)user_freq, 5, LCD_DEC_MODE_AL);
+			} else if(key_event.type == KEY_EV_CHORD) {
+				star_chord = TRUE;
+				key_pending = 0;
+				if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask('#'))) {	/* * + # toggles output mute */
+					if(muted == FALSE) {
+						mute_sine_level = SinewaveGetLevel();
+						mute_pulse_level = PulseTrainGetLevel();
+						mute_pulse_mode = PulseTrainGetDuty(&mute_pulse_duty);	/* Level 0 clears it */
+						appParamPost(PARAM_SET_LEVEL, SINEWAVE, PARAM_NO_SAVE, 0);
+						appParamPost(PARAM_SET_LEVEL, PULSE_TRAIN, PARAM_NO_SAVE, 0);
+						muted = TRUE;
+					} else {
+						if(SinewaveGetLevel() == 0) {		/* restore unless changed while muted */
+							appParamPost(PARAM_SET_LEVEL, SINEWAVE, PARAM_NO_SAVE, mute_sine_level);
+						} else {
+						}
+						if(PulseTrainGetLevel() == 0) {
+							appParamPost(PARAM_SET_LEVEL, PULSE_TRAIN, PARAM_NO_SAVE, mute_pulse_level);
+							if(mute_pulse_mode == PULSE_DUTY_NS) {		/* Posted in us */
+								appParamPost(PARAM_PULSE_DUTY, PULSE_TRAIN, PARAM_NO_SAVE, PARAM_SEL_VAL(PULSE_DUTY_NS, mute_pulse_duty / 1000));
+							} else if(mute_pulse_mode == PULSE_DUTY_PERMILLE) {
+								appParamPost(PARAM_PULSE_DUTY, PULSE_TRAIN, PARAM_NO_SAVE, PARAM_SEL_VAL(PULSE_DUTY_PERMILLE, mute_pulse_duty));
+							} else {
+							}
+						} else {
+						}
+						muted = FALSE;
+					}
+				} else if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask(DC3))) {	/* * + C sweep */
+					if(user_freq == 0) {
+						appParamPost(PARAM_SWEEP, SINEWAVE, PARAM_NO_SAVE, 0);
+					} else if(user_freq >= FREQ_LIMIT_LOW && user_freq <= FREQ_LIMIT_HIGH) {
+						appParamPost(PARAM_SWEEP, SINEWAVE, PARAM_NO_SAVE, user_freq);
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						user_freq = 0;
+					} else {
+					}
+				} else if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask(DC4))) {	/* * + D modulation */
+					mod = (MOD_TYPE)((mod + 1) % MOD_NUM);
+					if(user_freq != 0) {
+						mod_depth = user_freq;
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						user_freq = 0;
+					} else if(mod == MOD_AM) {
+						mod_depth = MOD_AM_DEFAULT;
+					} else if(mod == MOD_FM) {
+						mod_depth = MOD_FM_DEFAULT;
+					} else {
+						mod_depth = MOD_PM_DEFAULT;
+					}
+					appParamPost(PARAM_MOD, SINEWAVE, PARAM_NO_SAVE, PARAM_SEL_VAL(mod, mod_depth));
+				} else if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask(DC2))) {	/* * + B burst mode */
+					burst = (BURST_MODE)((burst + 1) % (BURST_GATED + 1));
+					if(burst == BURST_GATED) {
+						burst_cycles = BURST_GATE_CYCLES;
+					} else if(user_freq != 0) {
+						burst_cycles = user_freq;
+					} else {
+						burst_cycles = BURST_CYCLES_DEFAULT;
+					}
+					LcdDispClear(LCD_LAYER_USER_FREQ);
+					user_freq = 0;
+					appParamPost(PARAM_BURST, SINEWAVE, PARAM_NO_SAVE, PARAM_SEL_VAL(burst, burst_cycles));
+				} else if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask('0'))) {	/* * + 0 fires */
+					appParamPost(PARAM_BURST_FIRE, SINEWAVE, PARAM_NO_SAVE, 0);
+				} else if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask('1'))) {	/* * + 1 pulse width */
+					if(user_freq != 0) {
+						appParamPost(PARAM_PULSE_DUTY, PULSE_TRAIN, PARAM_SAVE, PARAM_SEL_VAL(PULSE_DUTY_NS, user_freq));
+						LcdDispClear(LCD_LAYER_USER_FREQ);
+						user_freq = 0;
+					} else {
+					}
+				} else if(key_event.mask == (KeyCodeMask('*')|KeyCodeMask(DC1))) {	/* * + A calibration */
+					if(cal_step == CAL_CANCEL) {
+						cal_step = CAL_START;
+					} else if(user_freq == 0) {
+						cal_step = CAL_CANCEL;
+					} else if(cal_step == CAL_START) {
+						cal_step = CAL_LO_READ;
+					} else {
+						cal_step = CAL_HI_READ;
+					}
+					appParamPost(PARAM_CAL, SINEWAVE, PARAM_NO_SAVE, PARAM_SEL_VAL(cal_step, user_freq));
+					if(cal_step == CAL_HI_READ) {
+						cal_step = CAL_CANCEL;
+					} else {
+					}
+					LcdDispClear(LCD_LAYER_USER_FREQ);
+					user_freq = 0;
 				} else {
-					// do nothing
+					// other chords not used
 				}
+			} else if((key_event.type == KEY_EV_LONG) && (key_event.code == DC1)) {	/* Hold A */
+				key_pending = 0;                    /* Not a mode change on release */
+				dual = !dual;
+				appParamPost(PARAM_DUAL, SINEWAVE, PARAM_NO_SAVE, dual);
+			} else {
+				// presses, other releases and long-presses handled above or not used
 			}
-			break;
 		}
-
-		// store the state
-		OSMutexPend(&appUIStateKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
-			appUIState = current_state;
-		OSMutexPost(&appUIStateKey, OS_OPT_POST_NONE, &os_err);
-
-		appDispHelper(current_state);
 	}
 }
 /*****************************************************************************************
@@ -257,94 +522,488 @@ static void appProcessKeyTask(void *p_arg){
 * UI to edit the function generator level.
 * There are 21 linear levels from 0-20.
 * Pends on input from touch sensors.
+* A touch of one pad steps the level by one, pad 1 up and pad 2 down. Holding the pad
+* ramps the level, faster the longer it is held. Touching both pads is a slider, the
+* level follows the ratio of the pad deltas, 20 with all on pad 1 and 0 with all on
+* pad 2. Changes are rate limited to one per TOUCH_UPDATE_PERIOD and the level is saved
+* to EEPROM once, when both pads are released.
 * 02/16/2022 Aili Emory
+* 10/19/2026 Hold-to-ramp and two-pad slider, one EEPROM save per gesture
+* 10/19/2026 Levels are posted to appParamTask
  *****************************************************************************************/
 static void appTouchSensorTask(void *p_arg){
     OS_ERR os_err;
     OS_FLAGS cur_sense_flags;
-    UI_STATES_T current_state;
-    INT8U level;
+    UI_STATES_T current_state = SINEWAVE;
+    TSI_PAD pad1;
+    TSI_PAD pad2;
+    INT8U active = FALSE;
+    INT8U level = 0;
+    INT8U target = 0;
+    INT8U start_level = 0;
+    INT32U sum;
+    OS_TICK now;
+    OS_TICK last_update = 0;
+    OS_TICK next_ramp = 0;
+    OS_TICK ramp_interval = TOUCH_RAMP_START;
     (void)p_arg;
 
     while(1){
-    	cur_sense_flags = TSIPend(0,&os_err);
+        cur_sense_flags = TSIPend(active ? TOUCH_POLL_PERIOD : 0, &os_err);     /* Poll during a gesture */
         if(os_err == OS_ERR_TIMEOUT){
             cur_sense_flags = 0;
         }else{
         }
-        OSMutexPend(&appUIStateKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
-            current_state = appUIState;                                            /* Determine Current State */
-        OSMutexPost(&appUIStateKey, OS_OPT_POST_NONE, &os_err);
-		if(current_state == SINEWAVE){
-            level = SinewaveGetLevel();
-        }else if(current_state == PULSE_TRAIN){
-            level = PulseTrainGetLevel();
-        } else {
-        	// do nothing
+        now = OSTimeGet(&os_err);
+        TSIGetPad(BRD_PAD1_CH, &pad1);
+        TSIGetPad(BRD_PAD2_CH, &pad2);
+        if(!active){                                                            /* Gesture start */
+            OSMutexPend(&appUIStateKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+                current_state = appUIState;                                     /* Determine Current State */
+            OSMutexPost(&appUIStateKey, OS_OPT_POST_NONE, &os_err);
+            if(current_state == SINEWAVE){
+                level = SinewaveGetLevel();
+            }else{
+                level = PulseTrainGetLevel();
+            }
+            target = level;
+            start_level = level;
+            last_update = now - TOUCH_UPDATE_PERIOD;
+            next_ramp = now + TOUCH_RAMP_DELAY;
+            ramp_interval = TOUCH_RAMP_START;
+            active = TRUE;
+        }else{
         }
-        if((cur_sense_flags & (1<<BRD_PAD1_CH)) != 0){                          /* Increment Level */
-            if(level >= 20){
-                //do nothing
+
+        if(pad1.touched && pad2.touched){                                       /* Slider */
+            sum = (INT32U)pad1.delta + pad2.delta;
+            if(sum != 0){
+                target = (INT8U)(((20u * pad1.delta) + (sum / 2u)) / sum);
+            }else{
+            }
+            next_ramp = now + TOUCH_RAMP_DELAY;
+        }else if(pad1.touched || pad2.touched){
+            if((cur_sense_flags & ((1<<BRD_PAD1_CH)|(1<<BRD_PAD2_CH))) != 0){   /* New touch steps once */
+                next_ramp = now + TOUCH_RAMP_DELAY;
+                ramp_interval = TOUCH_RAMP_START;
+                target = appTouchStep(target, pad1.touched);
+            }else if((OS_TICK)(now - next_ramp) < (OS_TICK)0x80000000u){       /* Held, ramp */
+                target = appTouchStep(target, pad1.touched);
+                next_ramp = now + ramp_interval;
+                ramp_interval -= ramp_interval >> 2;                            /* Accelerate 25% per step */
+                if(ramp_interval < TOUCH_RAMP_MIN){
+                    ramp_interval = TOUCH_RAMP_MIN;
+                }else{
+                }
             }else{
-                level = level + 1;
             }
+        }else if((cur_sense_flags & ((1<<BRD_PAD1_CH)|(1<<BRD_PAD2_CH))) != 0){ /* Tap shorter than a scan */
+            target = appTouchStep(target, (cur_sense_flags & (1<<BRD_PAD1_CH)) != 0);
+        }else{
+        }
+
+        if((target != level) && ((now - last_update) >= TOUCH_UPDATE_PERIOD)){  /* Rate limited apply */
+            level = target;
+            last_update = now;
+            appParamPost(PARAM_SET_LEVEL, current_state, PARAM_NO_SAVE, level);
         }else{
         }
-        if((cur_sense_flags & (1<<BRD_PAD2_CH)) != 0){                          /* Decrement Level */
-            if(level <= 0){
-                //do nothing
+
+        if(!pad1.touched && !pad2.touched && (target == level)){                /* Gesture end, save once */
+            if(level != start_level){
+                appParamPost(PARAM_SET_LEVEL, current_state, PARAM_SAVE, level);
             }else{
-                level = level - 1;
             }
+            active = FALSE;
         }else{
         }
+    }
+}
+/*****************************************************************************************
+* appParamTask
+* Applies parameter commands from the UI tasks. Every command queued by the time the
+* task runs is drained first and collapsed, only the last value of each parameter is
+* applied. The generators are then set, the display redrawn once and the EEPROM
+* written once for any saved change. While the quadrature output is on, a sine level
+* is set on B as well, mutes included. Burst triggers are not collapsed, each is fired
+* after any burst mode change drained with it.
+* 10/19/2026
+*****************************************************************************************/
+static void appParamTask(void *p_arg){
+	OS_ERR os_err;
+	OS_MSG_SIZE msg_size;
+	void *msg;
+	INT16U freq[2] = {0, 0};
+	INT8U level[2] = {0, 0};
+	INT8U set_freq[2];
+	INT8U set_level[2];
+	INT8U set_mode;
+	INT8U set_wave;
+	INT8U set_duty;
+	INT8U set_sweep;
+	INT16U sweep_stop = 0;
+	SWEEP_CFG sweep;
+	INT8U set_mod;
+	MOD_CFG mod_cfg;
+	INT8U set_burst;
+	BURST_CFG burst_cfg;
+	INT8U burst_fires;
+	INT8U set_dual;
+	DUAL_CFG dual_cfg;
+	INT8U set_cal;
+	INT8U set_pulse_duty;
+	PULSE_DUTY_MODE pulse_duty_mode = PULSE_DUTY_LEVEL;
+	INT32U pulse_duty = 0;
+	CAL_STEP_T cal_step = CAL_CANCEL;
+	INT16U cal_mv = 0;
+	INT16U cal_lo_mv = 0;
+	DAC_CAL cal;
+	INT8U save;
+	WAVE_T wave = WAVE_SINE;
+	INT8U duty = DEFAULT_DUTY;
+	UI_STATES_T mode = SINEWAVE;
+	UI_STATES_T out;
+	(void)p_arg;
 
-        if(current_state == SINEWAVE){                                          /* Set Level, Display value */
-            SinewaveSetLevel(level);
-            EEPROMSaveSineLevel(level);
+	dual_cfg.on = FALSE;
+	while(1){
+		msg = OSTaskQPend(0, OS_OPT_PEND_BLOCKING, &msg_size, (CPU_TS *)0, &os_err);
+		set_freq[SINEWAVE] = FALSE;
+		set_freq[PULSE_TRAIN] = FALSE;
+		set_level[SINEWAVE] = FALSE;
+		set_level[PULSE_TRAIN] = FALSE;
+		set_mode = FALSE;
+		set_wave = FALSE;
+		set_duty = FALSE;
+		set_sweep = FALSE;
+		set_mod = FALSE;
+		set_burst = FALSE;
+		burst_fires = 0;
+		set_dual = FALSE;
+		set_cal = FALSE;
+		set_pulse_duty = FALSE;
+		save = FALSE;
+		while(os_err == OS_ERR_NONE){						/* Collapse the queued commands */
+			out = PARAM_MSG_OUT(msg);
+			switch(PARAM_MSG_CMD(msg)){
+			case PARAM_SET_FREQ:
+				freq[out] = PARAM_MSG_VAL(msg);
+				set_freq[out] = TRUE;
+				break;
+			case PARAM_SET_LEVEL:
+				level[out] = (INT8U)PARAM_MSG_VAL(msg);
+				set_level[out] = TRUE;
+				if(out == PULSE_TRAIN){						/* A later level takes over the duty */
+					set_pulse_duty = FALSE;
+				}else{
+				}
+				break;
+			case PARAM_SET_MODE:
+				mode = out;
+				set_mode = TRUE;
+				break;
+			case PARAM_DEFAULTS:
+				mode = SINEWAVE;
+				freq[SINEWAVE] = DEFAULT_FREQ;
+				freq[PULSE_TRAIN] = DEFAULT_FREQ;
+				level[SINEWAVE] = DEFAULT_LEVEL;
+				level[PULSE_TRAIN] = DEFAULT_LEVEL;
+				set_mode = TRUE;
+				set_freq[SINEWAVE] = TRUE;
+				set_freq[PULSE_TRAIN] = TRUE;
+				set_level[SINEWAVE] = TRUE;
+				set_level[PULSE_TRAIN] = TRUE;
+				wave = WAVE_SINE;
+				duty = DEFAULT_DUTY;
+				set_wave = TRUE;
+				set_duty = TRUE;
+				break;
+			case PARAM_SET_WAVE:
+				wave = (WAVE_T)PARAM_MSG_VAL(msg);
+				set_wave = TRUE;
+				break;
+			case PARAM_SET_DUTY:
+				duty = (INT8U)PARAM_MSG_VAL(msg);
+				set_duty = TRUE;
+				break;
+			case PARAM_SWEEP:
+				sweep_stop = PARAM_MSG_VAL(msg);
+				set_sweep = TRUE;
+				break;
+			case PARAM_MOD:
+				mod_cfg.type = (MOD_TYPE)PARAM_SEL(PARAM_MSG_VAL(msg));
+				mod_cfg.depth = PARAM_ARG(PARAM_MSG_VAL(msg));
+				set_mod = TRUE;
+				break;
+			case PARAM_BURST:
+				burst_cfg.mode = (BURST_MODE)PARAM_SEL(PARAM_MSG_VAL(msg));
+				burst_cfg.cycles = PARAM_ARG(PARAM_MSG_VAL(msg));
+				set_burst = TRUE;
+				break;
+			case PARAM_BURST_FIRE:							/* Not collapsed, a gate opens and closes */
+				burst_fires++;
+				break;
+			case PARAM_DUAL:
+				dual_cfg.on = (INT8U)PARAM_MSG_VAL(msg);
+				set_dual = TRUE;
+				break;
+			case PARAM_CAL:
+				cal_step = (CAL_STEP_T)PARAM_SEL(PARAM_MSG_VAL(msg));
+				cal_mv = PARAM_ARG(PARAM_MSG_VAL(msg));
+				set_cal = TRUE;
+				break;
+			case PARAM_PULSE_DUTY:
+				pulse_duty_mode = (PULSE_DUTY_MODE)PARAM_SEL(PARAM_MSG_VAL(msg));
+				pulse_duty = appPulseDuty(PARAM_MSG_VAL(msg));
+				set_pulse_duty = TRUE;
+				break;
+			default:
+				break;
+			}
+			if(PARAM_MSG_SAVE(msg)){						/* Saved image follows saved commands only */
+				appParamSave(PARAM_MSG_CMD(msg), out, PARAM_MSG_VAL(msg));
+				save = TRUE;
+			}else{
+			}
+			msg = OSTaskQPend(0, OS_OPT_PEND_NON_BLOCKING, &msg_size, (CPU_TS *)0, &os_err);
+		}
+
+		if(set_freq[SINEWAVE]){								/* Apply */
+			SinewaveSetFreq(freq[SINEWAVE]);
+		}else{
+		}
+		if(set_level[SINEWAVE]){
+			SinewaveSetLevel(level[SINEWAVE]);
+		}else{
+		}
+		if(set_freq[PULSE_TRAIN] && set_level[PULSE_TRAIN]){	/* One FTM3 update */
+			PulseTrainSet(freq[PULSE_TRAIN], level[PULSE_TRAIN]);
+		}else if(set_freq[PULSE_TRAIN]){
+			PulseTrainSetFreq(freq[PULSE_TRAIN]);
+		}else if(set_level[PULSE_TRAIN]){
+			PulseTrainSetLevel(level[PULSE_TRAIN]);
+		}else{
+		}
+		if(set_pulse_duty){
+			PulseTrainSetDuty(pulse_duty_mode, pulse_duty);
+		}else{
+		}
+		if(set_wave){
+			WaveformSetType(wave);
+		}else{
+		}
+		if(set_duty){
+			WaveformSetDuty(duty);
+		}else{
+		}
+		if(set_sweep && (sweep_stop != 0)){					/* From the set frequency */
+			sweep.start_hz = SinewaveGetFreq();
+			sweep.stop_hz = sweep_stop;
+			sweep.duration_ms = SWEEP_TIME_MS;
+			sweep.law = SWEEP_LOG;
+			sweep.mode = SWEEP_REPEAT;
+			SweepStart(&sweep);
+		}else if(set_sweep){
+			SweepStop();
+		}else{
+		}
+		if(set_mod){
+			mod_cfg.shape = LFO_SINE;
+			mod_cfg.rate_dhz = MOD_RATE_DEFAULT;
+			ModulationSet(&mod_cfg);
+		}else{
+		}
+		if(set_burst){
+			burst_cfg.triggers = DMA_TRIG_SW2|DMA_TRIG_SW3;
+			burst_cfg.period_ms = 0;
+			BurstSet(&burst_cfg);
+		}else{
+		}
+		for(; burst_fires > 0; burst_fires--){				/* After a mode posted with it */
+			BurstTrigger();
+		}
+		if(set_dual || (set_level[SINEWAVE] && dual_cfg.on)){	/* I/Q pair, B follows A's level */
+			dual_cfg.wave = WAVE_SINE;
+			dual_cfg.level = SinewaveGetLevel();
+			dual_cfg.phase_deg = DUAL_PHASE_DEG;
+			DualSet(&dual_cfg);
+		}else{
+		}
+		if(set_cal && (cal_step == CAL_START)){
+			SineCalDrive(SINE_CAL_CODE_LO);
+		}else if(set_cal && (cal_step == CAL_LO_READ)){
+			cal_lo_mv = cal_mv;
+			SineCalDrive(SINE_CAL_CODE_HI);
+		}else if(set_cal && (cal_step == CAL_HI_READ)){		/* Trim is kept */
+			SineCalGet(&cal);
+			if(SineCalCompute(cal_lo_mv, cal_mv, &cal)){
+				SineCalSet(&cal);
+				EEPROMSetCal(&cal);
+			}else{
+			}
+			SineCalDrive(SINE_CAL_OFF);
+		}else if(set_cal){
+			SineCalDrive(SINE_CAL_OFF);
+		}else{
+		}
+		OSMutexPend(&appUIStateKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+			if(set_mode){
+				appUIState = mode;
+			}else{
+				mode = appUIState;
+			}
+		OSMutexPost(&appUIStateKey, OS_OPT_POST_NONE, &os_err);
+		if(set_freq[SINEWAVE] || set_freq[PULSE_TRAIN]){
+			LcdDispClear(LCD_LAYER_FREQ);
+		}else{
+		}
+		appDispHelper(mode);
+		if(save){
+			EEPROMSetConfig(&appSavedConfig);				/* Writes only changed words */
+		}else{
+		}
+	}
+}
+/*****************************************************************************************
+* appParamSave
+* Copies the parameters changed by one saved command into the EEPROM image. Unsaved
+* changes, like a mute, never reach the image even when collapsed into the same batch.
+* ARB is not saved, its table is lost at reset, the last saved wave is kept.
+* 10/19/2026
+*****************************************************************************************/
+static void appParamSave(PARAM_CMD_T cmd, UI_STATES_T out, INT16U val){
+	if(cmd == PARAM_SET_FREQ){
+		if(out == SINEWAVE){
+			appSavedConfig.sine_freq = val;
+		}else{
+			appSavedConfig.pulse_freq = val;
+		}
+	}else if(cmd == PARAM_SET_LEVEL){
+		if(out == SINEWAVE){
+			appSavedConfig.sine_level = (INT8U)val;
+		}else{
+			appSavedConfig.pulse_level = (INT8U)val;
+			appSavedConfig.pulse_duty_mode = PULSE_DUTY_LEVEL;
+		}
+	}else if(cmd == PARAM_SET_WAVE){
+		if((WAVE_T)val != WAVE_ARB){				/* The table is not saved, keep the last wave */
+			appSavedConfig.sine_wave = (INT8U)val;
+		}else{
+		}
+	}else if(cmd == PARAM_SET_DUTY){
+		appSavedConfig.sine_duty = (INT8U)val;
+	}else if(cmd == PARAM_SET_MODE){
+		appSavedConfig.state = (out == SINEWAVE) ? 0 : 1;
+	}else if(cmd == PARAM_DEFAULTS){
+		appSavedConfig.state = 0;
+		appSavedConfig.sine_wave = WAVE_SINE;
+		appSavedConfig.sine_duty = DEFAULT_DUTY;
+		appSavedConfig.sine_freq = DEFAULT_FREQ;
+		appSavedConfig.sine_level = DEFAULT_LEVEL;
+		appSavedConfig.pulse_freq = DEFAULT_FREQ;
+		appSavedConfig.pulse_level = DEFAULT_LEVEL;
+		appSavedConfig.pulse_duty_mode = PULSE_DUTY_LEVEL;
+		appSavedConfig.pulse_duty = 0;
+	}else if(cmd == PARAM_PULSE_DUTY){
+		appSavedConfig.pulse_duty_mode = (INT8U)PARAM_SEL(val);
+		appSavedConfig.pulse_duty = appPulseDuty(val);
+	}else{
+	}
+}
+/*****************************************************************************************
+* appParamPost
+* Posts a parameter command to appParamTask and returns. A command that does not fit in
+* the queue is counted in appParamDropped.
+* 10/19/2026
+*****************************************************************************************/
+static void appParamPost(PARAM_CMD_T cmd, UI_STATES_T out, INT8U save, INT16U val){
+	OS_ERR os_err;
+	OSTaskQPost(&appParamTaskTCB, PARAM_MSG(cmd, out, save, val), sizeof(void *), OS_OPT_POST_FIFO, &os_err);
+	if(os_err != OS_ERR_NONE){
+		appParamDropped++;
+	}else{
+	}
+}
+/*****************************************************************************************
+* appTouchStep
+* One level step for a single pad touch, up for pad 1 and down for pad 2, held in 0-20.
+* 10/19/2026
+*****************************************************************************************/
+static INT8U appTouchStep(INT8U level, INT8U up){
+    if(up){
+        if(level < 20){
+            level = level + 1;
+        }else{
+        }
+    }else{
+        if(level > 0){
+            level = level - 1;
         }else{
-            PulseTrainSetLevel(level);
-            EEPROMSavePulseLevel(level);
         }
-        appDispHelper(current_state);
     }
+    return level;
 }
 /*****************************************************************************************
 * appDispHelper
 * Helper function to prevent code duplication. Displays the state, freq, and level
 * on the LCD.
 * 2/18/2022 Nick Coyle
+* 10/19/2026 The DAC output shows its waveform, and duty for square
+* 10/19/2026 The pulse train shows its duty in the mode it is set in, the level in %,
+*            permille as xx.x% or the width in us. All fill columns 11-16.
 *****************************************************************************************/
 static void appDispHelper(UI_STATES_T current_state) {
 	INT8U level;
+	PULSE_DUTY_MODE pulse_mode;
+	INT32U pulse_duty;
+	WAVE_T wave;
+	INT8U duty;
 	INT16U freq;
 	INT8U lenFreq;
 
 	if(current_state == PULSE_TRAIN){
 		freq = PulseTrainGetFreq();
 		lenFreq = appIntLen(freq);
-		level = 5*PulseTrainGetLevel();				/* multiply by 5 to convert to percentage out of 100% */
+		pulse_mode = PulseTrainGetDuty(&pulse_duty);
 		LcdDispString(LCD_ROW_1, LCD_COL_12,LCD_LAYER_UI_STATE,"PULSE");
 		LcdDispDecWord(LCD_ROW_2, LCD_COL_1,LCD_LAYER_FREQ,(INT32U)freq, lenFreq, LCD_DEC_MODE_AL);
 		LcdDispString(LCD_ROW_2, lenFreq+LCD_COL_1,LCD_LAYER_FREQ,"Hz   ");
-		if(level == 100){
-			LcdDispDecWord(LCD_ROW_2, LCD_COL_13,LCD_LAYER_LEVEL,(INT32U)level, 3, LCD_DEC_MODE_AL);
-		}else if(level > 9){
-			LcdDispChar(LCD_ROW_2, LCD_COL_13,LCD_LAYER_LEVEL,' ');
-			LcdDispDecWord(LCD_ROW_2, LCD_COL_14,LCD_LAYER_LEVEL,(INT32U)level, 2, LCD_DEC_MODE_AL);
+		if(pulse_mode == PULSE_DUTY_PERMILLE){							/* xx.x% */
+			LcdDispDecWord(LCD_ROW_2, LCD_COL_11,LCD_LAYER_LEVEL,pulse_duty/10, 3, LCD_DEC_MODE_AR);
+			LcdDispChar(LCD_ROW_2, LCD_COL_14,LCD_LAYER_LEVEL,'.');
+			LcdDispDecWord(LCD_ROW_2, LCD_COL_15,LCD_LAYER_LEVEL,pulse_duty%10, 1, LCD_DEC_MODE_AR);
+			LcdDispChar(LCD_ROW_2, LCD_COL_16,LCD_LAYER_LEVEL,'%');
+		}else if(pulse_mode == PULSE_DUTY_NS){							/* Width in us, xx.xms from 10ms */
+			pulse_duty = pulse_duty/1000;
+			if(pulse_duty < 10000){
+				LcdDispDecWord(LCD_ROW_2, LCD_COL_11,LCD_LAYER_LEVEL,pulse_duty, 4, LCD_DEC_MODE_AR);
+				LcdDispString(LCD_ROW_2, LCD_COL_15,LCD_LAYER_LEVEL,"us");
+			}else{
+				LcdDispDecWord(LCD_ROW_2, LCD_COL_11,LCD_LAYER_LEVEL,pulse_duty/1000, 2, LCD_DEC_MODE_AR);
+				LcdDispChar(LCD_ROW_2, LCD_COL_13,LCD_LAYER_LEVEL,'.');
+				LcdDispDecWord(LCD_ROW_2, LCD_COL_14,LCD_LAYER_LEVEL,(pulse_duty/100)%10, 1, LCD_DEC_MODE_AR);
+				LcdDispString(LCD_ROW_2, LCD_COL_15,LCD_LAYER_LEVEL,"ms");
+			}
 		}else{
-			LcdDispString(LCD_ROW_2, LCD_COL_13,LCD_LAYER_LEVEL,"  ");
-			LcdDispDecWord(LCD_ROW_2, LCD_COL_15,LCD_LAYER_LEVEL,(INT32U)level, 1, LCD_DEC_MODE_AL);
+			level = 5*PulseTrainGetLevel();				/* multiply by 5 to convert to percentage out of 100% */
+			LcdDispDecWord(LCD_ROW_2, LCD_COL_11,LCD_LAYER_LEVEL,(INT32U)level, 5, LCD_DEC_MODE_AR);
+			LcdDispChar(LCD_ROW_2, LCD_COL_16,LCD_LAYER_LEVEL,'%');
 		}
-		LcdDispChar(LCD_ROW_2, LCD_COL_16,LCD_LAYER_LEVEL,'%');
 	}else if(current_state == SINEWAVE){
 		freq = SinewaveGetFreq();
 		lenFreq = appIntLen(freq);
 		level = SinewaveGetLevel();
-		LcdDispString(LCD_ROW_1, LCD_COL_12,LCD_LAYER_UI_STATE," SINE");
+		wave = WaveformGetType();
+		LcdDispString(LCD_ROW_1, LCD_COL_12,LCD_LAYER_UI_STATE,appWaveNames[wave]);
+		if(wave == WAVE_SQUARE){										/* SQ and the duty */
+			duty = WaveformGetDuty();
+			LcdDispDecWord(LCD_ROW_1, LCD_COL_14,LCD_LAYER_UI_STATE,(INT32U)duty, 2, LCD_DEC_MODE_AR);
+			LcdDispChar(LCD_ROW_1, LCD_COL_16,LCD_LAYER_UI_STATE,'%');
+		}else{
+		}
 		LcdDispDecWord(LCD_ROW_2, LCD_COL_1,LCD_LAYER_FREQ,(INT32U)freq, lenFreq, LCD_DEC_MODE_AL);
 		LcdDispString(LCD_ROW_2, lenFreq+LCD_COL_1,LCD_LAYER_FREQ,"Hz   ");
-		LcdDispString(LCD_ROW_2, LCD_COL_13,LCD_LAYER_LEVEL,"  ");
+		LcdDispString(LCD_ROW_2, LCD_COL_11,LCD_LAYER_LEVEL,"    ");			/* Clears the pulse duty */
 		if(level > 9) {
 			LcdDispDecWord(LCD_ROW_2, LCD_COL_15,LCD_LAYER_LEVEL,(INT32U)level, 2, LCD_DEC_MODE_AL);
 		}else{
@@ -368,3 +1027,17 @@ static INT8U appIntLen(INT16U input){
 	}
 	return lenInput;
 }
+/*****************************************************************************************
+* appPulseDuty
+* Permille or ns for PulseTrainSetDuty() from a PULSE_DUTY command value, the keypad
+* width is in us
+* 10/19/2026
+*****************************************************************************************/
+static INT32U appPulseDuty(INT16U val){
+	INT32U duty = PARAM_ARG(val);
+	if(PARAM_SEL(val) == PULSE_DUTY_NS){
+		duty = duty * 1000;
+	}else{
+	}
+	return duty;
+}
@@ -0,0 +1,262 @@
+/*****************************************************************************************
+* AwgLoader Module
+* UART2 receive interrupt fills a byte ring and wakes awgLoadTask when the line goes idle
+* or AWG_RX_POST bytes are waiting. The task runs the frame state machine, see
+* AwgLoader.h, and hands the samples to the arbitrary waveform staging table in chunks
+* of AWG_CHUNK. A refused AwgLoadBegin() does not stop the frame, its samples are read
+* and dropped so the next frame starts in step.
+* 10/19/2026
+*****************************************************************************************/
+#include "os.h"
+#include "app_cfg.h"
+#include "MCUType.h"
+#include "EEPROM.h"
+#include "SineGeneration.h"
+#include "AwgLoader.h"
+
+#define BUS_FREQ        60000000    /* UART2 clock */
+#define AWG_SBR         (BUS_FREQ / (16 * AWG_BAUD))
+#define AWG_BRFA        (((2 * BUS_FREQ) / AWG_BAUD) - (32 * AWG_SBR))  /* 1/32 steps */
+#define AWG_UART_MUX    3U          /* PTE16 TX, PTE17 RX */
+#define AWG_TX_PIN      16U
+#define AWG_RX_PIN      17U
+#define AWG_RX_SIZE     256U        /* 22ms of bytes at 115200 */
+#define AWG_RX_MASK     (AWG_RX_SIZE - 1U)
+#define AWG_RX_POST     (AWG_RX_SIZE / 2U)
+#define AWG_CHUNK       32U         /* Samples per AwgLoadChunk() */
+#define AWG_FRAME_TOUT  500U        /* Ticks without a byte that end a frame */
+#define AWG_SYNC_0      'A'
+#define AWG_SYNC_1      'W'
+
+typedef enum {AWG_SYNC_A, AWG_SYNC_W, AWG_LEN_LO, AWG_LEN_HI, AWG_DATA_LO, AWG_DATA_HI,
+              AWG_SUM_LO, AWG_SUM_HI} AWG_RX_STATE;
+/*****************************************************************************************
+* Frame being received, awgLoadTask only
+*****************************************************************************************/
+typedef struct{
+    AWG_RX_STATE state;
+    INT16U length;
+    INT16U count;               /* Samples received */
+    INT16U sum;
+    INT16U word;                /* Low byte of the value being received */
+    INT8U loading;              /* AwgLoadBegin() took the frame */
+    INT16U chunk_n;
+    INT16U chunk[AWG_CHUNK];
+}AWG_FRAME;
+
+static OS_TCB awgLoadTaskTCB;
+static CPU_STK awgLoadTaskStk[APP_CFG_AWG_LOAD_TASK_STK_SIZE];
+static INT8U awgRx[AWG_RX_SIZE];
+static volatile INT16U awgRxIn;             /* Written by the ISR */
+static INT16U awgRxOut;                     /* Written by the task */
+static AWG_FRAME awgFrame;
+static AWG_LOAD_STATS awgStats;
+
+static void awgLoadTask(void *p_arg);
+static void awgRxByte(AWG_FRAME *frame, INT8U byte);
+static void awgChunkFlush(AWG_FRAME *frame);
+static void awgReply(INT8U reply);
+void UART2_RX_TX_IRQHandler(void);
+/*****************************************************************************************
+* AwgLoaderInit - UART2 at AWG_BAUD 8N1 from the bus clock, receive and idle interrupts
+* 10/19/2026
+*****************************************************************************************/
+void AwgLoaderInit(void){
+    OS_ERR os_err;
+
+    SIM->SCGC4 |= SIM_SCGC4_UART2(1);
+    SIM->SCGC5 |= SIM_SCGC5_PORTE(1);
+    PORTE->PCR[AWG_TX_PIN] = PORT_PCR_MUX(AWG_UART_MUX);
+    PORTE->PCR[AWG_RX_PIN] = PORT_PCR_MUX(AWG_UART_MUX);
+    UART2->C2 = 0;                                  /* Off while the rate is set */
+    UART2->BDH = UART_BDH_SBR(AWG_SBR >> 8);
+    UART2->BDL = UART_BDL_SBR(AWG_SBR);
+    UART2->C4 = UART_C4_BRFA(AWG_BRFA);
+    UART2->C1 = 0;                                  /* 8N1 */
+    awgRxIn = 0;
+    awgRxOut = 0;
+    awgFrame.state = AWG_SYNC_A;
+
+    OSTaskCreate(&awgLoadTaskTCB,
+                "AWG Load Task",
+                awgLoadTask,
+                (void *) 0,
+                APP_CFG_AWG_LOAD_TASK_PRIO,
+                &awgLoadTaskStk[0],
+                (APP_CFG_AWG_LOAD_TASK_STK_SIZE / 10u),
+                APP_CFG_AWG_LOAD_TASK_STK_SIZE,
+                0,
+                0,
+                (void *) 0,
+                (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
+                &os_err);
+    UART2->C2 = UART_C2_TE(1)|UART_C2_RE(1)|UART_C2_RIE(1)|UART_C2_ILIE(1);
+    NVIC_EnableIRQ(UART2_RX_TX_IRQn);
+}
+/*****************************************************************************************
+* AwgLoaderGetStats - Copy of the loader counters
+* 10/19/2026
+*****************************************************************************************/
+void AwgLoaderGetStats(AWG_LOAD_STATS *stats){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *stats = awgStats;
+    CPU_CRITICAL_EXIT();
+}
+/*****************************************************************************************
+* awgLoadTask - Drains the receive ring into the frame state machine. A frame left part
+* way for AWG_FRAME_TOUT is dropped with AWG_REPLY_ERR.
+* 10/19/2026
+*****************************************************************************************/
+static void awgLoadTask(void *p_arg){
+    OS_ERR os_err;
+    INT8U byte;
+    (void)p_arg;
+
+    while(1){
+        (void)OSTaskSemPend(AWG_FRAME_TOUT, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+        if((os_err == OS_ERR_TIMEOUT) && (awgFrame.state != AWG_SYNC_A)){
+            awgFrame.state = AWG_SYNC_A;
+            awgStats.timeouts++;
+            awgReply(AWG_REPLY_ERR);
+        }else{
+        }
+        while(awgRxOut != awgRxIn){
+            byte = awgRx[awgRxOut & AWG_RX_MASK];
+            awgRxOut++;
+            awgRxByte(&awgFrame, byte);
+        }
+    }
+}
+/*****************************************************************************************
+* awgRxByte - One byte of the frame, see AwgLoader.h
+* 10/19/2026
+*****************************************************************************************/
+static void awgRxByte(AWG_FRAME *frame, INT8U byte){
+    switch(frame->state){
+    case AWG_SYNC_A:
+        if(byte == AWG_SYNC_0){
+            frame->state = AWG_SYNC_W;
+        }else{
+        }
+        break;
+    case AWG_SYNC_W:
+        if(byte == AWG_SYNC_1){
+            frame->state = AWG_LEN_LO;
+        }else if(byte == AWG_SYNC_0){
+        }else{
+            frame->state = AWG_SYNC_A;
+        }
+        break;
+    case AWG_LEN_LO:
+        frame->word = byte;
+        frame->state = AWG_LEN_HI;
+        break;
+    case AWG_LEN_HI:
+        frame->length = frame->word | ((INT16U)byte << 8);
+        if((frame->length == 0) || (frame->length > AWG_MAX_SAMPLES)){
+            frame->state = AWG_SYNC_A;
+            awgStats.errors++;
+            awgReply(AWG_REPLY_ERR);
+        }else{
+            frame->count = 0;
+            frame->sum = 0;
+            frame->chunk_n = 0;
+            frame->loading = AwgLoadBegin(frame->length);
+            frame->state = AWG_DATA_LO;
+        }
+        break;
+    case AWG_DATA_LO:
+        frame->word = byte;
+        frame->state = AWG_DATA_HI;
+        break;
+    case AWG_DATA_HI:
+        frame->word |= (INT16U)byte << 8;
+        frame->sum += frame->word;
+        frame->chunk[frame->chunk_n] = frame->word;
+        frame->chunk_n++;
+        frame->count++;
+        if((frame->chunk_n == AWG_CHUNK) || (frame->count == frame->length)){
+            awgChunkFlush(frame);
+        }else{
+        }
+        frame->state = (frame->count == frame->length) ? AWG_SUM_LO : AWG_DATA_LO;
+        break;
+    case AWG_SUM_LO:
+        frame->word = byte;
+        frame->state = AWG_SUM_HI;
+        break;
+    case AWG_SUM_HI:
+        frame->word |= (INT16U)byte << 8;
+        if(!frame->loading){
+            awgStats.busy++;
+            awgReply(AWG_REPLY_BUSY);
+        }else if((frame->word == frame->sum) && AwgLoadCommit()){
+            awgStats.loads++;
+            awgReply(AWG_REPLY_OK);
+        }else{                                      /* Staging table left uncommitted */
+            awgStats.errors++;
+            awgReply(AWG_REPLY_ERR);
+        }
+        frame->state = AWG_SYNC_A;
+        break;
+    default:
+        frame->state = AWG_SYNC_A;
+        break;
+    }
+}
+/*****************************************************************************************
+* awgChunkFlush - Hands the samples collected to the staging table, or drops them if
+* the load was refused
+* 10/19/2026
+*****************************************************************************************/
+static void awgChunkFlush(AWG_FRAME *frame){
+    if(frame->loading){
+        (void)AwgLoadChunk(frame->chunk, frame->chunk_n);
+    }else{
+    }
+    frame->chunk_n = 0;
+}
+/*****************************************************************************************
+* awgReply - Sends the one byte reply, the transmitter is idle between frames
+* 10/19/2026
+*****************************************************************************************/
+static void awgReply(INT8U reply){
+    while((UART2->S1 & UART_S1_TDRE_MASK) == 0){}
+    UART2->D = reply;
+}
+/*****************************************************************************************
+* UART2 Receive Interrupt Handler
+* Reading S1 then D clears RDRF, IDLE and OR. A byte that finds the ring full is
+* counted as an overrun, the frame it belongs to then fails its checksum.
+* 10/19/2026
+*****************************************************************************************/
+void UART2_RX_TX_IRQHandler(void){
+    OS_ERR os_err;
+    INT8U s1;
+    INT8U byte;
+    INT16U waiting;
+    OSIntEnter();
+    s1 = UART2->S1;
+    byte = UART2->D;
+    waiting = (INT16U)(awgRxIn - awgRxOut);
+    if((s1 & UART_S1_RDRF_MASK) != 0){
+        if(waiting < AWG_RX_SIZE){
+            awgRx[awgRxIn & AWG_RX_MASK] = byte;
+            awgRxIn++;
+            waiting++;
+        }else{
+            awgStats.overruns++;
+        }
+    }else{
+    }
+    if((s1 & UART_S1_OR_MASK) != 0){
+        awgStats.overruns++;
+    }else{
+    }
+    if(((s1 & UART_S1_IDLE_MASK) != 0) || (waiting == AWG_RX_POST)){
+        (void)OSTaskSemPost(&awgLoadTaskTCB, OS_OPT_POST_NONE, &os_err);
+    }else{
+    }
+    OSIntExit();
+}
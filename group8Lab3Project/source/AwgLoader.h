@@ -0,0 +1,45 @@
+/*****************************************************************************************
+* AwgLoader Module
+* Loads arbitrary waveform tables streamed over UART2, the TWR-K65 debug port on
+* PTE16/PTE17, at AWG_BAUD 8N1. Each frame is
+*   'A' 'W' length samples checksum
+* with length 1 - AWG_MAX_SAMPLES, then length 12-bit DAC codes, then the 16-bit sum of
+* the codes sent, each 16-bit value low byte first. The samples are fed to
+* AwgLoadBegin()/AwgLoadChunk()/AwgLoadCommit() as they arrive, the table playing is not
+* touched until the frame is complete and checked. One byte is sent back at the end:
+*   AWG_REPLY_OK    committed, it replaces the table at its next period boundary
+*   AWG_REPLY_BUSY  the previous table was not swapped in yet, send the frame again
+*   AWG_REPLY_ERR   bad length or checksum, or the frame stopped for AWG_FRAME_TOUT
+* Bytes before an 'A' 'W' are skipped, so a frame can follow any noise on the line.
+* 10/19/2026
+*****************************************************************************************/
+#ifndef AWG_LOADER_H_
+#define AWG_LOADER_H_
+
+#define AWG_BAUD        115200
+#define AWG_REPLY_OK    'K'
+#define AWG_REPLY_BUSY  'B'
+#define AWG_REPLY_ERR   'E'
+/*****************************************************************************************
+* AwgLoaderInit - Sets up UART2 and creates the loader task
+* 10/19/2026
+*****************************************************************************************/
+void AwgLoaderInit(void);
+/*****************************************************************************************
+* Loader counters, see AwgLoaderGetStats()
+* overruns are bytes lost to a full receive ring or the UART overrun flag.
+*****************************************************************************************/
+typedef struct{
+    INT32U loads;               /* Tables committed                 */
+    INT32U busy;                /* Frames refused, swap pending     */
+    INT32U errors;              /* Bad length or checksum           */
+    INT32U timeouts;            /* Frames stopped part way          */
+    INT32U overruns;
+}AWG_LOAD_STATS;
+/*****************************************************************************************
+* AwgLoaderGetStats - Copy of the loader counters
+* 10/19/2026
+*****************************************************************************************/
+void AwgLoaderGetStats(AWG_LOAD_STATS *stats);
+
+#endif
@@ -4,6 +4,21 @@
  * DMA configured to use hardware triggers from PIT timer.
  *
  * 02/25/2022 Nick Coyle
+ * 10/19/2026 Block handoff through the consumer task queue. The ISR fills a slot in
+ *            dmaBlockRing and posts its address, so no released block is lost.
+ * 10/19/2026 Loop mode, the channel plays a sample table directly and forever through
+ *            scatter/gather TCDs. Tables are swapped at the end of a period.
+ * 10/19/2026 Sample-accurate marker on DB6, timed by PIT1 from the start of a block
+ * 10/19/2026 Bursts. A burst TCD is linked from the loop by the trigger interrupt with
+ *            the sample clock restarted, and links back to the loop when done.
+ * 10/19/2026 Dual output. Interleaved frames, the minor loop writes DAC0 then DAC1 and
+ *            the minor loop offset takes the destination back to DAC0.
+ * 10/19/2026 Sample rate set at run time, changed by the ISR as a block starts
+ * 10/19/2026 Buffered DAC0. PDB0 advances the DAC buffer, the DAC watermark and top flags
+ *            request the DMA to refill the half just played.
+ * 10/19/2026 A ring slot is used up only by a block that is posted. Blocks dropped on a
+ *            full queue no longer overwrite the slots still queued.
+ * 10/19/2026 DMAPlayLoop() changes the mode and the TCD link in a critical section
  *
  * Includes functions by Todd Morton in DMA notes
  *****************************************************************************************/
@@ -16,34 +31,122 @@
 
 #define DMA_CH            0
 #define SIZE_CODE_16BIT   001
+#define DMA_RING_SIZE     (2*DMA_BLOCK_Q_SIZE)  /* Slots are not reused while queued or being read */
+#define DMA_BLOCK_CSR     (DMA_CSR_BWC(3)|DMA_CSR_INTHALF(1)|DMA_CSR_INTMAJOR(1))
+#define DMA_LOOP_CSR      (DMA_CSR_BWC(3)|DMA_CSR_ESG(1))
+#define BUS_FREQ          60000000      /* PIT clock */
+#define PIT_TICKS_PER_MS  (BUS_FREQ/1000)
+#define FS_LDVAL(fs)      ((BUS_FREQ / (fs)) - 1)   /* PIT0 LDVAL, PDB0 MOD and DAC interval */
+#define DMA_SRC_DAC0      45
+#define DMA_SRC_ALWAYS    60            /* Triggered by PIT0 */
+#define DAC_BUF_HALF      (DAC_BUF_WORDS/2)
+#define DAC_BUF_DMOD      5             /* Destination wraps in the 32 byte DAC buffer */
+#define DAC_BUF_WM        3             /* Watermark flag with 4 words left, pointer at 11 */
+#define PDB_TRIG_SW       15
+#if (APP_CFG_DAC_BUFFER_EN == DEF_ENABLED)
+#define DMA_DAC_BUFFERED  TRUE
+#define DMA_OUT_DELAY     DAC_BUF_WORDS /* Samples from a block start to its first output */
+#else
+#define DMA_DAC_BUFFERED  FALSE
+#define DMA_OUT_DELAY     0
+#endif
+#define DMA_TRIG_SW_MASK  (GPIO_PIN(SW2_BIT)|GPIO_PIN(SW3_BIT))
+#define DAC_STRIDE        (DAC1_BASE - DAC0_BASE)   /* DAC0 to DAC1 data register */
+#define DAC_MIDPOINT      2047
+#define DMA_DUAL_BASE     (NUM_BLOCKS*SAMPLES_PER_BLOCK)    /* Frames after the single blocks */
 
+/*******************************************************************************************
+* Memory image of a TCD for scatter/gather, same layout as DMA0->TCD[n], 32-byte aligned
+*******************************************************************************************/
+typedef struct{
+    INT32U saddr;
+    INT16S soff;
+    INT16U attr;
+    INT32U nbytes;
+    INT32S slast;
+    INT32U daddr;
+    INT16S doff;
+    INT16U citer;
+    INT32S dlast_sga;
+    INT16U csr;
+    INT16U biter;
+}DMA_TCD;
+
+/*******************************************************************************************
+* Channel modes. Changes to and from loop happen at the end of a major loop:
+*   DMA_BLOCKS      ping-pong blocks filled by the consumer
+*   DMA_TO_LOOP_REQ loop requested, the ISR links the loop TCD at the next half block
+*   DMA_TO_LOOP     linked, the ping-pong buffer finishes then the loop TCD loads
+*   DMA_LOOP        playing a table from dmaLoopTcd[], no interrupts
+*   DMA_TO_BLOCKS   block TCD linked, the first half block interrupt ends it
+*******************************************************************************************/
+typedef enum {DMA_BLOCKS, DMA_TO_LOOP_REQ, DMA_TO_LOOP, DMA_LOOP, DMA_TO_BLOCKS} DMA_MODE_T;
+
+/*******************************************************************************************
+* Marker edge for a block, see DMASetMarker()
+*******************************************************************************************/
 typedef struct{
-    INT8U index;
-    OS_SEM flag;
-}DMA_BLOCK_RDY;
+    INT16U offset;
+    INT8U level;
+    INT8U armed;
+}DMA_MARKER;
 
 /*******************************************************************************************
 * Public Functions
 *******************************************************************************************/
 void DMA0_DMA16_IRQHandler(void);
+void PIT1_IRQHandler(void);
+void PIT2_IRQHandler(void);
+void PORTA_IRQHandler(void);
 
 /*******************************************************************************************
 * Private Functions
 *******************************************************************************************/
 static void DAC0Init(void);  /* Initialize the Digital to Analog Converter */
+static void DAC1Init(void);
 static void PitInit(void);	 /* Initialize the Periodic Interrupt Timer */
+static void PdbInit(void);
+static void dmaSetClock(INT32U fs);
 
 /*******************************************************************************************
 * Private Resources
 *******************************************************************************************/
-static DMA_BLOCK_RDY dmaBlockRdy;
+static DMA_BLOCK_INFO dmaBlockRing[DMA_RING_SIZE];
+static INT32U dmaBlockSeq;
+static INT32U dmaRingIn;                    /* Slots posted, a dropped block takes none */
+static OS_TCB *dmaConsumer = (OS_TCB *)0;
+static DMA_STATS dmaStats;
+static INT32U dmaLastSeq;
+static DMA_TCD dmaBlockTcd __attribute__((aligned(32)));
+static DMA_TCD dmaLoopTcd[2] __attribute__((aligned(32)));
+static INT8U dmaLoopNext;                   /* dmaLoopTcd[] to fill next */
+static volatile DMA_MODE_T dmaMode;
+static DMA_MARKER dmaMarker[NUM_BLOCKS];
+static INT8U dmaMarkerLevel;                /* DB6 level PIT1 sets */
+static INT32U dmaFs;                        /* Rate the sample clock runs at */
+static INT32U dmaFsNext;                    /* Rate for block dmaFsIndex, 0 if none */
+static INT8U dmaFsIndex;
+static DMA_TCD dmaBurstTcd __attribute__((aligned(32)));
+static DMA_TCD *dmaBurstRest;               /* Loop TCD the burst returns to */
+static volatile INT8U dmaBurstArmed;
+static INT8U dmaBurstGated;
+static INT8U dmaTrigSources;
+static INT8U dmaDual;                       /* Format of the blocks released now */
+static INT8U dmaDualReq;                    /* Change linked at the next half block */
+static INT8U dmaDualLinked;                 /* Major loop ends in a TCD load, no DONE */
+
+static void dmaTcdInit(DMA_TCD *tcd, const INT16U *src, INT16U length, INT16U csr);
+static DMA_TCD *dmaLoopRunning(void);
+static void dmaBlockTcdInit(INT8U dual);
 
 /*******************************************************************************************
 * Ping Pong Buffer (Private)
 * This is the Ping Pong Buffer, full double-buffering (ping-pong).
-* Should only be accessible externally via DMAFillBuffer()
+* Should only be accessible externally via DMAFillBuffer() and DMAFillFrames()
+* Single blocks first, then the dual blocks of SAMPLES_PER_BLOCK frames of one sample per
+* DAC. Separate, so a block filled for the new format never lands on one still playing.
 *******************************************************************************************/
-static INT16U dmaBuffer[NUM_BLOCKS][SAMPLES_PER_BLOCK];
+static INT16U dmaBuffer[NUM_BLOCKS*(1+DMA_MAX_CHANNELS)*SAMPLES_PER_BLOCK] __attribute__((aligned(4)));
 
 /*******************************************************************************************
 * DMAFillBuffer
@@ -51,34 +154,55 @@ static INT16U dmaBuffer[NUM_BLOCKS][SAMPLES_PER_BLOCK];
 * 02/25/2022 Nick Coyle
 *******************************************************************************************/
 void DMAFillBuffer(INT8U index, INT16U *samples) {
+	INT16U *block = &dmaBuffer[index*SAMPLES_PER_BLOCK];
 	for(int i=0; i<SAMPLES_PER_BLOCK;i++) {
-		dmaBuffer[index][i] = *samples;
+		block[i] = *samples;
 		samples++;
 	}
 }
 
+/*******************************************************************************************
+* DMAFillFrames
+* Interleaves a DAC0 and a DAC1 block into frames, one word per frame
+* 10/19/2026
+*******************************************************************************************/
+void DMAFillFrames(INT8U index, const INT16U *dac0, const INT16U *dac1){
+	INT32U *frame = (INT32U *)&dmaBuffer[DMA_DUAL_BASE + (index*DMA_MAX_CHANNELS*SAMPLES_PER_BLOCK)];
+	for(int i=0; i<SAMPLES_PER_BLOCK;i++) {
+		frame[i] = (INT32U)dac0[i] | ((INT32U)dac1[i] << 16);
+	}
+}
+
 /*******************************************************************************************
 * DMAInInit
 * Initializes DMA for an input stream from ADC0 to ping-pong buffers
 * 02/25/2022 Nick Coyle
 *******************************************************************************************/
 void DMAInit(void){
-    OS_ERR os_err;
-
-    OSSemCreate(&(dmaBlockRdy.flag), "Block Ready", 0, &os_err);
-
-    // dmaBlockRdy.index indicates the buffer currently not being used by the DMA in the Ping-Pong scheme.
-    // It uses the DONE bit in the CSR to determine where the DMA is at. If DONE is 1, the DMA just finished
-    // the [1] block and will start taking from the [0] block. So, when DONE is one, we want Sinegen to use
-    // the [1] block to avoid collisions with the DMA.
-    // Since the DMA starts with the [0] block, initialize the index to the [1] block.
 
-    dmaBlockRdy.index = 1;
+    // The block index posted by the ISR indicates the buffer currently not being used by the DMA in the
+    // Ping-Pong scheme. It uses the DONE bit in the CSR to determine where the DMA is at. If DONE is 1,
+    // the DMA just finished the [1] block and will start taking from the [0] block. So, when DONE is one,
+    // we want Sinegen to use the [1] block to avoid collisions with the DMA.
+
+    dmaBlockSeq = 0;
+    dmaRingIn = 0;
+    dmaLastSeq = 0;
+    dmaMode = DMA_BLOCKS;
+    dmaLoopNext = 0;
+    dmaDual = FALSE;
+    dmaDualReq = FALSE;
+    dmaDualLinked = FALSE;
+    //Memory copy of the ping-pong TCD below, loaded to return from loop mode
+    dmaBlockTcdInit(FALSE);
 
     //enable DMA clocks
     SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
     SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
 
+    //Minor loop offsets for dual mode. TCDs with no offset enabled are unchanged
+    DMA0->CR |= DMA_CR_EMLM_MASK;
+
     //Make sure DMAMUX is disabled
     DMAMUX->CHCFG[DMA_CH] |= DMAMUX_CHCFG_ENBL(0)|DMAMUX_CHCFG_TRIG(0);
 
@@ -119,8 +243,19 @@ void DMAInit(void){
     DMA0->TCD[DMA_CH].CSR = DMA_CSR_ESG(0) | DMA_CSR_MAJORELINK(0) | DMA_CSR_BWC(3) | DMA_CSR_INTHALF(1) |
     		DMA_CSR_INTMAJOR(1) | DMA_CSR_DREQ(0) | DMA_CSR_START(0);
 
+#if (APP_CFG_DAC_BUFFER_EN == DEF_ENABLED)
+    //Buffered, half the DAC buffer per request. The destination modulo wraps the writes
+    //in the buffer, alternating halves, and the half interrupt is still a block
+    DMA0->TCD[DMA_CH].ATTR = DMA_ATTR_SMOD(0) | DMA_ATTR_SSIZE(SIZE_CODE_16BIT) | DMA_ATTR_DMOD(DAC_BUF_DMOD) | DMA_ATTR_DSIZE(SIZE_CODE_16BIT);
+    DMA0->TCD[DMA_CH].DOFF = DMA_DOFF_DOFF(BYTES_PER_SAMPLE);
+    DMA0->TCD[DMA_CH].NBYTES_MLNO = DMA_NBYTES_MLNO_NBYTES(DAC_BUF_HALF*BYTES_PER_SAMPLE);
+    DMA0->TCD[DMA_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_ELINK(0) | DMA_CITER_ELINKNO_CITER(NUM_BLOCKS*SAMPLES_PER_BLOCK/DAC_BUF_HALF);
+    DMA0->TCD[DMA_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_ELINK(0) | DMA_BITER_ELINKNO_BITER(NUM_BLOCKS*SAMPLES_PER_BLOCK/DAC_BUF_HALF);
+    DMAMUX->CHCFG[DMA_CH] = DMAMUX_CHCFG_ENBL(1)|DMAMUX_CHCFG_SOURCE(DMA_SRC_DAC0);
+#else
     //Finally, we enable the DMAMUX, and enable the DMA for the ‘always enabled’ channel 60
-    DMAMUX->CHCFG[DMA_CH] = DMAMUX_CHCFG_ENBL(1)|DMAMUX_CHCFG_TRIG(1)|DMAMUX_CHCFG_SOURCE(60);
+    DMAMUX->CHCFG[DMA_CH] = DMAMUX_CHCFG_ENBL(1)|DMAMUX_CHCFG_TRIG(1)|DMAMUX_CHCFG_SOURCE(DMA_SRC_ALWAYS);
+#endif
 
 	//enable DMA interrupt
 	NVIC_EnableIRQ(DMA_CH);
@@ -129,7 +264,9 @@ void DMAInit(void){
     DMA0->SERQ = DMA_SERQ_SERQ(DMA_CH);
 
     DAC0Init();
+    DAC1Init();
     PitInit();
+    PdbInit();
 }
 
 /*******************************************************************************************
@@ -138,53 +275,651 @@ void DMAInit(void){
  ******************************************************************************************/
 static void DAC0Init(void){
     SIM->SCGC2 |= SIM_SCGC2_DAC0(1);  /* enable DAC clock */
+#if (APP_CFG_DAC_BUFFER_EN == DEF_ENABLED)
+    for(INT8U k = 0; k < DAC_BUF_WORDS; k++){
+        DAC0->DAT[k].DATL = (INT8U)DAC_MIDPOINT;
+        DAC0->DAT[k].DATH = (INT8U)(DAC_MIDPOINT >> 8);
+    }
+    DAC0->C2 = DAC_C2_DACBFUP(DAC_BUF_WORDS - 1);               /* Read pointer at 0 */
+    DAC0->C1 = DAC_C1_DACBFEN(1)|DAC_C1_DACBFWM(DAC_BUF_WM)|DAC_C1_DMAEN(1);
+    DAC0->SR = 0;                     /* Top flag is set out of reset, first request is the watermark */
+    DAC0->C0 |= DAC_C0_DACBWIEN(1)|DAC_C0_DACBTIEN(1);          /* Hardware trigger, PDB0 */
+#endif
     DAC0->C0 |= DAC_C0_DACEN(1);      /* set bit 7 to enable DAC */
     DAC0->C0 |= DAC_C0_DACRFS(1);     /* set bit 6 for DACREF_1 so VDDA 3.3V ref */
 }
 
+/*******************************************************************************************
+ * DAC1Init - Second output for dual mode, same reference as DAC0, starts at midpoint
+ * 10/19/2026
+ ******************************************************************************************/
+static void DAC1Init(void){
+    SIM->SCGC2 |= SIM_SCGC2_DAC1(1);
+    DAC1->C0 |= DAC_C0_DACEN(1)|DAC_C0_DACRFS(1);
+    DAC1->DAT[0].DATL = (INT8U)DAC_MIDPOINT;
+    DAC1->DAT[0].DATH = (INT8U)(DAC_MIDPOINT >> 8);
+}
+
 /*******************************************************************************************
  * PitInit - Initialize the PIT
  * Todd Morton 11/09/2020
  * Nick Coyle 11/13/2021 revised the comments
  * Nick Coyle 02/19/2022 changed period for 48kHz sample rate
+ * 10/19/2026 PIT1 set up for marker edges
  ******************************************************************************************/
 static void PitInit(void){
 	//the PIT needs to be configured to generate triggers at the desired sample rate and the DAC
 	SIM->SCGC6 |= SIM_SCGC6_PIT(1);    /* turn on PIT clock */
     PIT->MCR = PIT_MCR_MDIS(0);        /* enable PIT clock */
-    PIT->CHANNEL[0].LDVAL = 1249;      /* set Tep to 20.083us for fs=48kHz (Buss clock = 60MHz) */
-    PIT->CHANNEL[0].TCTRL = (PIT_TCTRL_TEN(1)); /* start Timer 0 */
+    dmaFs = DMA_FS_DEFAULT;
+    dmaFsNext = 0;
+    PIT->CHANNEL[0].LDVAL = FS_LDVAL(DMA_FS_DEFAULT); /* Tep 20.83us for 48kHz, see DMASetSampleRate() */
+    if(!DMA_DAC_BUFFERED){
+        PIT->CHANNEL[0].TCTRL = (PIT_TCTRL_TEN(1)); /* start Timer 0 */
+    }else{
+    }
+    PIT->CHANNEL[1].TCTRL = 0;         /* Timer 1 times marker edges, one-shot */
+    NVIC_EnableIRQ(PIT1_IRQn);
+}
+
+/*******************************************************************************************
+ * PdbInit - Sample clock of the buffered DAC. The counter restarts every sample and the
+ * DAC interval trigger fires once per count. New periods load at the end of a count.
+ * 10/19/2026
+ ******************************************************************************************/
+static void PdbInit(void){
+#if (APP_CFG_DAC_BUFFER_EN == DEF_ENABLED)
+    SIM->SCGC6 |= SIM_SCGC6_PDB(1);
+    PDB0->MOD = FS_LDVAL(DMA_FS_DEFAULT);
+    PDB0->DAC[0].INT = FS_LDVAL(DMA_FS_DEFAULT);
+    PDB0->DAC[0].INTC = PDB_INTC_TOE(1);
+    PDB0->SC = PDB_SC_PDBEN(1)|PDB_SC_CONT(1)|PDB_SC_TRGSEL(PDB_TRIG_SW)|PDB_SC_LDMOD(1);
+    PDB0->SC |= PDB_SC_LDOK_MASK;
+    PDB0->SC |= PDB_SC_SWTRIG_MASK;
+#endif
+}
+
+/*******************************************************************************************
+ * dmaSetClock - Writes the sample period, PIT0 or PDB0 for the buffered DAC. Either loads
+ * it at the end of the sample period running.
+ * 10/19/2026
+ ******************************************************************************************/
+static void dmaSetClock(INT32U fs){
+#if (APP_CFG_DAC_BUFFER_EN == DEF_ENABLED)
+    PDB0->MOD = FS_LDVAL(fs);
+    PDB0->DAC[0].INT = FS_LDVAL(fs);
+    PDB0->SC |= PDB_SC_LDOK_MASK;
+#else
+    PIT->CHANNEL[0].LDVAL = FS_LDVAL(fs);
+#endif
+    dmaFs = fs;
 }
 
 /*******************************************************************************************
  * DMA Interrupt Handler for the sample stream
+ * Fills the next ring slot with the released block and posts it to the consumer.
+ * The slot is kept only if the post succeeds, so with DMA_BLOCK_Q_SIZE queued and one
+ * being read no slot in use is written.
  * 08/30/2015 TDM
+ * 10/19/2026 Posts a DMA_BLOCK_INFO through the consumer task queue
  ******************************************************************************************/
 void DMA0_DMA16_IRQHandler(void){
     OS_ERR os_err;
+    DMA_BLOCK_INFO *slot;
+    INT32U delay;
     OSIntEnter();
     DB5_TURN_ON();
     DMA0->CINT = DMA_CINT_CINT(DMA_CH);
 
-    if((DMA0->TCD[DMA_CH].CSR & DMA_CSR_DONE_MASK) != 0){
-        dmaBlockRdy.index = 1;      //set buffer index to opposite of DMA
+    if(dmaMode == DMA_TO_LOOP){                 //Major loop done, loop TCD loaded
+        dmaMode = DMA_LOOP;
+        DB5_TURN_OFF();
+        OSIntExit();
+        return;
+    }else if(dmaMode == DMA_TO_BLOCKS){         //First half block from the block TCD
+        dmaMode = DMA_BLOCKS;
+    }else if(dmaDualReq && ((DMA0->TCD[DMA_CH].CSR & DMA_CSR_DONE_MASK) == 0)){
+        //Half way, link the block TCD in the new format. Blocks released from here on
+        //play after the major loop, in that format
+        DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)&dmaBlockTcd;
+        DMA0->TCD[DMA_CH].CSR |= DMA_CSR_ESG_MASK;
+        dmaDual = !dmaDual;
+        dmaDualReq = FALSE;
+        dmaDualLinked = TRUE;
+    }else if((dmaMode == DMA_TO_LOOP_REQ) && ((DMA0->TCD[DMA_CH].CSR & DMA_CSR_DONE_MASK) == 0)){
+        //Half way, link the loop TCD. Safe to set ESG, the major loop is a half block away
+        DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)&dmaLoopTcd[dmaLoopNext ^ 1];
+        DMA0->TCD[DMA_CH].CSR |= DMA_CSR_ESG_MASK;
+        dmaMode = DMA_TO_LOOP;
+        DB5_TURN_OFF();
+        OSIntExit();
+        return;
     }else{
-        dmaBlockRdy.index = 0;
     }
 
-    (void)OSSemPost(&(dmaBlockRdy.flag),OS_OPT_POST_1,&os_err);
+    dmaBlockSeq++;
+    slot = &dmaBlockRing[dmaRingIn % DMA_RING_SIZE];
+    if(dmaDualLinked){              //Major loop ended in the TCD load, DONE not set
+        dmaDualLinked = FALSE;
+        slot->index = 1;
+    }else if((DMA0->TCD[DMA_CH].CSR & DMA_CSR_DONE_MASK) != 0){
+        slot->index = 1;            //set buffer index to opposite of DMA
+    }else{
+        slot->index = 0;
+    }
+    if((dmaFsNext != 0) && (dmaFsIndex == (slot->index ^ 1))){
+        //Block at the new rate starts now, LDVAL loads at the end of this sample period
+        dmaSetClock(dmaFsNext);
+        dmaFsNext = 0;
+    }else{
+    }
+    if(dmaMarker[slot->index ^ 1].armed){   //Block with a marker starts playing now
+        dmaMarker[slot->index ^ 1].armed = FALSE;
+        dmaMarkerLevel = dmaMarker[slot->index ^ 1].level;
+        delay = (INT32U)dmaMarker[slot->index ^ 1].offset + DMA_OUT_DELAY;
+        if(delay == 0){
+            if(dmaMarkerLevel){
+                DB6_TURN_ON();
+            }else{
+                DB6_TURN_OFF();
+            }
+        }else{                              //PIT1 one-shot, offset sample periods
+            PIT->CHANNEL[1].TCTRL = 0;
+            PIT->CHANNEL[1].LDVAL = (delay * (FS_LDVAL(dmaFs) + 1)) - 1;
+            PIT->CHANNEL[1].TFLG = PIT_TFLG_TIF_MASK;
+            PIT->CHANNEL[1].TCTRL = PIT_TCTRL_TIE(1)|PIT_TCTRL_TEN(1);
+        }
+    }else{
+    }
+    slot->seq = dmaBlockSeq;
+    slot->tick = OSTimeGet(&os_err);
+    slot->dual = dmaDual;
+    dmaStats.released++;
+
+    if(dmaConsumer != (OS_TCB *)0){
+        OSTaskQPost(dmaConsumer, (void *)slot, sizeof(DMA_BLOCK_INFO), OS_OPT_POST_FIFO, &os_err);
+        if(os_err != OS_ERR_NONE){
+            dmaStats.dropped++;
+        }else{
+            dmaRingIn++;
+        }
+    }else{
+    }
     DB5_TURN_OFF();
     OSIntExit();
 }
 
+/*******************************************************************************************
+ * PIT1 Interrupt Handler, marker edge
+ * One-shot, stops itself and sets DB6 to the level armed by the DMA ISR.
+ * 10/19/2026
+ ******************************************************************************************/
+void PIT1_IRQHandler(void){
+    OSIntEnter();
+    PIT->CHANNEL[1].TCTRL = 0;
+    PIT->CHANNEL[1].TFLG = PIT_TFLG_TIF_MASK;
+    if(dmaMarkerLevel){
+        DB6_TURN_ON();
+    }else{
+        DB6_TURN_OFF();
+    }
+    OSIntExit();
+}
+
+/****************************************************************************************
+ * DMASetMarker
+ * Sets DB6 to level offset samples into block index, when it plays. Called after
+ * filling the block, before the DMA starts it. The edge is timed by PIT1 from the DMA
+ * interrupt at the start of the block, so it lines up with the DAC output to within
+ * the interrupt latency.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMASetMarker(INT8U index, INT16U offset, INT8U level){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    dmaMarker[index].offset = offset;
+    dmaMarker[index].level = level;
+    dmaMarker[index].armed = TRUE;
+    CPU_CRITICAL_EXIT();
+}
+
+/****************************************************************************************
+ * DMABurstArm
+ * Sets up the burst TCD to return to the loop playing now. FALSE, not armed, unless a
+ * loop is playing with no change pending.
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMABurstArm(const INT16U *buf, INT16U length, INT8U gated){
+    INT8U armed = FALSE;
+    DMA_TCD *rest;
+    DMABurstDisarm();
+    rest = dmaLoopRunning();
+    if((dmaMode == DMA_LOOP) && !DMALoopPending() && (rest != (DMA_TCD *)0) &&
+       (length != 0) && (length <= DMA_BURST_MAX) && !DMABurstBusy()){
+        dmaTcdInit(&dmaBurstTcd, buf, length, DMA_LOOP_CSR);
+        if(gated){
+            dmaBurstTcd.dlast_sga = (INT32S)&dmaBurstTcd;  //Repeats until the gate closes
+        }else{
+            dmaBurstTcd.dlast_sga = (INT32S)rest;
+        }
+        dmaBurstRest = rest;
+        dmaBurstGated = gated;
+        dmaBurstArmed = TRUE;
+        armed = TRUE;
+    }else{
+    }
+    return armed;
+}
+
+/****************************************************************************************
+ * DMABurstDisarm
+ * Triggers are ignored until the next DMABurstArm(). A burst playing finishes.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMABurstDisarm(void){
+    dmaBurstArmed = FALSE;
+}
+
+/****************************************************************************************
+ * DMABurstBusy
+ * TRUE while the channel is playing the burst buffer
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMABurstBusy(void){
+    INT32U saddr = DMA0->TCD[DMA_CH].SADDR;
+    return (dmaBurstTcd.biter != 0) && (saddr >= dmaBurstTcd.saddr) &&
+           (saddr <= (dmaBurstTcd.saddr + (dmaBurstTcd.biter * BYTES_PER_SAMPLE)));
+}
+
+/****************************************************************************************
+ * DMABurstFire
+ * With PIT0 stopped no trigger can load a TCD, so the link is made to the loop TCD
+ * sitting in the channel. The first trigger after the restart plays the rest sample
+ * and loads the burst, the second plays the first burst sample.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMABurstFire(void){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    if(dmaBurstArmed && (dmaMode == DMA_LOOP) &&
+       (DMA0->TCD[DMA_CH].DLAST_SGA == (INT32U)dmaBurstRest) && !DMABurstBusy()){
+        PIT->CHANNEL[0].TCTRL = 0;
+        DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)&dmaBurstTcd;
+        DB7_TURN_ON();
+        PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TEN(1);   //Counts down from LDVAL again
+        DB7_TURN_OFF();
+    }else{
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+/****************************************************************************************
+ * DMABurstGateClose
+ * Links a gated burst back to the loop, the pass playing now finishes.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMABurstGateClose(void){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    if(DMABurstBusy()){
+        DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)dmaBurstRest;
+    }else{
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+/****************************************************************************************
+ * DMABurstSetTrigger
+ * Enables the hardware triggers in sources, DMA_TRIG_* ORed, 0 for none.
+ * Switches interrupt on the press, or either edge for a gated burst. The timer fires
+ * every period_ms.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMABurstSetTrigger(INT8U sources, INT16U period_ms){
+    INT8U irqc = dmaBurstGated ? PORT_IRQ_EE : PORT_IRQ_FE;
+    dmaTrigSources = sources;
+    GpioSw2Init(((sources & DMA_TRIG_SW2) != 0) ? irqc : PORT_IRQ_OFF);
+    GpioSw3Init(((sources & DMA_TRIG_SW3) != 0) ? irqc : PORT_IRQ_OFF);
+    PORTA->ISFR = DMA_TRIG_SW_MASK;
+    if((sources & (DMA_TRIG_SW2|DMA_TRIG_SW3)) != 0){
+        NVIC_EnableIRQ(PORTA_IRQn);
+    }else{
+        NVIC_DisableIRQ(PORTA_IRQn);
+    }
+    PIT->CHANNEL[2].TCTRL = 0;
+    if(((sources & DMA_TRIG_TIMER) != 0) && (period_ms != 0)){
+        PIT->CHANNEL[2].LDVAL = ((INT32U)period_ms * PIT_TICKS_PER_MS) - 1;
+        PIT->CHANNEL[2].TFLG = PIT_TFLG_TIF_MASK;
+        PIT->CHANNEL[2].TCTRL = PIT_TCTRL_TIE(1)|PIT_TCTRL_TEN(1);
+        NVIC_EnableIRQ(PIT2_IRQn);
+    }else{
+        NVIC_DisableIRQ(PIT2_IRQn);
+    }
+}
+
+/*******************************************************************************************
+ * Port A Interrupt Handler, SW2 and SW3 burst triggers
+ * A press fires the burst. Gated, the gate is open while the switch is held.
+ * 10/19/2026
+ ******************************************************************************************/
+void PORTA_IRQHandler(void){
+    INT32U isf;
+    OSIntEnter();
+    isf = PORTA->ISFR & DMA_TRIG_SW_MASK;
+    PORTA->ISFR = isf;
+    if(!dmaBurstGated){
+        DMABurstFire();
+    }else if((((isf & GPIO_PIN(SW2_BIT)) != 0) && (SW2_INPUT == 0)) ||
+             (((isf & GPIO_PIN(SW3_BIT)) != 0) && (SW3_INPUT == 0))){
+        DMABurstFire();
+    }else{
+        DMABurstGateClose();
+    }
+    OSIntExit();
+}
+
+/*******************************************************************************************
+ * PIT2 Interrupt Handler, periodic burst trigger
+ * 10/19/2026
+ ******************************************************************************************/
+void PIT2_IRQHandler(void){
+    OSIntEnter();
+    PIT->CHANNEL[2].TFLG = PIT_TFLG_TIF_MASK;
+    DMABurstFire();
+    OSIntExit();
+}
+
+/****************************************************************************************
+ * DMASetConsumer
+ * Registers the task whose queue receives the released blocks.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMASetConsumer(OS_TCB *tcb){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    dmaConsumer = tcb;
+    dmaLastSeq = dmaBlockSeq;
+    CPU_CRITICAL_EXIT();
+}
+
 /****************************************************************************************
  * DMA Flag
- * The DMA ISR is going to post this semaphore every time it gets halfway or all the way
- * to the end of the ping pong buffer. The sinegen buffer filling task will call this to
- * get the current index it should be writing to.
+ * The DMA ISR posts every block it releases, halfway or all the way through the ping
+ * pong buffer, to the consumer task queue. The sinegen buffer filling task calls this
+ * to get the next block it should be writing to, oldest first.
+ * A jump in the sequence number means blocks were dropped, the lag is how late the
+ * consumer picked the block up.
  * 08/30/2015 TDM
+ * 10/19/2026 Pends on the consumer task queue
+ ***************************************************************************************/
+INT8U DMAReadyPend(OS_TICK tout, DMA_BLOCK_INFO *info, OS_ERR *os_err_ptr){
+    DMA_BLOCK_INFO block;
+    OS_MSG_SIZE msg_size;
+    DMA_BLOCK_INFO *slot;
+    OS_ERR os_err;
+
+    slot = (DMA_BLOCK_INFO *)OSTaskQPend(tout, OS_OPT_PEND_BLOCKING, &msg_size, (CPU_TS *)0, os_err_ptr);
+    if(*os_err_ptr == OS_ERR_NONE){
+        block = *slot;
+        if(block.seq != (dmaLastSeq + 1)){
+            dmaStats.missed += block.seq - dmaLastSeq - 1;
+        }else{
+        }
+        dmaLastSeq = block.seq;
+        dmaStats.last_lag = OSTimeGet(&os_err) - block.tick;
+        if(dmaStats.last_lag > dmaStats.max_lag){
+            dmaStats.max_lag = dmaStats.last_lag;
+        }else{
+        }
+    }else{
+        block.index = 0;
+        block.seq = dmaLastSeq;
+        block.tick = 0;
+        block.dual = dmaDual;
+    }
+    if(info != (DMA_BLOCK_INFO *)0){
+        *info = block;
+    }else{
+    }
+    return block.index;
+}
+
+/****************************************************************************************
+ * DMASetSampleRate
+ * In block mode the ISR writes LDVAL when block index starts, see DMA.h
+ * 10/19/2026
+ ***************************************************************************************/
+void DMASetSampleRate(INT8U index, INT32U fs){
+    CPU_SR_ALLOC();
+    if(fs < DMA_FS_MIN){
+        fs = DMA_FS_MIN;
+    }else if(fs > DMA_FS_MAX){
+        fs = DMA_FS_MAX;
+    }else{
+    }
+    CPU_CRITICAL_ENTER();
+    if(dmaMode == DMA_BLOCKS){
+        dmaFsNext = fs;
+        dmaFsIndex = index;
+    }else{
+        dmaSetClock(fs);
+        dmaFsNext = 0;
+    }
+    CPU_CRITICAL_EXIT();
+}
+
+/****************************************************************************************
+ * DMAGetSampleRate
+ * 10/19/2026
+ ***************************************************************************************/
+INT32U DMAGetSampleRate(void){
+    return dmaFs;
+}
+
+/****************************************************************************************
+ * DMASetDual
+ * Requests dual or single output. The ISR links the block TCD in the new format at the
+ * next half block. FALSE, and nothing changes, unless in block mode with no change
+ * pending. TRUE with no change when already in that mode.
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMASetDual(INT8U on){
+    INT8U accepted = TRUE;
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    if((dmaMode != DMA_BLOCKS) || dmaDualReq || DMA_DAC_BUFFERED){
+        accepted = FALSE;
+    }else if((on != FALSE) != (dmaDual != FALSE)){
+        dmaBlockTcdInit(on);
+        dmaDualReq = TRUE;
+    }else{
+    }
+    CPU_CRITICAL_EXIT();
+    return accepted;
+}
+
+/****************************************************************************************
+ * DMADualActive
+ * TRUE while dual blocks are released, or a change to dual is pending
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMADualActive(void){
+    return (dmaDual != FALSE) != (dmaDualReq != FALSE);
+}
+
+/****************************************************************************************
+ * DMAPlayLoop
+ * Plays table directly from the DMA, one sample per trigger, repeating with no CPU.
+ * From block mode the switch is made at the end of the ping-pong buffer. In loop mode
+ * the new table starts at the end of the current period. Returns FALSE, and does
+ * nothing, while a previous change has not taken effect, see DMALoopPending().
+ * The table must not change until it is no longer playing.
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMAPlayLoop(const INT16U *table, INT16U length){
+    INT8U accepted = TRUE;
+    DMA_TCD *tcd;
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();                                   //The ISR and burst trigger read these
+    if(DMALoopPending() || (length == 0) || dmaDualReq || DMA_DAC_BUFFERED){
+        accepted = FALSE;
+    }else if(dmaMode == DMA_BLOCKS){
+        tcd = &dmaLoopTcd[dmaLoopNext];
+        dmaTcdInit(tcd, table, length, DMA_LOOP_CSR);
+        tcd->dlast_sga = (INT32S)tcd;                       //Loops on itself
+        dmaLoopNext ^= 1;
+        dmaMode = DMA_TO_LOOP_REQ;                          //ISR links it at the next half
+    }else{                                                  //DMA_LOOP, fill the idle TCD
+        tcd = &dmaLoopTcd[dmaLoopNext];
+        if(tcd == dmaLoopRunning()){
+            dmaLoopNext ^= 1;
+            tcd = &dmaLoopTcd[dmaLoopNext];
+        }else{
+        }
+        dmaTcdInit(tcd, table, length, DMA_LOOP_CSR);
+        tcd->dlast_sga = (INT32S)tcd;
+        dmaLoopNext ^= 1;
+        DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)tcd;         //ESG is set, loads at period end
+    }
+    CPU_CRITICAL_EXIT();
+    return accepted;
+}
+
+/****************************************************************************************
+ * DMAPlayBlocks
+ * Returns from loop mode to ping-pong blocks at the end of the current period. Both
+ * blocks must be filled first, the first block released is posted half a buffer later.
+ * Returns FALSE while a change to loop mode is being linked, try again later.
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMAPlayBlocks(void){
+    INT8U accepted = TRUE;
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    if(dmaMode == DMA_LOOP){
+        DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)&dmaBlockTcd;
+        dmaMode = DMA_TO_BLOCKS;
+    }else if(dmaMode == DMA_TO_LOOP_REQ){                   //Not linked yet, cancel
+        dmaMode = DMA_BLOCKS;
+    }else if(dmaMode == DMA_TO_LOOP){
+        accepted = FALSE;
+    }else{
+    }
+    CPU_CRITICAL_EXIT();
+    return accepted;
+}
+
+/****************************************************************************************
+ * DMALoopPlaying
+ * Table the channel is playing in loop mode, null in block mode or while changing.
+ * 10/19/2026
+ ***************************************************************************************/
+const INT16U *DMALoopPlaying(void){
+    DMA_TCD *tcd;
+    const INT16U *table = (const INT16U *)0;
+    if(dmaMode == DMA_LOOP){
+        tcd = dmaLoopRunning();
+        if(tcd != (DMA_TCD *)0){
+            table = (const INT16U *)tcd->saddr;
+        }else{
+        }
+    }else{
+    }
+    return table;
+}
+
+/****************************************************************************************
+ * DMALoopPending
+ * TRUE while a change to or from loop mode, or a loop table swap, has not taken effect
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMALoopPending(void){
+    INT8U pending;
+    if(dmaMode == DMA_LOOP){
+        pending = (DMA0->TCD[DMA_CH].DLAST_SGA != (INT32U)dmaLoopRunning());
+    }else if(dmaMode == DMA_BLOCKS){
+        pending = FALSE;
+    }else{
+        pending = TRUE;
+    }
+    return pending;
+}
+
+/****************************************************************************************
+ * dmaLoopRunning
+ * Loop TCD whose table holds the channel source address, null if neither
+ * If both hold the same table, the one the channel links to
+ * During a burst, the loop TCD it returns to
+ * 10/19/2026
+ ***************************************************************************************/
+static DMA_TCD *dmaLoopRunning(void){
+    DMA_TCD *running = (DMA_TCD *)0;
+    INT32U saddr = DMA0->TCD[DMA_CH].SADDR;
+    if(DMABurstBusy()){
+        running = dmaBurstRest;
+    }else{
+        for(INT8U i = 0; i < 2; i++){
+            if((saddr >= dmaLoopTcd[i].saddr) &&
+               (saddr <= (dmaLoopTcd[i].saddr + (dmaLoopTcd[i].biter * BYTES_PER_SAMPLE)))){
+                if((running == (DMA_TCD *)0) || (DMA0->TCD[DMA_CH].DLAST_SGA == (INT32U)&dmaLoopTcd[i])){
+                    running = &dmaLoopTcd[i];   //Same table in both, the linked one wins
+                }else{
+                }
+            }else{
+            }
+        }
+    }
+    return running;
+}
+
+/****************************************************************************************
+ * dmaBlockTcdInit
+ * Ping-pong block TCD, single or dual. Dual moves a 4 byte frame per trigger, DAC0 then
+ * DOFF to DAC1, and the minor loop offset returns to DAC0. At the end of the major loop
+ * the engine applies DLAST instead of the offset, so DLAST does the same.
+ * 10/19/2026
+ ***************************************************************************************/
+static void dmaBlockTcdInit(INT8U dual){
+    if(dual){
+        dmaTcdInit(&dmaBlockTcd, &dmaBuffer[DMA_DUAL_BASE], NUM_BLOCKS*SAMPLES_PER_BLOCK, DMA_BLOCK_CSR);
+        dmaBlockTcd.slast = -(INT32S)(DMA_MAX_CHANNELS*BYTES_PER_BUFFER);
+        dmaBlockTcd.nbytes = DMA_NBYTES_MLOFFYES_DMLOE(1) |
+                             DMA_NBYTES_MLOFFYES_MLOFF(-(INT32S)(DMA_MAX_CHANNELS*DAC_STRIDE)) |
+                             DMA_NBYTES_MLOFFYES_NBYTES(DMA_MAX_CHANNELS*BYTES_PER_SAMPLE);
+        dmaBlockTcd.doff = (INT16S)DAC_STRIDE;
+        dmaBlockTcd.dlast_sga = -(INT32S)(DMA_MAX_CHANNELS*DAC_STRIDE);
+    }else{
+        dmaTcdInit(&dmaBlockTcd, &dmaBuffer[0], NUM_BLOCKS*SAMPLES_PER_BLOCK, DMA_BLOCK_CSR);
+    }
+}
+
+/****************************************************************************************
+ * dmaTcdInit
+ * Memory TCD for DAC0 from src, one sample per trigger, length samples per major loop
+ * 10/19/2026
+ ***************************************************************************************/
+static void dmaTcdInit(DMA_TCD *tcd, const INT16U *src, INT16U length, INT16U csr){
+    tcd->saddr = (INT32U)src;
+    tcd->soff = BYTES_PER_SAMPLE;
+    tcd->attr = DMA_ATTR_SSIZE(SIZE_CODE_16BIT) | DMA_ATTR_DSIZE(SIZE_CODE_16BIT);
+    tcd->nbytes = BYTES_PER_SAMPLE;
+    tcd->slast = -(INT32S)(length * BYTES_PER_SAMPLE);
+    tcd->daddr = (INT32U)&DAC0->DAT[0].DATL;
+    tcd->doff = 0;
+    tcd->citer = length;
+    tcd->dlast_sga = 0;
+    tcd->csr = csr;
+    tcd->biter = length;
+}
+
+/****************************************************************************************
+ * DMAGetStats
+ * Copies the block handoff counters
+ * 10/19/2026
  ***************************************************************************************/
-INT8U DMAReadyPend(OS_TICK tout, OS_ERR *os_err_ptr){
-    (void)OSSemPend(&(dmaBlockRdy.flag), tout, OS_OPT_PEND_BLOCKING,(void *)0, os_err_ptr);
-    return dmaBlockRdy.index;
+void DMAGetStats(DMA_STATS *stats){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *stats = dmaStats;
+    CPU_CRITICAL_EXIT();
 }
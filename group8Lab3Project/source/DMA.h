@@ -3,6 +3,14 @@
  * DMA writes values from the ping pong buffer to the DAC.
  * DMA configured to use hardware triggers from PIT timer.
  * 02/25/2022 Nick Coyle
+ * 10/19/2026 Each completed block is posted to the consumer task queue with a
+ *            sequence number and tick, replacing the semaphore and shared index
+ * 10/19/2026 Loop mode plays a sample table with no CPU, see DMAPlayLoop()
+ * 10/19/2026 Marker output on DB6, see DMASetMarker()
+ * 10/19/2026 Bursts from a loop, started by SW2, SW3, PIT2 or software, see DMABurstArm()
+ * 10/19/2026 Dual output, DAC0 and DAC1 from interleaved blocks, see DMASetDual()
+ * 10/19/2026 Sample rate set at run time, see DMASetSampleRate()
+ * 10/19/2026 Buffered DAC0 option, APP_CFG_DAC_BUFFER_EN
  * Includes functions by Todd Morton in DMA notes
  *****************************************************************************************/
 #ifndef DMA_H_
@@ -13,6 +21,38 @@
 #define SAMPLES_PER_BLOCK           1024
 #define BYTES_PER_BLOCK             (SAMPLES_PER_BLOCK*BYTES_PER_SAMPLE)
 #define BYTES_PER_BUFFER            (NUM_BLOCKS*BYTES_PER_BLOCK)
+#define DMA_BLOCK_Q_SIZE            4   /* Consumer task queue size, see DMASetConsumer() */
+#define DMA_MAX_CHANNELS            2   /* DAC0 and DAC1 */
+#define DMA_FS_DEFAULT              48000
+#define DMA_FS_MIN                  8000
+#define DMA_FS_MAX                  200000  /* DAC settling and one DMA request per sample */
+/******************************************************************************************
+* With APP_CFG_DAC_BUFFER_EN, PDB0 steps the DAC0 data buffer read pointer at the sample
+* rate and each DMA request writes half the 16 word buffer, an eighth of the requests.
+* The output runs DAC_BUF_WORDS samples behind the blocks, markers allow for it.
+* Blocks only: DMAPlayLoop() and DMASetDual() return FALSE, so there are no native table
+* loops, bursts or DAC1 output.
+******************************************************************************************/
+#define DAC_BUF_WORDS               16
+/******************************************************************************************
+* Released block, see DMAReadyPend()
+******************************************************************************************/
+typedef struct{
+    INT8U index;                /* Block the DMA is not using, 0 or 1      */
+    INT32U seq;                 /* Blocks released since DMAInit()         */
+    OS_TICK tick;               /* OS tick at release                      */
+    INT8U dual;                 /* Fill with DMAFillFrames(), not DMAFillBuffer() */
+}DMA_BLOCK_INFO;
+/******************************************************************************************
+* Handoff counters, see DMAGetStats()
+******************************************************************************************/
+typedef struct{
+    INT32U released;            /* Blocks released by the ISR              */
+    INT32U dropped;             /* Not posted, consumer queue full         */
+    INT32U missed;              /* Sequence gaps seen by the consumer      */
+    OS_TICK last_lag;           /* Ticks from release to consumer pickup   */
+    OS_TICK max_lag;
+}DMA_STATS;
 /******************************************************************************************
 * Public functions
 ******************************************************************************************/
@@ -22,19 +62,104 @@
 * 02/25/2022 Nick Coyle
 *******************************************************************************************/
 void DMAInit(void);
+/****************************************************************************************
+ * DMASetConsumer
+ * Registers the task that fills the blocks. It must be created with a task queue of
+ * DMA_BLOCK_Q_SIZE messages. Blocks released before this call are not posted.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMASetConsumer(OS_TCB *tcb);
 /****************************************************************************************
  * DMA Flag
- * The DMA ISR is going to post this semaphore every time it gets halfway or all the way
- * to the end of the ping pong buffer. The sinegen buffer filling task will call this to
- * get the current index it should be writing to.
+ * The DMA ISR posts every block it releases, halfway or all the way through the ping
+ * pong buffer, to the consumer task queue. Called by the consumer task to get the next
+ * released block, oldest first. info may be null.
  * 08/30/2015 TDM
+ * 10/19/2026 Pends on the task queue, returns the block info
+ ***************************************************************************************/
+INT8U DMAReadyPend(OS_TICK tout, DMA_BLOCK_INFO *info, OS_ERR *os_err_ptr);
+/****************************************************************************************
+ * DMAGetStats
+ * Copy of the block handoff counters
+ * 10/19/2026
  ***************************************************************************************/
-INT8U DMAReadyPend(OS_TICK tout, OS_ERR *os_err_ptr);
+void DMAGetStats(DMA_STATS *stats);
+/****************************************************************************************
+ * Loop mode
+ * DMAPlayLoop() plays a table of DAC codes directly, one sample per trigger, with no
+ * interrupts. It starts at the end of the ping-pong buffer, or at the end of the
+ * current period when a loop is already playing. DMAPlayBlocks() goes back to
+ * ping-pong blocks at the end of the period, both blocks must be filled first.
+ * Both return FALSE while a previous change is pending, see DMALoopPending().
+ * DMALoopPlaying() is the table playing in loop mode, null otherwise.
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMAPlayLoop(const INT16U *table, INT16U length);
+INT8U DMAPlayBlocks(void);
+INT8U DMALoopPending(void);
+const INT16U *DMALoopPlaying(void);
+/****************************************************************************************
+ * DMASetMarker
+ * Sets the DB6 marker output to level when sample offset of block index is played.
+ * Call after DMAFillBuffer() for the block. One marker edge per block.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMASetMarker(INT8U index, INT16U offset, INT8U level);
+/****************************************************************************************
+ * DMASetSampleRate
+ * Sets the PIT0 sample rate, held in DMA_FS_MIN to DMA_FS_MAX. fs should divide the
+ * 60MHz bus clock, the rate played is BUS_FREQ/(BUS_FREQ/fs).
+ * Playing blocks, the rate changes when block index starts to play, so call it for the
+ * first block filled at the new rate. Otherwise it changes now, which is what a loop
+ * or the DC rest between bursts plays at.
+ * DMAGetSampleRate() is the rate playing now.
+ * 10/19/2026
+ ***************************************************************************************/
+void DMASetSampleRate(INT8U index, INT32U fs);
+INT32U DMAGetSampleRate(void);
+/****************************************************************************************
+ * Bursts
+ * A pre-rendered burst is played from loop mode, the loop table is what the output
+ * rests on between bursts. DMABurstArm() takes the loop playing now, so call it once
+ * DMALoopPlaying() returns the rest table and DMALoopPending() is FALSE.
+ * A burst plays once and returns to the loop. Gated, it repeats until the gate closes
+ * and then finishes the pass.
+ * DMABurstFire() starts an armed burst that is not already playing. It stops and
+ * restarts PIT0, so the first burst sample is always two sample periods after the
+ * call, whatever the phase of the sample clock was. DB7 pulses at the restart.
+ * Triggers set by DMABurstSetTrigger() call it from the SW2/SW3 port interrupt or a
+ * PIT2 period. Gated, a switch opens the gate while it is held down. Set the triggers
+ * after DMABurstArm(), the switch edges follow its gated setting.
+ * DMABurstDisarm() must be called before the burst buffer is changed.
+ * 10/19/2026
+ ***************************************************************************************/
+#define DMA_TRIG_SW2    0x01U
+#define DMA_TRIG_SW3    0x02U
+#define DMA_TRIG_TIMER  0x04U
+#define DMA_BURST_MAX   32767   /* Samples, CITER limit */
+INT8U DMABurstArm(const INT16U *buf, INT16U length, INT8U gated);
+void DMABurstDisarm(void);
+INT8U DMABurstBusy(void);
+void DMABurstFire(void);
+void DMABurstGateClose(void);
+void DMABurstSetTrigger(INT8U sources, INT16U period_ms);
 /*******************************************************************************************
 * DMAFillBuffer
 * Fills the DMA ping pong buffer
 * 02/25/2022 Nick Coyle
 *******************************************************************************************/
 void DMAFillBuffer(INT8U index, INT16U *samples);
+/****************************************************************************************
+ * Dual output
+ * In dual mode each block is SAMPLES_PER_BLOCK frames of a DAC0 and a DAC1 sample. One
+ * PIT0 trigger writes both, so the outputs are sample-synchronous.
+ * DMASetDual() changes mode at the end of the ping-pong buffer, block mode only.
+ * Blocks released from then on have info.dual set and are filled with DMAFillFrames().
+ * Loop mode and bursts drive DAC0 only.
+ * 10/19/2026
+ ***************************************************************************************/
+INT8U DMASetDual(INT8U on);
+INT8U DMADualActive(void);
+void DMAFillFrames(INT8U index, const INT16U *dac0, const INT16U *dac1);
 
 #endif /* DMA_H_ */
@@ -4,6 +4,11 @@
 * Verifies that read data matches last wrote data with a 16 bit checksum
 *
 * 02/24/2022 Dominic Danis
+* 10/19/2026 Added EEPROMSetConfig(), writes only the words that changed
+* 10/19/2026 Extension fields after the checksum with their own checksum. The
+*            original checksum range is unchanged so older saved configs still load.
+* 10/19/2026 DAC calibration block at EEPROM_CAL_ADDR, clear of the configuration
+* 10/19/2026 Second extension for the pulse duty, with its own checksum
 *
 * Includes functions by Todd Morton in SPI notes
 *******************************************************************************/
@@ -11,6 +16,17 @@
 #include "EEPROM.h"
 #include "MemoryTools.h"
 #include "os.h"
+#include <stddef.h>
+/*Size of the original block, up to and including checksum*/
+#define EEPROM_BASE_SIZE (offsetof(SAVED_CONFIG, checksum)+sizeof(INT16U))
+/*Size up to and including ext_checksum*/
+#define EEPROM_EXT_SIZE (offsetof(SAVED_CONFIG, ext_checksum)+sizeof(INT16U))
+/*Keeps an all zero extension from passing its checksum*/
+#define EEPROM_EXT_SEED  0x5A5A
+#define EEPROM_EXT2_SEED 0x3C3C
+/*Calibration block word address, the 93LC56B has 128 words*/
+#define EEPROM_CAL_ADDR  0x40
+#define EEPROM_CAL_SEED  0xA5C3
 /*Defined Constants for EEPROM Commands*/
 #define EWEN 0x04C0
 #define EWDS 0x0400
@@ -25,8 +41,18 @@ typedef union{
     SAVED_CONFIG Config;
     INT16U ConfigArr[(sizeof(SAVED_CONFIG)+1)/2];
 } EEPROMBLOCK;
+typedef union{
+    DAC_CAL Cal;
+    INT16U CalArr[(sizeof(DAC_CAL)+1)/2];
+} EEPROMCALBLOCK;
+static void eepromChkSum(EEPROMBLOCK *block);
+static void eepromCalChkSum(EEPROMCALBLOCK *block);
+static void eepromExtDefaults(void);
+static void eepromExt2Defaults(void);
 /*Locally stored EEPROMBLOCK*/
 static EEPROMBLOCK eepromCurrent;
+/*TRUE when eepromCurrent matches the EEPROM contents word for word*/
+static INT8U eepromImageValid = FALSE;
 /*****************************************************************************************
 * EEPROMInit
 * Function to initialize SPI from communication with 93LC56B EEPROM
@@ -58,8 +84,7 @@ void EEPROMInit(void){
  *****************************************************************************************/
 void EEPROMSaveState(INT8U state){
     eepromCurrent.Config.state = state;
-    eepromCurrent.Config.checksum = 0;
-    eepromCurrent.Config.checksum = MemChkSum((INT8U *)eepromCurrent.ConfigArr, (INT8U *)eepromCurrent.ConfigArr+(sizeof(SAVED_CONFIG)+1)/2);
+    eepromChkSum(&eepromCurrent);
     EEPROMSaveConfig();
 }
 /*****************************************************************************************
@@ -70,8 +95,7 @@ void EEPROMSaveState(INT8U state){
  *****************************************************************************************/
 void EEPROMSaveSineFreq(INT16U sine_freq){
     eepromCurrent.Config.sine_freq = sine_freq;
-    eepromCurrent.Config.checksum = 0;
-    eepromCurrent.Config.checksum = MemChkSum((INT8U *)eepromCurrent.ConfigArr, (INT8U *)eepromCurrent.ConfigArr+(sizeof(SAVED_CONFIG)+1)/2);
+    eepromChkSum(&eepromCurrent);
     EEPROMSaveConfig();
 }
 /*****************************************************************************************
@@ -82,8 +106,7 @@ void EEPROMSaveSineFreq(INT16U sine_freq){
  *****************************************************************************************/
 void EEPROMSaveSineLevel(INT8U sine_level){
     eepromCurrent.Config.sine_level = sine_level;
-    eepromCurrent.Config.checksum = 0;
-    eepromCurrent.Config.checksum = MemChkSum((INT8U *)eepromCurrent.ConfigArr, (INT8U *)eepromCurrent.ConfigArr+(sizeof(SAVED_CONFIG)+1)/2);
+    eepromChkSum(&eepromCurrent);
     EEPROMSaveConfig();
 }
 /*****************************************************************************************
@@ -94,8 +117,7 @@ void EEPROMSaveSineLevel(INT8U sine_level){
  *****************************************************************************************/
 void EEPROMSavePulseFreq(INT16U pulse_freq){
     eepromCurrent.Config.pulse_freq = pulse_freq;
-    eepromCurrent.Config.checksum = 0;
-    eepromCurrent.Config.checksum = MemChkSum((INT8U *)eepromCurrent.ConfigArr, (INT8U *)eepromCurrent.ConfigArr+(sizeof(SAVED_CONFIG)+1)/2);
+    eepromChkSum(&eepromCurrent);
     EEPROMSaveConfig();
 }
 /*****************************************************************************************
@@ -106,8 +128,7 @@ void EEPROMSavePulseFreq(INT16U pulse_freq){
  *****************************************************************************************/
 void EEPROMSavePulseLevel(INT8U pulse_level){
     eepromCurrent.Config.pulse_level = pulse_level;
-    eepromCurrent.Config.checksum = 0;
-    eepromCurrent.Config.checksum = MemChkSum((INT8U *)eepromCurrent.ConfigArr, (INT8U *)eepromCurrent.ConfigArr+(sizeof(SAVED_CONFIG)+1)/2);
+    eepromChkSum(&eepromCurrent);
     EEPROMSaveConfig();
 }
 /*****************************************************************************************
@@ -125,6 +146,45 @@ void EEPROMSaveConfig(void){
         OSTimeDly(7,OS_OPT_TIME_DLY,&os_err);
     }
     EEPROMCmd(EWDS);
+    eepromImageValid = TRUE;
+}
+/*****************************************************************************************
+* EEPROMSetConfig
+* Replaces the whole stored configuration, calculates a checksum and writes only the
+* words that differ from the last image read or written. Nothing is written if the
+* configuration is unchanged.
+* 10/19/2026
+ *****************************************************************************************/
+void EEPROMSetConfig(const SAVED_CONFIG *config){
+    OS_ERR os_err;
+    EEPROMBLOCK next;
+    INT8U enabled = FALSE;
+    next = eepromCurrent;                                                                   /*Keep padding bytes*/
+    next.Config.state = config->state;
+    next.Config.sine_freq = config->sine_freq;
+    next.Config.sine_level = config->sine_level;
+    next.Config.pulse_freq = config->pulse_freq;
+    next.Config.pulse_level = config->pulse_level;
+    next.Config.sine_wave = config->sine_wave;
+    next.Config.sine_duty = config->sine_duty;
+    next.Config.pulse_duty_mode = config->pulse_duty_mode;
+    next.Config.pulse_duty = config->pulse_duty;
+    eepromChkSum(&next);
+    for(INT8U addr = 0; addr<((sizeof(SAVED_CONFIG)+1)/2); addr++){                         /*Write changed words only*/
+        if(!eepromImageValid || (next.ConfigArr[addr] != eepromCurrent.ConfigArr[addr])){
+            if(!enabled){
+                EEPROMCmd(EWEN);
+                enabled = TRUE;
+            }else{}
+            EEPROMWrite(addr,next.ConfigArr[addr]);
+            OSTimeDly(7,OS_OPT_TIME_DLY,&os_err);
+        }else{}
+    }
+    if(enabled){
+        EEPROMCmd(EWDS);
+    }else{}
+    eepromCurrent = next;
+    eepromImageValid = TRUE;
 }
 /*****************************************************************************************
 * EEPROMGetConfig
@@ -136,23 +196,139 @@ void EEPROMSaveConfig(void){
 SAVED_CONFIG EEPROMGetConfig(void){
     INT8U addr = 0;
     INT16U cs = 0;
+    INT16U ext_cs = 0;
+    INT16U ext2_cs = 0;
     for(INT8U increment = 0; increment<((sizeof(SAVED_CONFIG)+1)/2); increment++){          /*Read the entire array*/
         eepromCurrent.ConfigArr[increment] = EEPROMRead(addr);
         addr++;
     }
+    eepromImageValid = TRUE;
     cs = eepromCurrent.Config.checksum;
-    eepromCurrent.Config.checksum = 0;
-    eepromCurrent.Config.checksum = MemChkSum((INT8U *)eepromCurrent.ConfigArr, (INT8U *)eepromCurrent.ConfigArr+(sizeof(SAVED_CONFIG)+1)/2);
+    ext_cs = eepromCurrent.Config.ext_checksum;
+    ext2_cs = eepromCurrent.Config.ext2_checksum;
+    eepromChkSum(&eepromCurrent);
     if(cs != eepromCurrent.Config.checksum){                                                /*Verify the loaded values agree with loaded checksum*/
         eepromCurrent.Config.state = 0;                                                     /*Set to defaults*/
         eepromCurrent.Config.sine_freq = 1000;
         eepromCurrent.Config.sine_level = 10;
         eepromCurrent.Config.pulse_freq = 1000;
         eepromCurrent.Config.pulse_level = 10;
+        eepromExtDefaults();
+        eepromImageValid = FALSE;                                                           /*Rewrite all on next set*/
+    }else if(ext_cs != eepromCurrent.Config.ext_checksum){                                  /*Saved before the extension*/
+        eepromExtDefaults();
+        eepromImageValid = FALSE;
+    }else if(ext2_cs != eepromCurrent.Config.ext2_checksum){                                /*Saved before the second*/
+        eepromExt2Defaults();
+        eepromImageValid = FALSE;
     }else{}
     return eepromCurrent.Config;
 }
 /*****************************************************************************************
+* EEPROMGetCal
+* Reads the calibration block and verifies its checksum. Defaults on a mismatch, which
+* is also what a unit that was never calibrated reads.
+* 10/19/2026
+ *****************************************************************************************/
+INT8U EEPROMGetCal(DAC_CAL *cal){
+    EEPROMCALBLOCK block;
+    INT16U cs;
+    INT8U valid;
+    for(INT8U addr = 0; addr<((sizeof(DAC_CAL)+1)/2); addr++){
+        block.CalArr[addr] = EEPROMRead(EEPROM_CAL_ADDR + addr);
+    }
+    cs = block.Cal.checksum;
+    eepromCalChkSum(&block);
+    if(cs == block.Cal.checksum){
+        *cal = block.Cal;
+        valid = TRUE;
+    }else{
+        cal->gain = DAC_CAL_GAIN_ONE;                                                       /*Set to defaults*/
+        cal->offset = 0;
+        for(INT8U k = 0; k < DAC_CAL_LEVELS; k++){
+            cal->trim[k] = 0;
+        }
+        cal->checksum = 0;
+        valid = FALSE;
+    }
+    return valid;
+}
+/*****************************************************************************************
+* EEPROMSetCal
+* Calculates the checksum and writes the whole calibration block. Padding is zeroed so
+* the checksum only depends on the fields.
+* 10/19/2026
+ *****************************************************************************************/
+void EEPROMSetCal(const DAC_CAL *cal){
+    OS_ERR os_err;
+    EEPROMCALBLOCK block;
+    for(INT8U addr = 0; addr<((sizeof(DAC_CAL)+1)/2); addr++){
+        block.CalArr[addr] = 0;
+    }
+    block.Cal.gain = cal->gain;
+    block.Cal.offset = cal->offset;
+    for(INT8U k = 0; k < DAC_CAL_LEVELS; k++){
+        block.Cal.trim[k] = cal->trim[k];
+    }
+    eepromCalChkSum(&block);
+    EEPROMCmd(EWEN);
+    for(INT8U addr = 0; addr<((sizeof(DAC_CAL)+1)/2); addr++){
+        EEPROMWrite(EEPROM_CAL_ADDR + addr,block.CalArr[addr]);
+        OSTimeDly(7,OS_OPT_TIME_DLY,&os_err);
+    }
+    EEPROMCmd(EWDS);
+}
+/*****************************************************************************************
+* eepromChkSum
+* Calculates the checksums of a block. The original checksum keeps its original byte
+* range so configs saved before the extension still verify. The extension checksum
+* covers the bytes between the first two checksums, ext2_checksum the bytes after
+* ext_checksum.
+* 10/19/2026
+ *****************************************************************************************/
+static void eepromChkSum(EEPROMBLOCK *block){
+    block->Config.checksum = 0;
+    block->Config.checksum = MemChkSum((INT8U *)block->ConfigArr, (INT8U *)block->ConfigArr+(EEPROM_BASE_SIZE+1)/2);
+    block->Config.ext_checksum = EEPROM_EXT_SEED +
+                                 MemChkSum((INT8U *)block->ConfigArr+EEPROM_BASE_SIZE,
+                                           (INT8U *)&block->Config.ext_checksum-1);
+    block->Config.ext2_checksum = EEPROM_EXT2_SEED +
+                                  MemChkSum((INT8U *)block->ConfigArr+EEPROM_EXT_SIZE,
+                                            (INT8U *)&block->Config.ext2_checksum-1);
+}
+/*****************************************************************************************
+* eepromCalChkSum
+* Checksum of the calibration block up to its checksum, seeded so an erased or all
+* zero block fails
+* 10/19/2026
+ *****************************************************************************************/
+static void eepromCalChkSum(EEPROMCALBLOCK *block){
+    block->Cal.checksum = EEPROM_CAL_SEED +
+                          MemChkSum((INT8U *)block->CalArr, (INT8U *)&block->Cal.checksum-1);
+}
+/*****************************************************************************************
+* eepromExtDefaults
+* Sets the extension fields of eepromCurrent, both extensions, to their defaults and
+* recalculates the checksums
+* 10/19/2026
+ *****************************************************************************************/
+static void eepromExtDefaults(void){
+    eepromCurrent.Config.sine_wave = 0;
+    eepromCurrent.Config.sine_duty = 50;
+    eepromExt2Defaults();
+}
+/*****************************************************************************************
+* eepromExt2Defaults
+* Sets the second extension fields of eepromCurrent to their defaults and recalculates
+* the checksums
+* 10/19/2026
+ *****************************************************************************************/
+static void eepromExt2Defaults(void){
+    eepromCurrent.Config.pulse_duty_mode = 0;
+    eepromCurrent.Config.pulse_duty = 0;
+    eepromChkSum(&eepromCurrent);
+}
+/*****************************************************************************************
 * EEEPROMRead
 * Sends an instruction to initiate a read on SPI with address to be read from
 * Sends dummy data, reads and returns data input on SPI
@@ -3,6 +3,10 @@
 * EEPROM.c is a module that will read and write to a 93LC56B EEPROM using SPI
 *
 * 02/24/2022 Dominic Danis
+* 10/19/2026 Added EEPROMSetConfig()
+* 10/19/2026 Added the DAC waveform and duty after the checksum
+* 10/19/2026 Added the DAC calibration block
+* 10/19/2026 Added the pulse duty after the extension checksum
 *
 * Includes functions by Todd Morton in SPI notes
 *******************************************************************************/
@@ -10,6 +14,9 @@
 #define EEPROM_H_
 
 /*Structure Definition for all parameters that must be kept track of*/
+/*Fields added after checksum have their own ext_checksum, and are set to*/
+/*defaults when loading a config saved without them. Fields after ext_checksum*/
+/*likewise have ext2_checksum.*/
 typedef struct{
     INT8U state;
     INT16U sine_freq;
@@ -17,8 +24,25 @@ typedef struct{
     INT16U pulse_freq;
     INT8U pulse_level;
     INT16U checksum;
+    INT8U sine_wave;        /*WAVE_T of the DAC output, default sine*/
+    INT8U sine_duty;        /*DAC square duty in percent, default 50*/
+    INT16U ext_checksum;
+    INT8U pulse_duty_mode;  /*PULSE_DUTY_MODE, default the level*/
+    INT32U pulse_duty;      /*Permille or ns for those modes*/
+    INT16U ext2_checksum;
 } SAVED_CONFIG;
 
+/*DAC0 calibration, kept in its own EEPROM block at EEPROM_CAL_ADDR with its own checksum*/
+/*so a configuration write never touches it. Defaults are the ideal 3.3V reference.*/
+#define DAC_CAL_LEVELS  21          /*Sine levels 0-20*/
+#define DAC_CAL_GAIN_ONE 16384      /*Q14 gain of 1.0*/
+typedef struct{
+    INT16U gain;                    /*Q14, ideal over measured volts per code*/
+    INT16S offset;                  /*DAC codes added to the midpoint*/
+    INT8S trim[DAC_CAL_LEVELS];     /*Per-level amplitude trim, 0.1% steps*/
+    INT16U checksum;
+} DAC_CAL;
+
 /*Public Functions*/
 
 /*****************************************************************************************
@@ -71,5 +95,25 @@ void EEPROMSavePulseFreq(INT16U pulse_freq);
 * 03/03/2022 Dominic Danis
  *****************************************************************************************/
 void EEPROMSavePulseLevel(INT8U pulse_level);
+/*****************************************************************************************
+* EEPROMSetConfig
+* Replaces the whole stored configuration, checksum is calculated here. Only the
+* EEPROM words that changed are written.
+* 10/19/2026
+ *****************************************************************************************/
+void EEPROMSetConfig(const SAVED_CONFIG *config);
+/*****************************************************************************************
+* EEPROMGetCal
+* Reads the DAC calibration block. Returns TRUE if its checksum matches, otherwise cal is
+* set to the defaults and FALSE is returned.
+* 10/19/2026
+ *****************************************************************************************/
+INT8U EEPROMGetCal(DAC_CAL *cal);
+/*****************************************************************************************
+* EEPROMSetCal
+* Writes the DAC calibration block, checksum is calculated here
+* 10/19/2026
+ *****************************************************************************************/
+void EEPROMSetCal(const DAC_CAL *cal);
 
 #endif
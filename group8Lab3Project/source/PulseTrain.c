@@ -4,6 +4,13 @@
 * must use a mutex. When the setter functions (for frequency and level) are called, the functions
 * set the current specs and they set the values in the FTM3 registers, to reflect the new frequency or level.
 * 02/15/2022 Aili Emory
+* 10/19/2026 Prescaler, MOD and edge or center alignment searched for the least frequency
+*            error, see pulseSolve()
+* 10/19/2026 MOD, CnV and the prescaler change together at the start of a period, see
+*            pulseUpdate()
+* 10/19/2026 Duty in permille or as a pulse width in ns, besides the level
+* 10/19/2026 Edge aligned only, the overflow that writes SC is at the start of a period
+* 10/19/2026 MOD held to 0xFFFE so CnV = MOD+1, a constant high, fits 16 bits at 100%
 *****************************************************************************************/
 #include "os.h"
 #include "app_cfg.h"
@@ -11,18 +18,42 @@
 #include "PulseTrain.h"
 
 #define BUS_FREQ 60000000         /*60 MHz*/
+#define PULSE_PS_MAX 7            /*Divide by 128*/
+#define PULSE_MOD_MAX 0xFFFE         /*MOD+1, 100%, must fit CnV*/
+#define PULSE_CNV_MAX 0xFFFF
+#define PULSE_CACHE_SIZE 8        /*Power of 2, direct mapped by frequency*/
+#define PULSE_PS_NONE 0xFF        /*FTM3 not started*/
+#define NS_PER_S 1000000000
 
-static INT16U Mod_Value;
 /****************************************************************************************/
 typedef struct{
     INT16U frequency;
     INT8U level;
+    PULSE_DUTY_MODE duty_mode;
+    INT32U duty;                /* Permille or ns, see duty_mode */
 }PULSE_TRAIN_SPECS;
 /****************************************************************************************
+* FTM3 setting for a frequency, edge aligned. MOD+1 counts per period, each count is
+* 2^ps bus clocks.
+****************************************************************************************/
+typedef struct{
+    INT16U freq;                /* 0 for an empty cache entry */
+    INT16U mod;
+    INT8U ps;
+}PULSE_SETTING;
+/****************************************************************************************
 * Private Resources
 ****************************************************************************************/
 static PULSE_TRAIN_SPECS CurrentSpecs;
 static OS_MUTEX PulseTrainMutexKey;
+static PULSE_SETTING pulseSetting;          /* In FTM3, under PulseTrainMutexKey */
+static PULSE_SETTING pulseCache[PULSE_CACHE_SIZE];
+static void pulseSolve(INT16U freq, PULSE_SETTING *best);
+static INT32U pulseCounts(const PULSE_SETTING *set);
+static void pulseUpdate(void);
+static INT32U pulseCnV(const PULSE_SETTING *set);
+static volatile INT32U pulseScNext;         /* SC written by FTM3_IRQHandler() */
+void FTM3_IRQHandler(void);
 /*****************************************************************************************
 * Init function - creates task and mutex.
 * 2/15/2022 Aili Emory
@@ -35,64 +66,86 @@ void PulseTrainInit(void){
     SIM->SCGC3 |= SIM_SCGC3_FTM3(1);   /* Enable clock gate for FTM3 */
     SIM->SCGC5 |= SIM_SCGC5_PORTE(1);  /* Enable clock gate for PORTE */
     PORTE->PCR[8] = PORT_PCR_MUX(6);   /* Set PCR for FTM output */
-    FTM3->CONTROLS[3].CnSC = FTM_CnSC_ELSA(0)|FTM_CnSC_ELSB(1);   /*PWM polarity */
+    FTM3->CONTROLS[3].CnSC = FTM_CnSC_MSB(1)|FTM_CnSC_ELSA(0)|FTM_CnSC_ELSB(1); /*Edge aligned PWM, high-true*/
+    FTM3->MODE = FTM_MODE_WPDIS(1)|FTM_MODE_FTMEN(1);              /*Enhanced features*/
+    FTM3->CNTIN = 0;
+    FTM3->SYNCONF = FTM_SYNCONF_SYNCMODE(1)|FTM_SYNCONF_SWWRBUF(1); /*SWSYNC loads MOD, CnV*/
+    FTM3->SYNC = FTM_SYNC_CNTMIN(1);                               /*at the start of a period*/
+    FTM3->COMBINE = FTM_COMBINE_SYNCEN1(1);                        /*Channels 2 and 3*/
+    pulseSetting.ps = PULSE_PS_NONE;                               /*SC written by the first set*/
+    NVIC_ClearPendingIRQ(FTM3_IRQn);
+    NVIC_EnableIRQ(FTM3_IRQn);
 }
 /*****************************************************************************************
 * Public setter function to set frequency
 * 02/15/2022 Aili Emory
+* 10/19/2026 Prescaler and MOD from pulseSolve(), loaded by pulseUpdate()
 *****************************************************************************************/
 void PulseTrainSetFreq(INT16U freq){
-    INT8U ps_value;
-    INT8U scaler_value;
-    INT8U level;
     OS_ERR os_err;
     OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
     CurrentSpecs.frequency = freq;
+    pulseUpdate();                              /* The level is dependent on frequency */
     OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
-
-    /*PS - Prescaler Factor Selection
-     *  0..Divide by 1
-     *  1..Divide by 2
-     *  2..Divide by 4
-     *  3..Divide by 8
-     *  4..Divide by 16
-     *  5..Divide by 32
-     *  6..Divide by 64
-     *  7..Divide by 128*/
-    if(freq > 1000){                            /* Prescaler factor selection */
-        ps_value = 0;
-        scaler_value = 1;
-    }
-    else if(freq > 100){
-        ps_value = 4;
-        scaler_value = 16;
-    }
-    else{
-        ps_value = 7;
-        scaler_value = 128;
-    }
-    FTM3->SC = FTM_SC_CLKS(1)|FTM_SC_CPWMS(1)|FTM_SC_PS(ps_value);  /* Bus clock, center-aligned, dynamic prescaler */
-    Mod_Value = BUS_FREQ / (scaler_value*freq*2);
-    FTM3->MOD = FTM_MOD_MOD(Mod_Value);                                         /* Set pulse train period */
-
-    OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err); /* The level is dependent on frequency */
-    level = CurrentSpecs.level;                                                      /* Reset the level */
-    OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
-    PulseTrainSetLevel(level);
 }
 /*****************************************************************************************
 * Public setter function to set duty cycle
 * 02/15/2022 Aili Emory
+* 10/19/2026 Loaded with the period by pulseUpdate()
+* 10/19/2026 Selects the level duty
 *****************************************************************************************/
 void PulseTrainSetLevel(INT8U level){
-    INT16U cnV;
     OS_ERR os_err;
     OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
     CurrentSpecs.level = level;
+    CurrentSpecs.duty_mode = PULSE_DUTY_LEVEL;
+    pulseUpdate();
     OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
-
-    cnV = (Mod_Value *level*5)/100;
-    FTM3->CONTROLS[3].CnV =  FTM_CnV_VAL(cnV);  /* Set pulse train duty cycle */
+}
+/*****************************************************************************************
+* PulseTrainSet - Frequency and level in one update
+* 10/19/2026
+*****************************************************************************************/
+void PulseTrainSet(INT16U freq, INT8U level){
+    OS_ERR os_err;
+    OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    CurrentSpecs.frequency = freq;
+    CurrentSpecs.level = level;
+    CurrentSpecs.duty_mode = PULSE_DUTY_LEVEL;
+    pulseUpdate();
+    OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* PulseTrainSetDuty - Permille duty, held to 1000, or the pulse width in ns
+* PULSE_DUTY_LEVEL goes back to the level's 5% steps, duty is not used.
+* 10/19/2026
+*****************************************************************************************/
+void PulseTrainSetDuty(PULSE_DUTY_MODE mode, INT32U duty){
+    OS_ERR os_err;
+    if(mode > PULSE_DUTY_NS){
+        mode = PULSE_DUTY_LEVEL;
+    }else if((mode == PULSE_DUTY_PERMILLE) && (duty > PULSE_PERMILLE_MAX)){
+        duty = PULSE_PERMILLE_MAX;
+    }else{
+    }
+    OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    CurrentSpecs.duty_mode = mode;
+    CurrentSpecs.duty = duty;
+    pulseUpdate();
+    OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* PulseTrainGetDuty - The duty mode, and its permille or ns in duty
+* 10/19/2026
+*****************************************************************************************/
+PULSE_DUTY_MODE PulseTrainGetDuty(INT32U *duty){
+    PULSE_DUTY_MODE mode;
+    OS_ERR os_err;
+    OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    mode = CurrentSpecs.duty_mode;
+    *duty = CurrentSpecs.duty;
+    OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
+    return mode;
 }
 /*****************************************************************************************
 * Getter function for frequency
@@ -118,3 +171,160 @@ INT8U PulseTrainGetLevel(void){
     OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
     return level;
 }
+/*****************************************************************************************
+* PulseTrainGetActualFreq - The frequency FTM3 makes, in mHz, 0 before the first set
+* 10/19/2026
+*****************************************************************************************/
+INT32U PulseTrainGetActualFreq(void){
+    INT64U ticks = 0;
+    INT32U mhz = 0;
+    OS_ERR os_err;
+    OSMutexPend(&PulseTrainMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    if(pulseSetting.ps != PULSE_PS_NONE){
+        ticks = (INT64U)pulseCounts(&pulseSetting) << pulseSetting.ps;
+    }else{
+    }
+    OSMutexPost(&PulseTrainMutexKey, OS_OPT_POST_NONE, &os_err);
+    if(ticks != 0){
+        mhz = (INT32U)((((INT64U)BUS_FREQ * 1000) + (ticks / 2)) / ticks);
+    }else{
+    }
+    return mhz;
+}
+/*****************************************************************************************
+* pulseUpdate - Loads the period and duty of CurrentSpecs, under PulseTrainMutexKey
+* MOD and CnV are written to their buffers and SWSYNC loads both at the next start of a
+* period, CNTIN, so no pulse is cut short or stretched. The prescaler in SC is not
+* buffered, a change is written by FTM3_IRQHandler() on the overflow, which edge aligned
+* is the same MOD to CNTIN step. A change that lands within a few cycles of that point
+* can give one period at the old MOD. The first update starts FTM3, with the clock off
+* the registers load at once.
+* 10/19/2026
+*****************************************************************************************/
+static void pulseUpdate(void){
+    PULSE_SETTING *entry;
+    INT32U sc;
+    INT16U freq = CurrentSpecs.frequency;
+    CPU_SR_ALLOC();
+    if(freq == 0){
+        freq = 1;
+    }else{
+    }
+    entry = &pulseCache[freq & (PULSE_CACHE_SIZE - 1)];
+    if(entry->freq != freq){                    /* Fixed length search on a miss */
+        pulseSolve(freq, entry);
+    }else{
+    }
+    FTM3->MOD = FTM_MOD_MOD(entry->mod);        /* Set pulse train period */
+    FTM3->CONTROLS[3].CnV = FTM_CnV_VAL(pulseCnV(entry));   /* Set pulse train duty cycle */
+    sc = FTM_SC_CLKS(1)|FTM_SC_PS(entry->ps);  /* Bus clock, edge aligned */
+    if(pulseSetting.ps == PULSE_PS_NONE){
+        FTM3->CNT = 0;
+        FTM3->SC = sc;
+    }else if(entry->ps != pulseSetting.ps){
+        CPU_CRITICAL_ENTER();
+        pulseScNext = sc;
+        FTM3->SYNC |= FTM_SYNC_SWSYNC_MASK;
+        (void)FTM3->SC;                         /* Clear an old TOF, then wait for the next */
+        FTM3->SC = (FTM3->SC & ~FTM_SC_TOF_MASK) | FTM_SC_TOIE_MASK;
+        CPU_CRITICAL_EXIT();
+    }else{
+        FTM3->SYNC |= FTM_SYNC_SWSYNC_MASK;
+    }
+    pulseSetting = *entry;
+}
+/*****************************************************************************************
+* pulseCnV - CnV for the duty of CurrentSpecs at a setting, under PulseTrainMutexKey
+* The level is 5% steps and permille is rounded, both of the counts in the period. A
+* width in ns is counts of 2^ps bus clocks. Held to the period, 100%, CnV = MOD+1 keeps
+* the output high for the whole period.
+* 10/19/2026
+*****************************************************************************************/
+static INT32U pulseCnV(const PULSE_SETTING *set){
+    INT64U cnV;
+    INT64U d;
+    INT32U counts = pulseCounts(set);
+    if(CurrentSpecs.duty_mode == PULSE_DUTY_PERMILLE){
+        cnV = (((INT64U)counts * CurrentSpecs.duty) + (PULSE_PERMILLE_MAX / 2)) / PULSE_PERMILLE_MAX;
+    }else if(CurrentSpecs.duty_mode == PULSE_DUTY_NS){
+        d = (INT64U)NS_PER_S << set->ps;
+        cnV = (((INT64U)CurrentSpecs.duty * BUS_FREQ) + (d / 2)) / d;
+    }else{
+        cnV = ((INT64U)counts * CurrentSpecs.level * 5) / 100;
+    }
+    if(cnV > counts){
+        cnV = counts;
+    }else{
+    }
+    if(cnV > PULSE_CNV_MAX){                    /* Not reached, MOD+1 fits with PULSE_MOD_MAX */
+        cnV = PULSE_CNV_MAX;
+    }else{
+    }
+    return (INT32U)cnV;
+}
+/*****************************************************************************************
+* FTM3 Interrupt Handler, overflow
+* Enabled by pulseUpdate() for a prescaler change. Edge aligned, TOF is set as CNT goes
+* from MOD to CNTIN, the start of the period MOD and CnV were loaded at. Writes the new
+* SC, clearing TOF and TOIE.
+* 10/19/2026
+*****************************************************************************************/
+void FTM3_IRQHandler(void){
+    OSIntEnter();
+    (void)FTM3->SC;
+    FTM3->SC = pulseScNext;
+    OSIntExit();
+}
+/*****************************************************************************************
+* pulseSolve - Searches every prescaler for the least frequency error
+* For a count c of 2^ps bus clocks the period is c*d/f bus clocks with d = f*2^ps, so c
+* is BUS_FREQ/d rounded and held to the MOD range. The error in Hz is
+* |BUS_FREQ - d*c|/(2^ps*c), compared by cross multiplication in 64 bits. On equal error
+* the most counts per period wins, the finest duty. 8 candidates whatever the frequency.
+* Center aligned is not searched. Over 10Hz-10kHz it never beats edge aligned, and its
+* overflow is mid-period, where the SC write would cut a period short.
+* 10/19/2026
+*****************************************************************************************/
+static void pulseSolve(INT16U freq, PULSE_SETTING *best){
+    INT64U d;
+    INT64U c;
+    INT64U err;
+    INT64U q;
+    INT64U best_err = 1;
+    INT64U best_q = 0;                          /* Nothing found yet */
+    PULSE_SETTING set;
+
+    set.freq = freq;
+    for(INT8U ps = 0; ps <= PULSE_PS_MAX; ps++){
+        d = (INT64U)freq << ps;
+        c = (BUS_FREQ + (d / 2)) / d;
+        if(c > ((INT64U)PULSE_MOD_MAX + 1)){
+            c = (INT64U)PULSE_MOD_MAX + 1;
+        }else if(c < 2){
+            c = 2;
+        }else{
+        }
+        if((INT64U)BUS_FREQ > (d * c)){
+            err = BUS_FREQ - (d * c);
+        }else{
+            err = (d * c) - BUS_FREQ;
+        }
+        q = c << ps;
+        if((best_q == 0) || ((err * best_q) < (best_err * q)) ||
+           (((err * best_q) == (best_err * q)) && ((c - 1) > best->mod))){
+            set.ps = ps;
+            set.mod = (INT16U)(c - 1);
+            *best = set;
+            best_err = err;
+            best_q = q;
+        }else{
+        }
+    }
+}
+/*****************************************************************************************
+* pulseCounts - Duty counts in one period, CnV of this is 100%
+* 10/19/2026
+*****************************************************************************************/
+static INT32U pulseCounts(const PULSE_SETTING *set){
+    return (INT32U)set->mod + 1;
+}
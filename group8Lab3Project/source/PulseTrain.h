@@ -5,10 +5,20 @@
 * set the current specs and they set the values in the FTM3 registers, to reflect the new frequency or level.
 *
 * 02/15/2022 Aili Emory
+* 10/19/2026 Added PulseTrainGetActualFreq()
+* 10/19/2026 Added PulseTrainSet(), changes load at the start of a period
+* 10/19/2026 Added PulseTrainSetDuty(), permille or pulse width duty
 *****************************************************************************************/
 #ifndef PULSETRAIN_H_
 #define PULSETRAIN_H_
 /*****************************************************************************************
+* Pulse duty. PULSE_DUTY_LEVEL is the level in 5% steps, PULSE_DUTY_PERMILLE is 0.1%
+* steps of the period and PULSE_DUTY_NS a pulse width in ns that stays the same when
+* the frequency changes, held to the period. All are rounded to the FTM3 counts.
+*****************************************************************************************/
+typedef enum {PULSE_DUTY_LEVEL, PULSE_DUTY_PERMILLE, PULSE_DUTY_NS} PULSE_DUTY_MODE;
+#define PULSE_PERMILLE_MAX 1000
+/*****************************************************************************************
 * Init function - creates task and Mutex.
 * 2/15/2022 Aili Emory
 *****************************************************************************************/
@@ -21,9 +31,16 @@ void PulseTrainSetFreq(INT16U freq);
 /*****************************************************************************************
 * Public setter function to set duty cycle
 * 02/15/2022 Aili Emory
+* 10/19/2026 Selects PULSE_DUTY_LEVEL, so does PulseTrainSet()
 *****************************************************************************************/
 void PulseTrainSetLevel(INT8U level);
 /*****************************************************************************************
+* Sets frequency and level together, one update of FTM3. Every setter's change is
+* loaded at the start of the next period, so no pulse is cut short or stretched.
+* 10/19/2026
+*****************************************************************************************/
+void PulseTrainSet(INT16U freq, INT8U level);
+/*****************************************************************************************
 * Getter function for frequency
 * 02/15/2022 Aili Emory
 *****************************************************************************************/
@@ -33,5 +50,19 @@ INT16U PulseTrainGetFreq(void);
 * 02/15/2022 Aili Emory
 *****************************************************************************************/
 INT8U PulseTrainGetLevel(void);
+/*****************************************************************************************
+* Frequency FTM3 makes for the set frequency, in mHz. The setter picks the prescaler
+* and MOD with the least error, so this differs from the set frequency by the
+* nearest bus clock divide.
+* 10/19/2026
+*****************************************************************************************/
+INT32U PulseTrainGetActualFreq(void);
+/*****************************************************************************************
+* Duty setter and getter, duty is permille or ns for the mode. The setter holds a
+* permille duty to PULSE_PERMILLE_MAX and takes PULSE_DUTY_LEVEL for a bad mode.
+* 10/19/2026
+*****************************************************************************************/
+void PulseTrainSetDuty(PULSE_DUTY_MODE mode, INT32U duty);
+PULSE_DUTY_MODE PulseTrainGetDuty(INT32U *duty);
 
 #endif /* PULSETRAIN_H_ */
@@ -3,22 +3,85 @@
  * Contains single task, which will pend on a DMA flag, calculate sinewave values based
  * on current configurations and store in DMA ping pong buffer
  * 02/14/2022 Dominic Danis
+ * 10/19/2026 Blocks arrive on the task queue, one fill per released block
+ * 10/19/2026 Waveform engine. A 32-bit phase accumulator drives one block kernel per
+ *            waveform: sine, triangle, saw, ramp and square with duty. Saw, ramp and
+ *            square are band-limited with PolyBLEP at their discontinuities.
+ * 10/19/2026 Arbitrary waveform. Double-buffered RAM tables, resampled per block or,
+ *            at the native rate, looped by the DMA with no CPU.
+ * 10/19/2026 Linear and log sine sweeps, per sample increment updates and a DB6 marker
+ * 10/19/2026 AM, FM and PM of the sine by an LFO updated every MOD_CTRL_LEN samples,
+ *            and a DWT cycle count of the block work against the block period
+ * 10/19/2026 Multitone. Tone phases, increments and amplitudes are kept as arrays and
+ *            summed a tone at a time into a block accumulator.
+ * 10/19/2026 White and pink noise from xorshift32, two samples per word
+ * 10/19/2026 Bursts rendered ahead into burstBuf, played from a DC loop by the DMA
+ * 10/19/2026 Channel B on DAC1, run from a copy of the kernel state at a phase offset
+ * 10/19/2026 Sample rate chosen per block from the output, see sineRateSelect()
+ * 10/19/2026 TPDF dither and error feedback noise shaping in the kernel quantiser
+ * 10/19/2026 DAC calibration folded into the per-level scale and the midpoint
+ * 10/19/2026 Plain kernels for dither off and a flat fill for level 0
+ * 10/19/2026 Task state in file statics, the stack holds only the calls. Stack checked.
+ * 10/19/2026 Multitone frequencies are checked against the rate playing, tones out of it
+ *            are left out of the sum
+ * 10/19/2026 Up to 16 tones, the auto rate held to what the tones can fill, see
+ *            bench_kernels. The peak floor is the RMS of the tones.
+ * 10/19/2026 A committed ARB table is swapped in at once when ARB is not playing
  *****************************************************************************************/
 
 #include "os.h"
 #include "app_cfg.h"
 #include "MCUType.h"
+#include "K65TWR_ClkCfg.h"
 #include "arm_math.h"
+#include <math.h>
+#include "EEPROM.h"
 #include "SineGeneration.h"
 #include "DMA.h"
 #include "K65TWR_GPIO.h"
 
-#define TS 44739                /* TS = Ts=1/48000 scaled up by (2^31) */
+#define SWEEP_MIN_FS 24000      /* Blocks shorter than SWEEP_MIN_MS */
+#define NOISE_FS 48000          /* Noise bandwidth, frequency does not apply */
+#define MT_PEAK_FS DMA_FS_DEFAULT   /* Rate the multitone peak is found at */
+#define MT_TONE_RATE 1600000    /* Tone samples a second in half the core, see bench_kernels */
 #define BIT31_MASK 0x80000000   /* 2^31 */
-#define BIT15_MASK 0x8000       /* 2^15 */
-#define BIT20_MASK 0x100000     /* 2^20 */
+#define BIT30_MASK 0x40000000   /* 2^30, full scale of the Q30 kernel samples */
+#define BIT19_MASK 0x80000      /* 2^19 */
 #define AMP_SCALE 1490          /* (3/(20*3.3))*(2^15) and rounded up */
 #define DC_OFF 2047             /* halfway point of DAC0 = 2048-1 */
+#define DUTY_MIN 1
+#define DUTY_MAX 99
+#define DUTY_DEFAULT 50
+#define AWG_DC_CODE 0x0800      /* Table sample for 0V out, DAC midpoint */
+#define LOOP_POLL_TOUT 10       /* Ticks between checks while the DMA loops a table */
+#define SWEEP_MIN_MS 50         /* At most one sweep boundary per block */
+#define SWEEP_NO_MARK 0xFFFF
+#define MOD_CTRL_SHIFT 4
+#define MOD_CTRL_LEN (1 << MOD_CTRL_SHIFT)  /* Samples per modulation control step */
+#define LFO_FULL 32767          /* Q15 LFO peak */
+#define BIT15_MASK 0x8000       /* 1.0 in Q15 */
+#define MT_PEAK_SAMPLES 2048    /* Samples run to find the multitone peak */
+#define MT_FULL 0x0F000000      /* Multitone peak, Q28 less 1/16 for peaks not seen */
+#define MT_AMP_RAW 4            /* Weight to raw amplitude, 16 tones stay in 31 bits */
+#define MT_DAC_MAX 12           /* Bits for __USAT() */
+#define MT_SUM_MAX 29           /* Bits for __SSAT(), Q28 sum held in +-1 */
+#define NOISE_SEED 0x2545F491U  /* Any non-zero xorshift32 state */
+#define PINK_ROWS 15            /* Voss-McCartney rows, lowest updates at 1.5Hz */
+#define NOISE_WHITE_GAIN 10033  /* sqrt(3/2)*2^13, uniform Q15 to the sine RMS in Q28 */
+#define NOISE_PINK_GAIN 2508    /* sqrt(3/32)*2^13, sum of 16 uniform Q15 likewise */
+#define BIT16_MASK 0x10000      /* 2^16 */
+#define DAC_LSB_SHIFT 20        /* Kernel output is DAC codes << 20 */
+#define DAC_BITS 12
+#define DITHER_LCG_A 1664525U   /* Numerical Recipes LCG */
+#define DITHER_LCG_C 1013904223U
+#define DITHER_SHIFT 12         /* Top 20 bits of the LCG, +-1/2 LSB */
+#define SINE_SCALE_MAX 32767    /* (s>>14)*scale stays in 32 bits */
+#define CAL_TRIM_DIV 1000       /* Trim steps are 0.1% */
+#define CAL_GAIN_MIN 14746      /* Q14 0.9 */
+#define CAL_GAIN_MAX 18022      /* Q14 1.1 */
+#define CAL_OFFSET_MAX 100      /* DAC codes */
+#define CAL_VREF_MV 3300
+#define DAC_CODES 4096
 
 /****************************************************************************************
 * Allocate task control block
@@ -31,17 +94,327 @@ static CPU_STK sineGenTaskTaskStk[APP_CFG_SINEGEN_TASK_STK_SIZE];
 typedef struct{
     INT16U frequency;
     INT8U level;
+    WAVE_T wave;
+    INT8U duty;
+    INT8U sweep_req;            /* SweepStart() or SweepStop() waiting for the task */
+    INT8U sweep_on;
+    SWEEP_CFG sweep;
+    MOD_CFG mod;
+    BURST_CFG burst;
+    DUAL_CFG dual;
+    INT32U rate;                /* SAMPLE_RATE_AUTO or a fixed rate */
+    DITHER_MODE dither;
+    INT16U cal_drive;           /* Code held by SineCalDrive(), or SINE_CAL_OFF */
 }SINE_SPECS;
 /****************************************************************************************
+* Sweep state. The increment is Q32.32 so it can move by less than one phase step per
+* sample. Each sample adds
+*   inc += dinc + (inc>>32)*rate
+* dinc is the linear step, rate is the log step per sample, Q32. One of them is zero.
+****************************************************************************************/
+typedef struct{
+    INT64U inc;
+    INT64S dinc;
+    INT32S rate;
+    INT32U remaining;           /* Samples left in the segment */
+    INT32U seg_len;
+    INT64U inc_start;
+    INT64U inc_stop;
+    INT64S dinc_up;
+    INT64S dinc_dn;
+    INT32S rate_up;
+    INT32S rate_dn;
+    SWEEP_MODE mode;
+    INT8U up;                   /* Segment runs start to stop */
+    INT8U active;
+    INT8U marker;               /* DB6 level */
+    INT16U mark_offset;         /* Sample of the boundary in this block, or SWEEP_NO_MARK */
+}SWEEP_STATE;
+/****************************************************************************************
+* Modulation state. The LFO is evaluated once per control step, Q15. AM ramps the scale
+* and PM ramps the phase offset across the step, FM holds the increment for the step.
+****************************************************************************************/
+typedef struct{
+    MOD_TYPE type;
+    LFO_SHAPE shape;
+    INT32U lfo_phase;
+    INT32U lfo_inc;             /* LFO phase step per control step */
+    INT32S am_depth;            /* Q15 */
+    INT32S am_scale;            /* scale/(1+depth), keeps the AM peak at the set level */
+    INT64S dev;                 /* FM increment or PM phase peak deviation */
+    INT32S scale;               /* Scale at the last control step */
+    INT32U off;                 /* Phase offset at the last control step */
+}MOD_STATE;
+/****************************************************************************************
+* Noise state. row[] are the Voss-McCartney rows, row k is redrawn every 2^(k+1)
+* samples and sum is their running total.
+****************************************************************************************/
+typedef struct{
+    INT32U x;
+    INT32U count;
+    INT32S row[PINK_ROWS];
+    INT32S sum;
+}NOISE_STATE;
+/****************************************************************************************
+* Dither state, kept across blocks. x is the LCG, r its last value, the dither is the
+* difference of two values so it is triangular. e1 and e2 are the last two errors.
+****************************************************************************************/
+typedef struct{
+    INT32U x;
+    INT32S r;
+    INT32S e1;
+    INT32S e2;
+}DITHER_STATE;
+/****************************************************************************************
+* Kernel state for one block. Samples are Q30 signed, phase is a full 32-bit turn.
+****************************************************************************************/
+typedef struct{
+    INT32U phase;
+    INT32U inc;                 /* Phase increment per sample          */
+    INT64U recip;               /* 2^62/inc, for the PolyBLEP position */
+    INT32U duty;                /* Square falling edge phase           */
+    INT32S scale;               /* Calibrated scale of the level       */
+    INT32S scale_b;             /* Channel B's                         */
+    INT32S dc;                  /* Calibrated DAC midpoint             */
+    INT32U fs;                  /* Sample rate the block is made for   */
+    const INT16U *arb;          /* Arbitrary table and length          */
+    INT16U arb_len;
+    const INT16U *arb_next;     /* Table to swap in at the next period, null if none */
+    INT16U arb_next_len;
+    INT8U arb_swapped;          /* Set by the kernel when it swapped   */
+    SWEEP_STATE *sweep;
+    MOD_STATE *mod;
+    NOISE_STATE *noise;
+    DITHER_STATE *dither;
+    INT32S dither_mask;         /* All ones with dither, zero without */
+    INT32S dither_a1;           /* Error feedback, the error is filtered by   */
+    INT32S dither_a2;           /* 1 - a1*z^-1 - a2*z^-2                      */
+}WAVE_STATE;
+/****************************************************************************************
+* Calibration folded into a scale per level, see SineCalSet()
+****************************************************************************************/
+typedef struct{
+    DAC_CAL cal;
+    INT32S scale[SINE_LEVEL_MAX + 1];
+    INT32S dc;
+}SINE_CAL;
+/****************************************************************************************
+* Arbitrary waveform tables. table[active] plays, the other is loaded and swapped in.
+****************************************************************************************/
+typedef struct{
+    INT16U table[2][AWG_MAX_SAMPLES];
+    INT16U length[2];
+    INT8U active;
+    INT8U swap;                 /* Staging table committed, waiting for a period boundary */
+    INT8U loading;
+    INT16U load_pos;
+}AWG_TABLES;
+/****************************************************************************************
+* Multitone tones, one array per field so the kernel walks each tone's values in order.
+* amp is Q28 full scale for the sum of the Q15 sines. seq changes with every set.
+* inc is set from freq for the sample rate playing, see mtSetRate().
+****************************************************************************************/
+typedef struct{
+    INT32U phase[MT_MAX_TONES];
+    INT32U inc[MT_MAX_TONES];
+    INT16U freq[MT_MAX_TONES];
+    INT32S amp[MT_MAX_TONES];
+    INT8U count;
+    INT8U seq;
+}MT_TONES;
+/****************************************************************************************
+* Burst rendered in burstBuf, and what it was rendered from
+****************************************************************************************/
+typedef struct{
+    SINE_SPECS specs;
+    INT32U fs;
+    INT8U mt_seq;
+    INT8U armed;
+}BURST_STATE;
+typedef void (*WAVE_KERNEL)(INT16U *out, WAVE_STATE *ws);
+/****************************************************************************************
 * Private Resources
 ****************************************************************************************/
 static SINE_SPECS sineCurrentSpecs;
+static SINE_CAL sineCal;                /* Under sineMutexKey */
 static OS_MUTEX sineMutexKey;
 static INT16U sine_vals[SAMPLES_PER_BLOCK];
+static INT16U dual_vals[SAMPLES_PER_BLOCK];
+static INT32U dualPhase;                /* Channel B phase, sineGenTask only */
+static DITHER_STATE dualDither;
+static WAVE_STATE dualWs;               /* Channel B kernel state, sineFillBlock() only */
+static const INT8S ditherCoef[DITHER_NUM][2] = {{0, 0}, {0, 0}, {1, 0}, {2, -1}};
+static AWG_TABLES awg;
+static SINE_LOAD sineLoad;
+static const INT16U awgDcTable[1] = {AWG_DC_CODE};
+static MT_TONES mtSet;                  /* Set by MultitoneSet(), under sineMutexKey */
+static MT_TONES mtNew;                  /* MultitoneSet() work space, under mtMutexKey */
+static MT_TONES mtPlay;                 /* Tones playing, sineGenTask only */
+static OS_MUTEX mtMutexKey;
+static SINE_SPECS sineSpecs;            /* Specs of the block, sineGenTask only */
+static WAVE_STATE sineWs;               /* Kernel state, sineGenTask only */
+static SWEEP_STATE sineSweep;
+static MOD_STATE sineMod;
+static NOISE_STATE sineNoise;
+static DITHER_STATE sineDither;
+static BURST_STATE sineBurst;
+static INT32S mtAcc[SAMPLES_PER_BLOCK];
+static INT16U burstBuf[BURST_MAX_SAMPLES];
+static INT16U burstRest[1] = {DC_OFF};     /* Calibrated midpoint, set by sineGenTask */
+static const MT_TONE mtDefault[2] = {{60, 800, 0}, {7000, 200, 0}};
+static const INT32U sineRates[] = {8000, 16000, 24000, 48000, 96000, 120000, 200000};
+#define SINE_RATE_NUM (sizeof(sineRates)/sizeof(sineRates[0]))
 /*****************************************************************************************
 * Task Function Prototypes.
 *****************************************************************************************/
 static void sineGenTask(void *p_arg);
+static void sineFillBlock(INT8U index, const SINE_SPECS *specs, WAVE_STATE *ws, INT8U dual);
+static void waveArb(INT16U *out, WAVE_STATE *ws);
+static void sweepSetup(SWEEP_STATE *sw, const SWEEP_CFG *cfg, INT32U fs);
+static void sweepBoundary(SWEEP_STATE *sw, INT16U sample);
+static void modSetup(MOD_STATE *ms, const MOD_CFG *cfg, WAVE_STATE *ws);
+static INT32S lfoValue(LFO_SHAPE shape, INT32U q);
+static void waveSineMod(INT16U *out, WAVE_STATE *ws);
+static void waveMulti(INT16U *out, WAVE_STATE *ws);
+static INT32S mtPeak(MT_TONES *mt);
+static void waveWhite(INT16U *out, WAVE_STATE *ws);
+static void wavePink(INT16U *out, WAVE_STATE *ws);
+static void sineBurstUpdate(const SINE_SPECS *specs, WAVE_STATE *ws, BURST_STATE *bs);
+static INT16U sineBurstRender(const SINE_SPECS *specs, WAVE_STATE *ws);
+static INT32U sineRateSelect(const SINE_SPECS *specs, INT16U arb_len);
+static INT32U sineRateRound(INT32U fs);
+static void mtSetRate(MT_TONES *mt, INT32U fs);
+
+/*****************************************************************************************
+* Waveform kernels
+* WAVE_KERNEL_DEF() builds the block loop around the expression that sets the Q30 sample
+* s from the phase p, so every waveform shares the same scaling and DAC conversion.
+* step advances the phase, a fixed increment or a sweep.
+* (s>>14) is Q16, times the scale, at most SINE_SCALE_MAX, it fits in 32 bits, and >>20
+* gives the 12-bit DAC offset from the calibrated midpoint, as the original sine path.
+* Each waveform is built twice from the same expression. name quantises with error
+* feedback and dither, see DitherSet(), the error stays in +-1.5 LSB and 2^20 LSB so v
+* keeps clear of 2^31. namePlain is the plain rounding for dither off, without the
+* generator and feedback terms per sample. The scale is the block's entry of the level
+* table, see SineCalSet(), and level 0 is the flat fill, see waveKernelSelect().
+*****************************************************************************************/
+static INT32S waveBlep(INT32U p, const WAVE_STATE *ws);
+
+#define WAVE_KERNEL_LOOP(name, expr, step, quant)                               \
+static void name(INT16U *out, WAVE_STATE *ws){                                  \
+    INT32U p = ws->phase;                                                       \
+    const INT32U inc = ws->inc;                                                 \
+    const INT32S scale = ws->scale;                                             \
+    const INT32S dc = ws->dc;                                                   \
+    DITHER_STATE dt = *ws->dither;                                              \
+    INT32S s;                                                                   \
+    INT32S v;                                                                   \
+    INT32S d;                                                                   \
+    (void)inc;                                                                  \
+    (void)v;                                                                    \
+    (void)d;                                                                    \
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){                                  \
+        expr;                                                                   \
+        quant;                                                                  \
+        out[i] = (INT16U)__USAT(dc + s, DAC_BITS);                              \
+        step;                                                                   \
+    }                                                                           \
+    ws->phase = p;                                                              \
+    *ws->dither = dt;                                                           \
+}
+#define QUANT_DITHER                                                            \
+    v = ((s >> 14) * scale) - (ws->dither_a1 * dt.e1) - (ws->dither_a2 * dt.e2); \
+    dt.x = (dt.x * DITHER_LCG_A) + DITHER_LCG_C;                                \
+    d = (INT32S)dt.x >> DITHER_SHIFT;                                           \
+    s = (v + ((d - dt.r) & ws->dither_mask) + BIT19_MASK) >> DAC_LSB_SHIFT;     \
+    dt.r = d;                                                                   \
+    dt.e2 = dt.e1;                                                              \
+    dt.e1 = (s << DAC_LSB_SHIFT) - v
+#define QUANT_PLAIN                                                             \
+    s = (((s >> 14) * scale) + BIT19_MASK) >> DAC_LSB_SHIFT
+#define WAVE_KERNEL_DEF(name, expr, step)                                       \
+    WAVE_KERNEL_LOOP(name, expr, step, QUANT_DITHER)                            \
+    WAVE_KERNEL_LOOP(name##Plain, expr, step, QUANT_PLAIN)
+#define WAVE_STEP   p += inc
+/* Sweep, boundaries are rare so the call is out of line */
+#define SWEEP_STEP                                                              \
+    SWEEP_STATE *sw = ws->sweep;                                                \
+    p += (INT32U)(sw->inc >> 32);                                               \
+    sw->inc += sw->dinc + ((INT64S)(sw->inc >> 32) * sw->rate);                  \
+    if(--sw->remaining == 0){                                                   \
+        sweepBoundary(sw, i + 1);                                               \
+    }else{                                                                      \
+    }
+
+/* arm_sin_q31() takes a 31-bit phase */
+WAVE_KERNEL_DEF(waveSine, s = arm_sin_q31((q31_t)(p >> 1)) >> 1, WAVE_STEP)
+WAVE_KERNEL_DEF(waveSineSweep, s = arm_sin_q31((q31_t)(p >> 1)) >> 1, SWEEP_STEP)
+/* Fold the phase into a rise and fall, started a quarter turn in to cross zero at p=0 */
+WAVE_KERNEL_DEF(waveTriangle,
+    INT32U q = p + BIT30_MASK;
+    q = q ^ (INT32U)((INT32S)q >> 31);
+    s = (INT32S)q - BIT30_MASK, WAVE_STEP)
+/* Rising saw, drops at the end of the turn */
+WAVE_KERNEL_DEF(waveSaw, s = ((INT32S)(p ^ BIT31_MASK) >> 1) - waveBlep(p, ws), WAVE_STEP)
+/* Falling saw, rises at the end of the turn */
+WAVE_KERNEL_DEF(waveRamp, s = ((INT32S)(~p ^ BIT31_MASK) >> 1) + waveBlep(p, ws), WAVE_STEP)
+/* High until the duty phase, rises at p=0 and falls at the duty phase */
+WAVE_KERNEL_DEF(waveSquare,
+    s = ((p < ws->duty) ? BIT30_MASK : -BIT30_MASK) + waveBlep(p, ws) - waveBlep(p - ws->duty, ws),
+    WAVE_STEP)
+
+static const WAVE_KERNEL waveKernels[WAVE_NUM] = {
+    waveSine,                   /* WAVE_SINE     */
+    waveTriangle,               /* WAVE_TRIANGLE */
+    waveSaw,                    /* WAVE_SAW      */
+    waveRamp,                   /* WAVE_RAMP     */
+    waveSquare,                 /* WAVE_SQUARE   */
+    waveArb,                    /* WAVE_ARB      */
+    waveMulti,                  /* WAVE_MULTI    */
+    waveWhite,                  /* WAVE_WHITE    */
+    wavePink                    /* WAVE_PINK     */
+};
+static const WAVE_KERNEL wavePlainKernels[WAVE_NUM] = {
+    waveSinePlain,              /* WAVE_SINE     */
+    waveTrianglePlain,          /* WAVE_TRIANGLE */
+    waveSawPlain,               /* WAVE_SAW      */
+    waveRampPlain,              /* WAVE_RAMP     */
+    waveSquarePlain,            /* WAVE_SQUARE   */
+    waveArb,                    /* WAVE_ARB      */
+    waveMulti,                  /* WAVE_MULTI    */
+    waveWhite,                  /* WAVE_WHITE    */
+    wavePink                    /* WAVE_PINK     */
+};
+
+/*****************************************************************************************
+* waveFlat - Level 0, the calibrated midpoint with the phase carried on. Multitone and
+* noise state holds until the level is back up.
+* 10/19/2026
+*****************************************************************************************/
+static void waveFlat(INT16U *out, WAVE_STATE *ws){
+    const INT16U dc = (INT16U)ws->dc;
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+        out[i] = dc;
+    }
+    ws->phase += ws->inc * SAMPLES_PER_BLOCK;
+}
+/*****************************************************************************************
+* waveKernelSelect - Kernel for a wave at the block's level and dither setting
+* Level 0 is the flat fill except for an arbitrary table, which plays its codes at any
+* level. Dither off takes the plain kernel.
+* 10/19/2026
+*****************************************************************************************/
+static WAVE_KERNEL waveKernelSelect(WAVE_T wave, const WAVE_STATE *ws){
+    WAVE_KERNEL kernel;
+    if((ws->scale == 0) && (wave != WAVE_ARB)){
+        kernel = waveFlat;
+    }else if(ws->dither_mask == 0){
+        kernel = wavePlainKernels[wave];
+    }else{
+        kernel = waveKernels[wave];
+    }
+    return kernel;
+}
 
 /*****************************************************************************************
 * Init function - creates task and Mutex.
@@ -49,6 +422,7 @@ static void sineGenTask(void *p_arg);
 *****************************************************************************************/
 void SineGenInit(void){
     OS_ERR os_err;
+    DAC_CAL cal;
     OSTaskCreate(&sineGenTaskTCB,
                 "sineGen Task ",
                 sineGenTask,
@@ -57,13 +431,38 @@ void SineGenInit(void){
                 &sineGenTaskTaskStk[0],
                 (APP_CFG_SINEGEN_TASK_STK_SIZE / 10u),
                 APP_CFG_SINEGEN_TASK_STK_SIZE,
-                0,
+                DMA_BLOCK_Q_SIZE,                   /* Released DMA blocks */
                 0,
                 (void *) 0,
-                (OS_OPT_TASK_NONE),
+                (OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
                 &os_err);
 
     OSMutexCreate(&sineMutexKey,"Sine Mutex", &os_err);
+    OSMutexCreate(&mtMutexKey,"Multitone Mutex", &os_err);
+    sineCurrentSpecs.wave = WAVE_SINE;
+    sineCurrentSpecs.duty = DUTY_DEFAULT;
+    sineCurrentSpecs.mod.type = MOD_OFF;
+    sineCurrentSpecs.burst.mode = BURST_OFF;
+    sineCurrentSpecs.dual.on = FALSE;
+    sineCurrentSpecs.dual.wave = WAVE_SINE;
+    sineCurrentSpecs.rate = SAMPLE_RATE_AUTO;
+    sineCurrentSpecs.dither = DITHER_OFF;
+    sineCurrentSpecs.cal_drive = SINE_CAL_OFF;
+    sineLoad.budget = (SYSTEM_CLOCK / DMA_FS_DEFAULT) * SAMPLES_PER_BLOCK;
+#if (APP_CFG_SINE_LOAD_EN == DEF_ENABLED)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    cal.gain = DAC_CAL_GAIN_ONE;                    /* Ideal until SineCalSet() */
+    cal.offset = 0;
+    for(INT8U k = 0; k <= SINE_LEVEL_MAX; k++){
+        cal.trim[k] = 0;
+    }
+    SineCalSet(&cal);
+    mtPlay.seq = 0xFF;
+    (void)MultitoneSet(mtDefault, 2, TRUE);
+    DMASetConsumer(&sineGenTaskTCB);
 }
 /*****************************************************************************************
 * Public setter function to set frequency
@@ -81,6 +480,10 @@ void SinewaveSetFreq(INT16U freq){
 *****************************************************************************************/
 void SinewaveSetLevel(INT8U level){
     OS_ERR os_err;
+    if(level > SINE_LEVEL_MAX){
+        level = SINE_LEVEL_MAX;
+    }else{
+    }
     OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
     sineCurrentSpecs.level = level;
     OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
@@ -109,45 +512,1286 @@ INT8U SinewaveGetLevel(void){
     OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
     return level;
 }
+/*****************************************************************************************
+* WaveformSetType - Selects the DAC waveform, out of range selects sine
+* 10/19/2026
+*****************************************************************************************/
+void WaveformSetType(WAVE_T wave){
+    OS_ERR os_err;
+    if(wave >= WAVE_NUM){
+        wave = WAVE_SINE;
+    }else{
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.wave = wave;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* WaveformGetType
+* 10/19/2026
+*****************************************************************************************/
+WAVE_T WaveformGetType(void){
+    WAVE_T wave;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    wave = sineCurrentSpecs.wave;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return wave;
+}
+/*****************************************************************************************
+* WaveformSetDuty - Square wave duty in percent, held in 1-99
+* 10/19/2026
+*****************************************************************************************/
+void WaveformSetDuty(INT8U duty){
+    OS_ERR os_err;
+    if(duty < DUTY_MIN){
+        duty = DUTY_MIN;
+    }else if(duty > DUTY_MAX){
+        duty = DUTY_MAX;
+    }else{
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.duty = duty;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* WaveformGetDuty
+* 10/19/2026
+*****************************************************************************************/
+INT8U WaveformGetDuty(void){
+    INT8U duty;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    duty = sineCurrentSpecs.duty;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return duty;
+}
+/*****************************************************************************************
+* SweepStart - Starts a sweep of the sine output at the next block
+* 10/19/2026
+*****************************************************************************************/
+void SweepStart(const SWEEP_CFG *cfg){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.sweep = *cfg;
+    if(sineCurrentSpecs.sweep.duration_ms < SWEEP_MIN_MS){
+        sineCurrentSpecs.sweep.duration_ms = SWEEP_MIN_MS;
+    }else{
+    }
+    sineCurrentSpecs.sweep_on = TRUE;
+    sineCurrentSpecs.sweep_req = TRUE;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SweepStop - Ends a sweep, the output goes back to the set frequency
+* 10/19/2026
+*****************************************************************************************/
+void SweepStop(void){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.sweep_on = FALSE;
+    sineCurrentSpecs.sweep_req = TRUE;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SweepIsActive - TRUE from SweepStart() until SweepStop()
+* A finished one-shot stays active, holding the stop frequency.
+* 10/19/2026
+*****************************************************************************************/
+INT8U SweepIsActive(void){
+    INT8U on;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    on = sineCurrentSpecs.sweep_on;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return on;
+}
+/*****************************************************************************************
+* ModulationSet - Sets the sine modulation, out of range values are held at their limit
+* 10/19/2026
+*****************************************************************************************/
+void ModulationSet(const MOD_CFG *cfg){
+    MOD_CFG mod = *cfg;
+    OS_ERR os_err;
+    if(mod.type >= MOD_NUM){
+        mod.type = MOD_OFF;
+    }else{
+    }
+    if(mod.rate_dhz > MOD_RATE_MAX){
+        mod.rate_dhz = MOD_RATE_MAX;
+    }else{
+    }
+    if((mod.type == MOD_AM) && (mod.depth > MOD_AM_MAX)){
+        mod.depth = MOD_AM_MAX;
+    }else if((mod.type == MOD_PM) && (mod.depth > MOD_PM_MAX)){
+        mod.depth = MOD_PM_MAX;
+    }else{
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.mod = mod;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* ModulationGet
+* 10/19/2026
+*****************************************************************************************/
+void ModulationGet(MOD_CFG *cfg){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    *cfg = sineCurrentSpecs.mod;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SineGenGetLoad - Copies the block cycle counts
+* 10/19/2026
+*****************************************************************************************/
+void SineGenGetLoad(SINE_LOAD *load){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *load = sineLoad;
+    CPU_CRITICAL_EXIT();
+}
+/*****************************************************************************************
+* BurstSet - Sets the burst mode, see SineGeneration.h
+* 10/19/2026
+*****************************************************************************************/
+void BurstSet(const BURST_CFG *cfg){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.burst = *cfg;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* BurstGet
+* 10/19/2026
+*****************************************************************************************/
+void BurstGet(BURST_CFG *cfg){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    *cfg = sineCurrentSpecs.burst;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* DualSet - Sets the DAC1 output, see SineGeneration.h
+* 10/19/2026
+*****************************************************************************************/
+void DualSet(const DUAL_CFG *cfg){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.dual = *cfg;
+    if(cfg->wave > WAVE_SQUARE){                    /* Kernels run from the phase only */
+        sineCurrentSpecs.dual.wave = WAVE_SINE;
+    }else{
+    }
+    sineCurrentSpecs.dual.phase_deg = cfg->phase_deg % 360;
+    if(cfg->level > SINE_LEVEL_MAX){
+        sineCurrentSpecs.dual.level = SINE_LEVEL_MAX;
+    }else{
+    }
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* DualGet
+* 10/19/2026
+*****************************************************************************************/
+void DualGet(DUAL_CFG *cfg){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    *cfg = sineCurrentSpecs.dual;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SampleRateSet - SAMPLE_RATE_AUTO, or a fixed rate rounded up to one of sineRates[]
+* 10/19/2026
+*****************************************************************************************/
+void SampleRateSet(INT32U fs){
+    OS_ERR os_err;
+    if(fs != SAMPLE_RATE_AUTO){
+        fs = sineRateRound(fs);
+    }else{
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.rate = fs;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* DitherSet - Out of range is off
+* 10/19/2026
+*****************************************************************************************/
+void DitherSet(DITHER_MODE mode){
+    OS_ERR os_err;
+    if(mode >= DITHER_NUM){
+        mode = DITHER_OFF;
+    }else{
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.dither = mode;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* DitherGet
+* 10/19/2026
+*****************************************************************************************/
+DITHER_MODE DitherGet(void){
+    DITHER_MODE mode;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    mode = sineCurrentSpecs.dither;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return mode;
+}
+/*****************************************************************************************
+* SineCalSet - Folds the calibration into the scale of each level and the midpoint.
+* The gain is held to 0.9-1.1 and the offset to +-CAL_OFFSET_MAX codes. A scale past
+* SINE_SCALE_MAX is held there, the top levels clip first.
+* 10/19/2026
+*****************************************************************************************/
+void SineCalSet(const DAC_CAL *cal){
+    OS_ERR os_err;
+    INT32S scale[SINE_LEVEL_MAX + 1];
+    INT64S s;
+    INT32S gain = cal->gain;
+    INT32S offset = cal->offset;
+    if(gain < CAL_GAIN_MIN){
+        gain = CAL_GAIN_MIN;
+    }else if(gain > CAL_GAIN_MAX){
+        gain = CAL_GAIN_MAX;
+    }else{
+    }
+    if(offset < -CAL_OFFSET_MAX){
+        offset = -CAL_OFFSET_MAX;
+    }else if(offset > CAL_OFFSET_MAX){
+        offset = CAL_OFFSET_MAX;
+    }else{
+    }
+    for(INT8U l = 0; l <= SINE_LEVEL_MAX; l++){
+        s = ((INT64S)AMP_SCALE * l * gain * (CAL_TRIM_DIV + cal->trim[l]) +
+             ((DAC_CAL_GAIN_ONE * CAL_TRIM_DIV) / 2)) / (DAC_CAL_GAIN_ONE * CAL_TRIM_DIV);
+        if(s > SINE_SCALE_MAX){
+            s = SINE_SCALE_MAX;
+        }else{
+        }
+        scale[l] = (INT32S)s;
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCal.cal = *cal;
+    sineCal.cal.gain = (INT16U)gain;
+    sineCal.cal.offset = (INT16S)offset;
+    for(INT8U l = 0; l <= SINE_LEVEL_MAX; l++){
+        sineCal.scale[l] = scale[l];
+    }
+    sineCal.dc = DC_OFF + offset;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SineCalGet - The calibration in use, limits applied
+* 10/19/2026
+*****************************************************************************************/
+void SineCalGet(DAC_CAL *cal){
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    *cal = sineCal.cal;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SineCalDrive - Holds DAC0 at a raw code from the next block, SINE_CAL_OFF releases it
+* 10/19/2026
+*****************************************************************************************/
+void SineCalDrive(INT16U code){
+    OS_ERR os_err;
+    if((code != SINE_CAL_OFF) && (code >= DAC_CODES)){
+        code = DAC_CODES - 1;
+    }else{
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    sineCurrentSpecs.cal_drive = code;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+}
+/*****************************************************************************************
+* SineCalCompute - Gain and offset from the two measured points
+* With k the measured mV per code, the gain is the ideal CAL_VREF_MV/DAC_CODES over k.
+* The offset is the codes from DC_OFF to where the measured line crosses the ideal
+* midpoint voltage. Both are rounded, the products are 64-bit.
+* 10/19/2026
+*****************************************************************************************/
+INT8U SineCalCompute(INT16U mv_lo, INT16U mv_hi, DAC_CAL *cal){
+    INT64S den;
+    INT64S gain;
+    INT64S offset;
+    INT8U valid = FALSE;
+    if(mv_hi > mv_lo){
+        den = (INT64S)DAC_CODES * (mv_hi - mv_lo);
+        gain = ((INT64S)DAC_CAL_GAIN_ONE * CAL_VREF_MV * (SINE_CAL_CODE_HI - SINE_CAL_CODE_LO) +
+                (den / 2)) / den;
+        offset = ((INT64S)DC_OFF * CAL_VREF_MV - (INT64S)mv_lo * DAC_CODES) *
+                 (SINE_CAL_CODE_HI - SINE_CAL_CODE_LO);
+        if(offset >= 0){
+            offset = (offset + (den / 2)) / den;
+        }else{
+            offset = (offset - (den / 2)) / den;
+        }
+        offset -= DC_OFF - SINE_CAL_CODE_LO;
+        if((gain >= CAL_GAIN_MIN) && (gain <= CAL_GAIN_MAX) &&
+           (offset >= -CAL_OFFSET_MAX) && (offset <= CAL_OFFSET_MAX)){
+            cal->gain = (INT16U)gain;
+            cal->offset = (INT16S)offset;
+            valid = TRUE;
+        }else{
+        }
+    }else{
+    }
+    return valid;
+}
+/*****************************************************************************************
+* SampleRateGet - The rate playing now
+* 10/19/2026
+*****************************************************************************************/
+INT32U SampleRateGet(void){
+    return DMAGetSampleRate();
+}
+/*****************************************************************************************
+* sineRateRound - Lowest of sineRates[] at or above fs, the highest past the end
+* 10/19/2026
+*****************************************************************************************/
+static INT32U sineRateRound(INT32U fs){
+    INT8U k = 0;
+    while((k < (SINE_RATE_NUM - 1)) && (sineRates[k] < fs)){
+        k++;
+    }
+    return sineRates[k];
+}
+/*****************************************************************************************
+* sineRateSelect - Sample rate for the specs, see SampleRateSet()
+* The highest frequency is the sweep end for a sweep, the carrier plus the deviation
+* for FM and the highest tone for multitone. Multitone is held to the highest rate its
+* tones fill in half the core, MT_TONE_RATE over the count, below which the tones under
+* half the rate still play. The choice only changes with the settings, so a sweep runs
+* at one rate from start to end.
+* 10/19/2026
+*****************************************************************************************/
+static INT32U sineRateSelect(const SINE_SPECS *specs, INT16U arb_len){
+    INT32U top = specs->frequency;
+    INT32U fs_min = DMA_FS_MIN;
+    INT32U fs;
+    INT8U k;
+
+    if(specs->rate != SAMPLE_RATE_AUTO){
+        return specs->rate;
+    }else{
+    }
+    if((specs->wave == WAVE_WHITE) || (specs->wave == WAVE_PINK)){
+        return NOISE_FS;
+    }else{
+    }
+    if((specs->wave == WAVE_ARB) && (specs->burst.mode == BURST_OFF)){
+        for(k = 0; k < SINE_RATE_NUM; k++){         /* Native rate, the DMA plays the table */
+            if(((INT32U)arb_len * specs->frequency) == sineRates[k]){
+                return sineRates[k];
+            }else{
+            }
+        }
+    }else if(specs->wave == WAVE_MULTI){
+        top = 0;
+        for(k = 0; k < mtPlay.count; k++){
+            if(mtPlay.freq[k] > top){
+                top = mtPlay.freq[k];
+            }else{
+            }
+        }
+    }else if((specs->wave == WAVE_SINE) && specs->sweep_on){
+        top = (specs->sweep.start_hz > specs->sweep.stop_hz) ? specs->sweep.start_hz
+                                                             : specs->sweep.stop_hz;
+        fs_min = SWEEP_MIN_FS;
+    }else if((specs->wave == WAVE_SINE) && (specs->mod.type == MOD_FM)){
+        top += specs->mod.depth;
+    }else{
+    }
+    fs = sineRateRound(top * SAMPLE_RATE_OVERSAMPLE);
+    if(fs < fs_min){
+        fs = sineRateRound(fs_min);
+    }else{
+    }
+    if((specs->wave == WAVE_MULTI) && (mtPlay.count != 0)){
+        k = SINE_RATE_NUM - 1;
+        while((k > 0) && (sineRates[k] > (MT_TONE_RATE / mtPlay.count))){
+            k--;
+        }
+        if(fs > sineRates[k]){
+            fs = sineRates[k];
+        }else{
+        }
+    }else{
+    }
+    return fs;
+}
+/*****************************************************************************************
+* BurstTrigger - Software trigger, the start itself is made by the DMA module
+* 10/19/2026
+*****************************************************************************************/
+void BurstTrigger(void){
+    if(DMABurstBusy()){
+        DMABurstGateClose();                        /* Ends a gated burst, no effect otherwise */
+    }else{
+        DMABurstFire();
+    }
+}
+/*****************************************************************************************
+* sineBurstUpdate - Renders and arms the burst when its settings changed
+* Called with the rest loop playing. The buffer is not touched while a burst plays, the
+* settings are picked up after it.
+* 10/19/2026
+*****************************************************************************************/
+static void sineBurstUpdate(const SINE_SPECS *specs, WAVE_STATE *ws, BURST_STATE *bs){
+    INT8U dirty;
+    dirty = !bs->armed || (mtPlay.seq != bs->mt_seq) ||
+            (specs->frequency != bs->specs.frequency) || (specs->level != bs->specs.level) ||
+            (specs->wave != bs->specs.wave) || (specs->duty != bs->specs.duty) ||
+            (specs->burst.mode != bs->specs.burst.mode) ||
+            (specs->burst.cycles != bs->specs.burst.cycles) ||
+            (specs->burst.triggers != bs->specs.burst.triggers) ||
+            (specs->burst.period_ms != bs->specs.burst.period_ms) || (ws->fs != bs->fs);
+    if(dirty && !DMABurstBusy()){
+        DMABurstDisarm();
+        bs->armed = DMABurstArm(burstBuf, sineBurstRender(specs, ws),
+                                (specs->burst.mode == BURST_GATED));
+        if(bs->armed){
+            DMABurstSetTrigger(specs->burst.triggers, specs->burst.period_ms);
+            bs->specs = *specs;
+            bs->fs = ws->fs;
+            bs->mt_seq = mtPlay.seq;
+        }else{
+        }
+    }else{
+    }
+}
+/*****************************************************************************************
+* sineBurstRender - Runs the waveform kernel into burstBuf from phase 0
+* The length is the cycles rounded to whole samples, and the increment is set from the
+* length so the burst is exactly that many cycles.
+* 10/19/2026
+*****************************************************************************************/
+static INT16U sineBurstRender(const SINE_SPECS *specs, WAVE_STATE *ws){
+    INT32U cycles = specs->burst.cycles;
+    INT32U freq = specs->frequency;
+    INT32U max_cycles;
+    INT32U len;
+    INT32U n;
+    WAVE_KERNEL kernel;
+
+    if(freq == 0){
+        freq = 1;
+    }else{
+    }
+    max_cycles = (BURST_MAX_SAMPLES * freq) / ws->fs;
+    if(cycles > max_cycles){
+        cycles = max_cycles;
+    }else{
+    }
+    if(cycles == 0){
+        cycles = 1;
+    }else{
+    }
+    len = (INT32U)((((INT64U)cycles * ws->fs * 2) + freq) / (2 * freq));
+    if(len > BURST_MAX_SAMPLES){                    /* Under 6Hz, the cycle is stretched to fit */
+        len = BURST_MAX_SAMPLES;
+    }else if(len <= cycles){
+        len = cycles + 1;
+    }else{
+    }
+    ws->inc = (INT32U)(((INT64U)cycles << 32) / len);
+    ws->recip = ((INT64U)1 << 62) / ws->inc;
+    ws->phase = 0;
+    kernel = waveKernelSelect(specs->wave, ws);
+    for(INT32U pos = 0; pos < len; pos += n){
+        kernel(sine_vals, ws);
+        n = len - pos;
+        if(n > SAMPLES_PER_BLOCK){
+            n = SAMPLES_PER_BLOCK;
+        }else{
+        }
+        for(INT32U i = 0; i < n; i++){
+            burstBuf[pos + i] = sine_vals[i];
+        }
+    }
+    ws->phase = 0;
+    return (INT16U)len;
+}
+/*****************************************************************************************
+* MultitoneSet - Sets the multitone tones, see SineGeneration.h
+* Schroeder phases for powers p_l = a_l^2/sum(a^2) are
+*   phase_n = -sum(l<n) (n-l)*p_l turns
+* which is integer math with the weights up to MT_AMP_MAX.
+* The tones are then run for MT_PEAK_SAMPLES with raw amplitudes and scaled to put the
+* peak at MT_FULL. The peak is held at no less than the RMS of the tones, at least the
+* amplitude sum over sqrt(2*count), for tones too slow to peak in the run. The scaled
+* amplitudes then sum to at most sqrt(32)*MT_FULL, so the kernel's partial sums stay in
+* 31 bits. The kernel saturates any peak not seen here. The peak is found at MT_PEAK_FS, it hardly moves with the rate.
+* 10/19/2026
+*****************************************************************************************/
+INT8U MultitoneSet(const MT_TONE *tones, INT8U count, INT8U schroeder){
+    INT64U power = 0;
+    INT64U sum;
+    INT32S bound = 0;
+    INT32S floor_pk;
+    INT32S peak;
+    INT8U k;
+    INT8U l;
+    OS_ERR os_err;
+
+    if((count == 0) || (count > MT_MAX_TONES)){
+        return FALSE;
+    }else{
+    }
+    OSMutexPend(&mtMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    for(k = 0; k < count; k++){
+        power += (INT64U)tones[k].amp * tones[k].amp;
+    }
+    for(k = 0; k < count; k++){
+        mtNew.freq[k] = tones[k].freq;              /* Checked against each rate, mtSetRate() */
+        if(tones[k].amp <= MT_AMP_MAX){
+            mtNew.amp[k] = (INT32S)tones[k].amp * MT_AMP_RAW;
+        }else{
+            mtNew.amp[k] = MT_AMP_MAX * MT_AMP_RAW;
+        }
+        if(schroeder && (power != 0)){
+            sum = 0;
+            for(l = 0; l < k; l++){
+                sum += (INT64U)(k - l) * tones[l].amp * tones[l].amp;
+            }
+            mtNew.phase[k] = 0U - (INT32U)((sum << 32) / power);
+        }else{
+            mtNew.phase[k] = (INT32U)(((INT64U)tones[k].phase_deg << 32) / 360);
+        }
+    }
+    mtNew.count = count;
+    mtSetRate(&mtNew, MT_PEAK_FS);
+    for(k = 0; k < count; k++){
+        bound += mtNew.amp[k] * LFO_FULL;
+    }
+    peak = mtPeak(&mtNew);
+    floor_pk = (INT32S)(bound / sqrt(2.0 * count));
+    if(peak < floor_pk){
+        peak = floor_pk;
+    }else{
+    }
+    for(k = 0; k < count; k++){
+        if(peak != 0){
+            mtNew.amp[k] = (INT32S)(((INT64S)mtNew.amp[k] * MT_FULL) / peak);
+        }else{
+            mtNew.amp[k] = 0;
+        }
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    mtNew.seq = mtSet.seq + 1;
+    mtSet = mtNew;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    OSMutexPost(&mtMutexKey, OS_OPT_POST_NONE, &os_err);
+    return TRUE;
+}
+/*****************************************************************************************
+* mtSetRate - Phase steps of the tones at fs. Tones at or over fs/2, and 0Hz, get no
+* step and are left out of the sum, see waveMulti() and mtPeak().
+* 10/19/2026
+*****************************************************************************************/
+static void mtSetRate(MT_TONES *mt, INT32U fs){
+    for(INT8U k = 0; k < mt->count; k++){
+        if(mt->freq[k] < (fs / 2)){
+            mt->inc[k] = (INT32U)(((INT64U)mt->freq[k] << 32) / fs);
+        }else{
+            mt->inc[k] = 0;
+        }
+    }
+}
+/*****************************************************************************************
+* mtPeak - Largest magnitude of the raw tone sum over MT_PEAK_SAMPLES from the start
+* phases. Raw sums are at most 16*32767*4000, in 31 bits. Tones with no step are left out.
+* 10/19/2026
+*****************************************************************************************/
+static INT32S mtPeak(MT_TONES *mt){
+    INT32S peak = 0;
+    INT32S acc;
+    INT32U p[MT_MAX_TONES];
+    INT8U k;
+
+    for(k = 0; k < mt->count; k++){
+        p[k] = mt->phase[k];
+    }
+    for(INT16U i=0; i<MT_PEAK_SAMPLES; i++){
+        acc = 0;
+        for(k = 0; k < mt->count; k++){
+            if(mt->inc[k] != 0){
+                acc += (arm_sin_q31((q31_t)(p[k] >> 1)) >> 16) * mt->amp[k];
+                p[k] += mt->inc[k];
+            }else{
+            }
+        }
+        if(acc < 0){
+            acc = -acc;
+        }else{
+        }
+        if(acc > peak){
+            peak = acc;
+        }else{
+        }
+    }
+    return peak;
+}
+/*****************************************************************************************
+* waveMulti - Multitone kernel
+* Runs a tone at a time over the block into mtAcc, so each tone's phase, increment and
+* amplitude stay in registers for its loop. The Q28 sum is saturated to +-1, scaled
+* like the other kernels and saturated to the 12-bit DAC range. A tone with no step at
+* this rate is skipped, held still it would be a DC offset.
+* 10/19/2026
+*****************************************************************************************/
+static void waveMulti(INT16U *out, WAVE_STATE *ws){
+    const INT32S scale = ws->scale;
+    const INT32S dc = ws->dc;
+    INT32U p;
+    INT32U inc;
+    INT32S a;
+    INT8U k;
+
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+        mtAcc[i] = 0;
+    }
+    for(k = 0; k < mtPlay.count; k++){
+        p = mtPlay.phase[k];
+        inc = mtPlay.inc[k];
+        a = mtPlay.amp[k];
+        if(inc != 0){
+            for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+                mtAcc[i] += (arm_sin_q31((q31_t)(p >> 1)) >> 16) * a;
+                p += inc;
+            }
+        }else{
+        }
+        mtPlay.phase[k] = p;
+    }
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+        a = __SSAT(mtAcc[i], MT_SUM_MAX);
+        out[i] = (INT16U)__USAT(dc + ((((a >> 12) * scale) + BIT19_MASK) >> 20), MT_DAC_MAX);
+    }
+}
+/*****************************************************************************************
+* Noise kernels
+* xorshift32 gives 32 random bits per step, split into two signed Q15 values, so one
+* step covers two white samples, or one pink sample's row update and white row.
+* Samples are Q28 with the sine peak at 2^28 and its RMS matched by the gain. Noise
+* peaks run past the sine peak, so the Q28 value leaves three bits of headroom and
+* NOISE_OUT() converts with 13 bits of it, then saturates to the DAC range.
+* Uniform white noise peaks at 1.22 times the sine peak and clips at the top levels.
+* 10/19/2026
+*****************************************************************************************/
+#define NOISE_STEP(x)   ((x) ^= (x) << 13, (x) ^= (x) >> 17, (x) ^= (x) << 5)
+#define NOISE_OUT(s, scale, dc)                                                 \
+    ((INT16U)__USAT((dc) + (((((s) >> 15) * (scale)) + BIT16_MASK) >> 17), MT_DAC_MAX))
+
+static void waveWhite(INT16U *out, WAVE_STATE *ws){
+    INT32U x = ws->noise->x;
+    const INT32S scale = ws->scale;
+    const INT32S dc = ws->dc;
+
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i+=2){
+        NOISE_STEP(x);
+        out[i] = NOISE_OUT((INT32S)(INT16S)x * NOISE_WHITE_GAIN, scale, dc);
+        out[i + 1] = NOISE_OUT(((INT32S)x >> 16) * NOISE_WHITE_GAIN, scale, dc);
+    }
+    ws->noise->x = x;
+}
+/*****************************************************************************************
+* wavePink - Voss-McCartney pink noise
+* Sample n redraws the row given by the trailing zeros of n, so row k changes every
+* 2^(k+1) samples and each octave below fs/4 gets one row. The running sum is updated
+* by the change, and a white row is added per sample. 16 rows in all, sum of 16 Q15.
+* 10/19/2026
+*****************************************************************************************/
+static void wavePink(INT16U *out, WAVE_STATE *ws){
+    NOISE_STATE *ns = ws->noise;
+    INT32U x = ns->x;
+    INT32U n = ns->count;
+    INT32S sum = ns->sum;
+    const INT32S scale = ws->scale;
+    const INT32S dc = ws->dc;
+    INT32U k;
+    INT32S r;
+
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+        NOISE_STEP(x);
+        n++;
+        k = __CLZ(__RBIT(n));                       /* Trailing zeros, 32 for n = 0 */
+        if(k < PINK_ROWS){
+            r = (INT32S)(INT16S)x;
+            sum += r - ns->row[k];
+            ns->row[k] = r;
+        }else{
+        }
+        out[i] = NOISE_OUT((sum + ((INT32S)x >> 16)) * NOISE_PINK_GAIN, scale, dc);
+    }
+    ns->x = x;
+    ns->count = n;
+    ns->sum = sum;
+}
+/*****************************************************************************************
+* modSetup - Modulation constants for a block, from the current increment and scale
+* The divides are here, once per block, so the kernel only multiplies and shifts.
+* The LFO phase, AM scale and PM offset carry over so the output has no steps.
+* 10/19/2026
+*****************************************************************************************/
+static void modSetup(MOD_STATE *ms, const MOD_CFG *cfg, WAVE_STATE *ws){
+    if((cfg->type == MOD_AM) && (ms->type != MOD_AM)){
+        ms->scale = ws->scale;                      /* Ramp from the unmodulated level */
+    }else{
+    }
+    if(cfg->type != MOD_PM){                        /* Leaving PM, keep the phase */
+        ws->phase += ms->off;
+        ms->off = 0;
+    }else{
+    }
+    ms->type = cfg->type;
+    ms->shape = cfg->shape;
+    ms->lfo_inc = (INT32U)((((INT64U)cfg->rate_dhz << 32) / ((INT64U)ws->fs * 10)) << MOD_CTRL_SHIFT);
+    if(ms->type == MOD_AM){
+        ms->am_depth = ((INT32S)cfg->depth * BIT15_MASK) / MOD_AM_MAX;
+        ms->am_scale = (ws->scale * MOD_AM_MAX) / (MOD_AM_MAX + cfg->depth);
+        ms->dev = 0;
+    }else if(ms->type == MOD_FM){
+        ms->dev = (INT64S)(((INT64U)cfg->depth << 32) / ws->fs);
+        if(ms->dev > (INT64S)ws->inc){              /* Deviation up to the carrier */
+            ms->dev = (INT64S)ws->inc;
+        }else{
+        }
+        ms->scale = ws->scale;
+    }else if(ms->type == MOD_PM){
+        ms->dev = (INT64S)(((INT64U)cfg->depth << 32) / 360);
+        ms->scale = ws->scale;
+    }else{
+        ms->dev = 0;
+        ms->scale = ws->scale;
+    }
+}
+/*****************************************************************************************
+* lfoValue - LFO sample at phase q, Q15
+* 10/19/2026
+*****************************************************************************************/
+static INT32S lfoValue(LFO_SHAPE shape, INT32U q){
+    INT32S m;
+    if(shape == LFO_SQUARE){
+        m = (q < BIT31_MASK) ? LFO_FULL : -LFO_FULL;
+    }else if(shape == LFO_TRIANGLE){                /* Same fold as waveTriangle */
+        q += BIT30_MASK;
+        q ^= (INT32U)((INT32S)q >> 31);
+        m = ((INT32S)q - BIT30_MASK) >> 15;
+    }else{
+        m = arm_sin_q31((q31_t)(q >> 1)) >> 16;
+    }
+    return m;
+}
+/*****************************************************************************************
+* waveSineMod - Modulated sine kernel
+* Each control step evaluates the LFO once and sets the per sample steps:
+*   AM  scale ramps to am_scale*(1 + depth*m)
+*   FM  increment is inc + dev*m for the step
+*   PM  phase offset ramps to dev*m
+* The ramps are the difference over MOD_CTRL_LEN, a shift. There are no per sample
+* divides or calls other than the sine.
+* 10/19/2026
+*****************************************************************************************/
+static void waveSineMod(INT16U *out, WAVE_STATE *ws){
+    MOD_STATE *ms = ws->mod;
+    INT32U p = ws->phase;
+    INT32U inc = ws->inc;
+    INT32S scale = ms->scale;
+    INT32S dscale = 0;
+    const INT32S dc = ws->dc;
+    INT32U off = ms->off;
+    INT32S doff = 0;
+    INT32S m;
+    INT32S s;
+
+    for(INT16U k=0; k<SAMPLES_PER_BLOCK; k+=MOD_CTRL_LEN){
+        m = lfoValue(ms->shape, ms->lfo_phase);
+        ms->lfo_phase += ms->lfo_inc;
+        if(ms->type == MOD_AM){
+            dscale = (((ms->am_scale * (BIT15_MASK + ((ms->am_depth * m) >> 15))) >> 15) - scale)
+                     >> MOD_CTRL_SHIFT;
+        }else if(ms->type == MOD_FM){
+            inc = ws->inc + (INT32U)(INT32S)((ms->dev * m) >> 15);
+        }else{
+            doff = (INT32S)((((ms->dev * m) >> 15) - (INT32S)off) >> MOD_CTRL_SHIFT);
+        }
+        for(INT16U i=k; i<(k + MOD_CTRL_LEN); i++){
+            s = arm_sin_q31((q31_t)((p + off) >> 1)) >> 1;
+            out[i] = (INT16U)__USAT(dc + ((((s >> 14) * scale) + BIT19_MASK) >> 20), DAC_BITS);
+            p += inc;
+            scale += dscale;
+            off += (INT32U)doff;
+        }
+    }
+    ws->phase = p;
+    ms->scale = scale;
+    ms->off = off;
+}
+/*****************************************************************************************
+* sweepSetup - Calculates the per sample steps of a sweep, once per SweepStart()
+* Increments are frequency/fs as a Q32.32 fraction of a turn. The log rate is
+* (stop/start)^(1/N) - 1 for N samples, from expm1() so it keeps its precision.
+* The double precision math runs once here, never per sample.
+* 10/19/2026
+*****************************************************************************************/
+static void sweepSetup(SWEEP_STATE *sw, const SWEEP_CFG *cfg, INT32U fs){
+    INT32U n;
+    double ln_ratio;
 
+    n = (INT32U)(((INT64U)cfg->duration_ms * fs) / 1000);
+    sw->inc_start = (INT64U)(((double)cfg->start_hz / fs) * 18446744073709551616.0);
+    sw->inc_stop = (INT64U)(((double)cfg->stop_hz / fs) * 18446744073709551616.0);
+    if((cfg->law == SWEEP_LOG) && (cfg->start_hz != 0) && (cfg->stop_hz != 0)){
+        ln_ratio = log((double)cfg->stop_hz / cfg->start_hz) / n;
+        sw->rate_up = (INT32S)llround(expm1(ln_ratio) * 4294967296.0);
+        sw->rate_dn = (INT32S)llround(expm1(-ln_ratio) * 4294967296.0);
+        sw->dinc_up = 0;
+        sw->dinc_dn = 0;
+    }else{
+        sw->dinc_up = ((INT64S)sw->inc_stop - (INT64S)sw->inc_start) / (INT64S)n;
+        sw->dinc_dn = -sw->dinc_up;
+        sw->rate_up = 0;
+        sw->rate_dn = 0;
+    }
+    sw->seg_len = n;
+    sw->remaining = n;
+    sw->mode = cfg->mode;
+    sw->inc = sw->inc_start;
+    sw->dinc = sw->dinc_up;
+    sw->rate = sw->rate_up;
+    sw->up = TRUE;
+    sw->active = TRUE;
+    sw->marker = TRUE;
+    sw->mark_offset = 0;                            /* Marker set at the first sample */
+}
+/*****************************************************************************************
+* sweepBoundary - End of a sweep segment, sample is where the next one starts in the block
+* The increment is snapped to the exact end value, so rounding in the per sample
+* steps does not build up over repeats.
+* 10/19/2026
+*****************************************************************************************/
+static void sweepBoundary(SWEEP_STATE *sw, INT16U sample){
+    if(sw->mode == SWEEP_UPDOWN){
+        sw->up = !sw->up;
+        sw->inc = sw->up ? sw->inc_start : sw->inc_stop;
+        sw->dinc = sw->up ? sw->dinc_up : sw->dinc_dn;
+        sw->rate = sw->up ? sw->rate_up : sw->rate_dn;
+        sw->remaining = sw->seg_len;
+    }else if(sw->mode == SWEEP_REPEAT){
+        sw->inc = sw->inc_start;
+        sw->remaining = sw->seg_len;
+    }else{                                          /* One-shot, hold the stop frequency */
+        sw->inc = sw->inc_stop;
+        sw->dinc = 0;
+        sw->rate = 0;
+        sw->remaining = 0xFFFFFFFFU;
+    }
+    sw->marker = !sw->marker;
+    sw->mark_offset = sample;
+}
+/*****************************************************************************************
+* AwgLoadBegin - Starts loading length samples to the staging table
+* 10/19/2026
+*****************************************************************************************/
+INT8U AwgLoadBegin(INT16U length){
+    INT8U started = FALSE;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    if((awg.swap == FALSE) && (length != 0) && (length <= AWG_MAX_SAMPLES)){
+        awg.length[awg.active ^ 1] = length;
+        awg.load_pos = 0;
+        awg.loading = TRUE;
+        started = TRUE;
+    }else{
+    }
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return started;
+}
+/*****************************************************************************************
+* AwgLoadChunk - Appends samples to the staging table, masked to 12 bits
+* The staging table is not read until committed, so it is copied outside the mutex.
+* 10/19/2026
+*****************************************************************************************/
+INT16U AwgLoadChunk(const INT16U *samples, INT16U count){
+    INT16U *dst;
+    INT16U pos;
+    INT16U len;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    if(awg.loading){
+        dst = awg.table[awg.active ^ 1];
+        pos = awg.load_pos;
+        len = awg.length[awg.active ^ 1];
+    }else{
+        dst = (INT16U *)0;
+        pos = 0;
+        len = 0;
+    }
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    if(count > (len - pos)){
+        count = len - pos;
+    }else{
+    }
+    for(INT16U i = 0; i < count; i++){
+        dst[pos + i] = samples[i] & 0x0FFF;
+    }
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    awg.load_pos = pos + count;
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return count;
+}
+/*****************************************************************************************
+* AwgLoadCommit - Marks a complete staging table to be swapped in at a period boundary
+* 10/19/2026
+*****************************************************************************************/
+INT8U AwgLoadCommit(void){
+    INT8U committed = FALSE;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    if(awg.loading && (awg.load_pos == awg.length[awg.active ^ 1])){
+        awg.loading = FALSE;
+        awg.swap = TRUE;
+        committed = TRUE;
+    }else{
+    }
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return committed;
+}
 /*****************************************************************************************
-* sineGenTask - This task waits for DMA to signal it to generate values, iteratively calls
-* arm_sin_q31(), scales and converts values to fit DAC0, then passes a pointer to the new
-* array of generated values back to DMA module
+* AwgGetLength - Length of the active table, 0 if none has been loaded
+* 10/19/2026
+*****************************************************************************************/
+INT16U AwgGetLength(void){
+    INT16U length;
+    OS_ERR os_err;
+    OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+    length = awg.length[awg.active];
+    OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+    return length;
+}
+/*****************************************************************************************
+* waveArb - Arbitrary waveform kernel
+* Table index is the phase scaled by the length, (p*len)>>32, so any length resamples
+* without a divide. A committed table is swapped in on the first sample of a period.
+* An empty table plays the DC midpoint.
+* 10/19/2026
+*****************************************************************************************/
+static void waveArb(INT16U *out, WAVE_STATE *ws){
+    INT32U p = ws->phase;
+    const INT32U inc = ws->inc;
+    const INT16U *tbl = ws->arb;
+    INT32U len = ws->arb_len;
+    if(len == 0){
+        tbl = awgDcTable;
+        len = 1;
+    }else{
+    }
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+        if((p < inc) && (ws->arb_next != (const INT16U *)0)){   /* Period boundary */
+            tbl = ws->arb_next;
+            len = ws->arb_next_len;
+            ws->arb_next = (const INT16U *)0;
+            ws->arb_swapped = TRUE;
+        }else{
+        }
+        out[i] = tbl[((INT64U)p * len) >> 32];
+        p += inc;
+    }
+    ws->phase = p;
+}
+/*****************************************************************************************
+* waveBlep - PolyBLEP correction for a unit step at phase 0, Q30
+* Within one sample of the step the naive waveform is smoothed by a two-sample
+* polynomial. With t the phase and dt the increment, both in turns:
+*   t < dt          x = t/dt     2x - x^2 - 1
+*   t > 1 - dt      y = (1-t)/dt (1-y)^2
+* The divisions use ws->recip = 2^62/inc, calculated once per block.
+* Only the samples next to the step take a branch with a multiply.
+* 10/19/2026
+*****************************************************************************************/
+static INT32S waveBlep(INT32U p, const WAVE_STATE *ws){
+    INT32S x;
+    INT32S b;
+    if(p < ws->inc){
+        x = (INT32S)(((INT64U)p * ws->recip) >> 32);                 /* t/dt, Q30 */
+        b = (2 * x) - (INT32S)(((INT64S)x * x) >> 30) - BIT30_MASK;
+    }else if((0U - p) <= ws->inc){
+        x = BIT30_MASK - (INT32S)(((INT64U)(0U - p) * ws->recip) >> 32);  /* 1-y, Q30 */
+        b = (INT32S)(((INT64S)x * x) >> 30);
+    }else{
+        b = 0;
+    }
+    return b;
+}
+
+/*****************************************************************************************
+* sineGenTask - This task waits for DMA to signal it to generate values, runs the kernel
+* of the current waveform, which scales and converts values to fit DAC0, then passes a
+* pointer to the new array of generated values back to DMA module
+* An arbitrary table at its native rate is handed to the DMA to loop. While it loops no
+* blocks are released, so the task polls for changes. Leaving the loop, both blocks are
+* filled before the DMA goes back to them.
 *
 * 03/03/2022 Aili Emory, Dominic Danis, Nick Coyle
+* 10/19/2026 Runs the waveform kernel from waveKernels[], phase is a full 32-bit turn
+* 10/19/2026 Arbitrary table swap and DMA loop mode
+* 10/19/2026 Sweeps, started and stopped at a block boundary
+* 10/19/2026 Modulation, and the cycle count from the DMA release to the end of the work
+* 10/19/2026 Bursts, the DMA loops a DC midpoint table between them
+* 10/19/2026 Dual output, each block is filled in the format the DMA released it in
+* 10/19/2026 Dither and error feedback settings per block, the errors carry over
+* 10/19/2026 Sample rate from the specs, changed with the first block made at the new rate.
+*            Loops start once the rate plays, the DMA changes it at once while looping.
+* 10/19/2026 Calibrated scales and midpoint per block, held codes for calibration
+* 10/19/2026 Specs and kernel state are the sine* statics, not locals, so the 1KiB stack
+*            is left to the calls and the sweep setup's doubles
 *****************************************************************************************/
 static void sineGenTask(void *p_arg){
-    INT32U sine_val;
-    INT32U argument = 0;
+#if (APP_CFG_SINE_LOAD_EN == DEF_ENABLED)
+    INT32U cycles;
+    CPU_SR_ALLOC();
+#endif
     INT8U index = 0;
-    INT16U frequency;
-    INT8U level;
+    DMA_BLOCK_INFO info;
     OS_ERR os_err;
+    OS_ERR pend_err;
+    OS_TICK tout = 0;
+    const INT16U *want;
+    INT16U want_len;
+    const INT16U *playing;
+    INT8U native;
+    INT8U mt_new;
+    INT32U fs;
     (void)p_arg;
 
+    sineWs.phase = 0;
+    sineWs.fs = DMA_FS_DEFAULT;
+    sineSweep.active = FALSE;
+    sineSweep.mark_offset = SWEEP_NO_MARK;
+    sineWs.sweep = &sineSweep;
+    sineMod.type = MOD_OFF;
+    sineMod.lfo_phase = 0;
+    sineMod.off = 0;
+    sineWs.mod = &sineMod;
+    sineNoise.x = NOISE_SEED;
+    sineNoise.count = 0;
+    sineNoise.sum = 0;
+    for(INT8U k = 0; k < PINK_ROWS; k++){
+        sineNoise.row[k] = 0;
+    }
+    sineWs.noise = &sineNoise;
+    sineDither.x = NOISE_SEED;
+    sineDither.r = 0;
+    sineDither.e1 = 0;
+    sineDither.e2 = 0;
+    sineWs.dither = &sineDither;
+    sineBurst.armed = FALSE;
     while(1) {
         DB4_TURN_OFF();                             /* Turn off debug bit while waiting */
-        index = DMAReadyPend(0, &os_err);           /* pend on the DMA */
+        index = DMAReadyPend(tout, &info, &pend_err);   /* pend on the DMA */
         DB4_TURN_ON();
-        frequency = SinewaveGetFreq();
-        level = SinewaveGetLevel();
-        for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
-            sine_val = arm_sin_q31(argument);
-            if((sine_val & BIT31_MASK) > 0){                  // value is negative
-                sine_val = (~sine_val & (~BIT31_MASK));       // drop the sign bit and invert
-                sine_val = ((sine_val + BIT15_MASK) >> 15);   // round down to 16 bits
-                sine_val = (sine_val) * (AMP_SCALE*level);    // 16bit*16bit = 32bit result
-                sine_val = ((sine_val + BIT20_MASK) >> 20);   // round down to 12 bits
-                sine_vals[i] = (DC_OFF - ((INT16U)(sine_val))); // add DC offset
-            }else{                                            // value is positive
-                sine_val = ((sine_val + BIT15_MASK) >> 15);   // round down to 16 bits
-                sine_val = (sine_val) * (AMP_SCALE*level);    // 16bit*16bit = 32bit result
-                sine_val = ((sine_val + BIT20_MASK) >> 20);   // round down to 12 bits
-                sine_vals[i] = ((INT16U)sine_val + DC_OFF);   // add DC offset
+#if (APP_CFG_SINE_LOAD_EN == DEF_ENABLED)
+        cycles = DWT->CYCCNT;
+#endif
+        OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+        sineSpecs = sineCurrentSpecs;               /* One consistent set per block */
+        sineCurrentSpecs.sweep_req = FALSE;
+        sineWs.scale = sineCal.scale[sineSpecs.level];
+        sineWs.scale_b = sineCal.scale[sineSpecs.dual.level];
+        sineWs.dc = sineCal.dc;
+        if(mtSet.seq != mtPlay.seq){                /* New tones start at their phases */
+            mtPlay = mtSet;
+            mt_new = TRUE;
+        }else{
+            mt_new = FALSE;
+        }
+        sineWs.arb = awg.table[awg.active];
+        sineWs.arb_len = awg.length[awg.active];
+        if(awg.swap){
+            sineWs.arb_next = awg.table[awg.active ^ 1];
+            sineWs.arb_next_len = awg.length[awg.active ^ 1];
+            want = sineWs.arb_next;
+            want_len = sineWs.arb_next_len;
+        }else{
+            sineWs.arb_next = (const INT16U *)0;
+            want = sineWs.arb;
+            want_len = sineWs.arb_len;
+        }
+        OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+        sineWs.arb_swapped = FALSE;
+        if((sineWs.arb_next != (const INT16U *)0) && (sineSpecs.wave != WAVE_ARB)){
+            sineWs.arb_swapped = TRUE;              /* No ARB period to wait for, swap now */
+        }else{
+        }
+        fs = sineRateSelect(&sineSpecs, want_len);
+        if(fs != sineWs.fs){                        /* Index is the first block at fs */
+            sineWs.fs = fs;
+            DMASetSampleRate(index, fs);
+#if (APP_CFG_SINE_LOAD_EN == DEF_ENABLED)
+            CPU_CRITICAL_ENTER();
+            sineLoad.budget = (SYSTEM_CLOCK / fs) * SAMPLES_PER_BLOCK;
+            sineLoad.max = 0;
+            CPU_CRITICAL_EXIT();
+#endif
+            mt_new = TRUE;
+        }else{
+        }
+        if(mt_new){
+            mtSetRate(&mtPlay, sineWs.fs);
+        }else{
+        }
+        sineWs.inc = (INT32U)(((INT64U)sineSpecs.frequency << 32) / sineWs.fs);
+        if(sineWs.inc != 0){
+            sineWs.recip = ((INT64U)1 << 62) / sineWs.inc;
+        }else{
+            sineWs.recip = 0;
+        }
+        sineWs.duty = (INT32U)(((INT64U)sineSpecs.duty << 32) / 100);
+        if(sineWs.duty < sineWs.inc){               /* Keep the two square edges a sample apart */
+            sineWs.duty = sineWs.inc;
+        }else if(sineWs.duty > (0U - sineWs.inc)){
+            sineWs.duty = 0U - sineWs.inc;
+        }else{
+        }
+        burstRest[0] = (INT16U)sineWs.dc;
+        if(sineSpecs.cal_drive != SINE_CAL_OFF){    /* Blocks only while a code is held */
+            sineSpecs.burst.mode = BURST_OFF;
+            sineSpecs.wave = WAVE_SINE;
+        }else{
+        }
+        if(sineSpecs.sweep_req){
+            if(sineSpecs.sweep_on){
+                sweepSetup(&sineSweep, &sineSpecs.sweep, sineWs.fs);
+            }else if(sineSweep.active){
+                sineSweep.active = FALSE;
+                sineSweep.marker = FALSE;
+                sineSweep.mark_offset = 0;
+            }else{
+            }
+        }else{
+        }
+        modSetup(&sineMod, &sineSpecs.mod, &sineWs);
+        sineWs.dither_mask = (sineSpecs.dither != DITHER_OFF) ? -1 : 0;
+        sineWs.dither_a1 = ditherCoef[sineSpecs.dither][0];
+        sineWs.dither_a2 = ditherCoef[sineSpecs.dither][1];
+
+        if(sineSpecs.burst.mode != BURST_OFF){      /* Rest at DC between bursts */
+            want = burstRest;
+            want_len = 1;
+            native = (DMAGetSampleRate() == sineWs.fs);
+        }else{
+            native = (sineSpecs.wave == WAVE_ARB) && (want_len != 0) &&
+                     (((INT32U)want_len * sineSpecs.frequency) == sineWs.fs) &&
+                     (DMAGetSampleRate() == sineWs.fs);
+            if(sineBurst.armed){
+                DMABurstDisarm();
+                DMABurstGateClose();
+                DMABurstSetTrigger(0, 0);
+                sineBurst.armed = FALSE;
+            }else{
             }
-            argument = ((argument + (TS*frequency)) & (~BIT31_MASK)); // mask the sign bit
         }
+        playing = DMALoopPlaying();
+        if(native){                                 /* DMA loops the table */
+            if(playing != want){
+                (void)DMAPlayLoop(want, want_len);  /* Retried next time if pending */
+            }else if(want == burstRest){
+                sineBurstUpdate(&sineSpecs, &sineWs, &sineBurst);
+            }else{
+                sineWs.arb_swapped = (sineWs.arb_next != (const INT16U *)0);
+            }
+        }else if((playing != (const INT16U *)0) && !DMALoopPending()){
+            sineFillBlock(0, &sineSpecs, &sineWs, DMADualActive()); /* Refill both, then leave the loop */
+            sineFillBlock(1, &sineSpecs, &sineWs, DMADualActive());
+            (void)DMAPlayBlocks();
+        }else if((playing == (const INT16U *)0) && DMALoopPending()){
+            (void)DMAPlayBlocks();                  /* Cancel a loop not linked yet */
+        }else if((playing == (const INT16U *)0) &&
+                 ((sineSpecs.dual.on != FALSE) != (DMADualActive() != FALSE))){
+            (void)DMASetDual(sineSpecs.dual.on);    /* Retried next block if refused */
+        }else{
+        }
+        if(pend_err == OS_ERR_NONE){
+            sineFillBlock(index, &sineSpecs, &sineWs, info.dual);
+        }else{
+        }
+
+        if(sineWs.arb_swapped){                     /* Staging table is now active */
+            OSMutexPend(&sineMutexKey, 0, OS_OPT_PEND_BLOCKING, (CPU_TS *)0, &os_err);
+            awg.active ^= 1;
+            awg.swap = FALSE;
+            OSMutexPost(&sineMutexKey, OS_OPT_POST_NONE, &os_err);
+        }else{
+        }
+        if((DMALoopPlaying() != (const INT16U *)0) || DMALoopPending()){
+            tout = LOOP_POLL_TOUT;                  /* No blocks while looping */
+        }else{
+            tout = 0;
+        }
+#if (APP_CFG_SINE_LOAD_EN == DEF_ENABLED)
+        cycles = DWT->CYCCNT - cycles;              /* Includes preemption, as the deadline does */
+        CPU_CRITICAL_ENTER();
+        sineLoad.last = cycles;
+        if(cycles > sineLoad.max){
+            sineLoad.max = cycles;
+        }else{
+        }
+        CPU_CRITICAL_EXIT();
+#endif
+    }
+}
+/*****************************************************************************************
+* sineFillBlock - Runs the waveform kernel into a DMA block
+* A sine with a sweep running uses the sweep kernel, with modulation on the modulated
+* kernel. A code held by SineCalDrive() fills DAC0 and B runs on. A marker edge from the
+* sweep in this block is passed on to the DMA with the block.
+* A dual block also runs channel B from a copy of the state, at the set increment and
+* B's scale. B starts at A's phase plus the offset unless A's phase runs at another
+* rate, then it carries on from its own.
+* 10/19/2026
+*****************************************************************************************/
+static void sineFillBlock(INT8U index, const SINE_SPECS *specs, WAVE_STATE *ws, INT8U dual){
+    INT8U free_run = FALSE;
+    if((specs->wave == WAVE_SINE) && (ws->sweep->active || (ws->mod->type != MOD_OFF))){
+        free_run = TRUE;
+    }else{
+    }
+    if(dual && !free_run){
+        dualPhase = ws->phase + (INT32U)(((INT64U)specs->dual.phase_deg << 32) / 360);
+    }else{
+    }
+    if(specs->cal_drive != SINE_CAL_OFF){
+        for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+            sine_vals[i] = specs->cal_drive;
+        }
+    }else if((specs->wave == WAVE_SINE) && ws->sweep->active && (ws->dither_mask == 0)){
+        waveSineSweepPlain(sine_vals, ws);
+    }else if((specs->wave == WAVE_SINE) && ws->sweep->active){
+        waveSineSweep(sine_vals, ws);
+    }else if((specs->wave == WAVE_SINE) && (ws->mod->type != MOD_OFF)){
+        waveSineMod(sine_vals, ws);
+    }else{
+        waveKernelSelect(specs->wave, ws)(sine_vals, ws);
+    }
+    if(dual){
+        dualWs = *ws;
+        dualWs.phase = dualPhase;
+        dualWs.scale = ws->scale_b;
+        dualWs.dither = &dualDither;
+        waveKernelSelect(specs->dual.wave, &dualWs)(dual_vals, &dualWs);
+        dualPhase = dualWs.phase;
+        DMAFillFrames(index, sine_vals, dual_vals);
+    }else{
         DMAFillBuffer(index, sine_vals);
     }
+    if(ws->sweep->mark_offset != SWEEP_NO_MARK){
+        DMASetMarker(index, ws->sweep->mark_offset, ws->sweep->marker);
+        ws->sweep->mark_offset = SWEEP_NO_MARK;
+    }else{
+    }
 }
@@ -4,10 +4,30 @@
  * on current configurations and store in DMA ping pong buffer
  *
  * 02/14/2022 Dominic Danis
+ * 10/19/2026 Added the Waveform API for the DAC waveform and square duty
+ * 10/19/2026 Added the arbitrary waveform table and its load API
+ * 10/19/2026 Added frequency sweeps
+ * 10/19/2026 Added AM, FM and PM from an internal LFO, and the sinegen load counters
+ * 10/19/2026 Added the multitone waveform
+ * 10/19/2026 Added white and pink noise
+ * 10/19/2026 Added triggered and gated bursts
+ * 10/19/2026 Added the second output on DAC1
+ * 10/19/2026 Added the sample rate setting, chosen from the output by default
+ * 10/19/2026 Added dither and noise shaping of the DAC codes
+ * 10/19/2026 Added the DAC calibration, needs EEPROM.h for DAC_CAL
  *****************************************************************************************/
 #ifndef SINE_GENERATION_H_
 #define SINE_GENERATION_H_
 /*****************************************************************************************
+* DAC waveforms. Saw rises and drops, ramp falls and rises, square is high for the duty.
+* Arb plays the table loaded with AwgLoad*(). Multi plays the tones set with
+* MultitoneSet(). White and pink noise have the RMS of the sine at the same level,
+* frequency does not apply.
+*****************************************************************************************/
+typedef enum {WAVE_SINE, WAVE_TRIANGLE, WAVE_SAW, WAVE_RAMP, WAVE_SQUARE, WAVE_ARB,
+              WAVE_MULTI, WAVE_WHITE, WAVE_PINK, WAVE_NUM} WAVE_T;
+#define AWG_MAX_SAMPLES 1024
+/*****************************************************************************************
 * Init function - creates task and Mutex.
 * Dominic Danis 3/10/2022
 *****************************************************************************************/
@@ -32,5 +52,200 @@ INT16U SinewaveGetFreq(void);
 * Dominic Danis 3/10/2022
 *****************************************************************************************/
 INT8U SinewaveGetLevel(void);
+/*****************************************************************************************
+* Waveform setter and getter, the setter selects sine for an out of range value
+* 10/19/2026
+*****************************************************************************************/
+void WaveformSetType(WAVE_T wave);
+WAVE_T WaveformGetType(void);
+/*****************************************************************************************
+* Square wave duty setter and getter, percent held in 1-99
+* 10/19/2026
+*****************************************************************************************/
+void WaveformSetDuty(INT8U duty);
+INT8U WaveformGetDuty(void);
+/*****************************************************************************************
+* Arbitrary waveform table load
+* One period of 12-bit DAC codes, played as loaded, level does not apply. A new table is
+* streamed in chunks to a staging table while the active one plays:
+*   AwgLoadBegin(length)    starts a load of 1 - AWG_MAX_SAMPLES samples. FALSE while the
+*                           previous table has not been swapped in yet.
+*   AwgLoadChunk(p, n)      appends up to n samples, returns the number taken
+*   AwgLoadCommit()         FALSE unless all samples were loaded. The new table replaces
+*                           the active one at the next period boundary.
+* When frequency*length is one of the sample rates the table is played by the DMA at one
+* sample per trigger with no CPU. Otherwise it is resampled from the phase accumulator.
+* 10/19/2026
+*****************************************************************************************/
+INT8U AwgLoadBegin(INT16U length);
+INT16U AwgLoadChunk(const INT16U *samples, INT16U count);
+INT8U AwgLoadCommit(void);
+INT16U AwgGetLength(void);
+/*****************************************************************************************
+* Frequency sweep of the sine output
+* Sweeps from start_hz to stop_hz in duration_ms, linear or logarithmic in frequency.
+* One-shot stops at stop_hz, repeat starts again at start_hz, up-down turns around.
+* The phase is continuous. The DB6 marker is set at the start of the sweep and toggles
+* at every turn, restart or end.
+* 10/19/2026
+*****************************************************************************************/
+typedef enum {SWEEP_LIN, SWEEP_LOG} SWEEP_LAW;
+typedef enum {SWEEP_ONESHOT, SWEEP_REPEAT, SWEEP_UPDOWN} SWEEP_MODE;
+typedef struct{
+    INT16U start_hz;
+    INT16U stop_hz;
+    INT32U duration_ms;         /* 50ms minimum */
+    SWEEP_LAW law;
+    SWEEP_MODE mode;
+}SWEEP_CFG;
+void SweepStart(const SWEEP_CFG *cfg);
+void SweepStop(void);           /* Back to the set frequency */
+INT8U SweepIsActive(void);
+/*****************************************************************************************
+* Modulation of the sine output by an internal low frequency oscillator
+* rate_dhz is the LFO rate in 0.1Hz steps, MOD_RATE_MAX is 200Hz. depth is
+*   AM  percent, 0-100. The peak stays at the set level.
+*   FM  peak deviation in Hz, up to the carrier frequency
+*   PM  peak deviation in degrees, 0-180
+* A sweep takes the place of the modulation while it runs.
+* 10/19/2026
+*****************************************************************************************/
+typedef enum {MOD_OFF, MOD_AM, MOD_FM, MOD_PM, MOD_NUM} MOD_TYPE;
+typedef enum {LFO_SINE, LFO_SQUARE, LFO_TRIANGLE} LFO_SHAPE;
+#define MOD_RATE_MAX 2000
+#define MOD_AM_MAX 100
+#define MOD_PM_MAX 180
+typedef struct{
+    MOD_TYPE type;
+    LFO_SHAPE shape;
+    INT16U rate_dhz;
+    INT16U depth;
+}MOD_CFG;
+void ModulationSet(const MOD_CFG *cfg);
+void ModulationGet(MOD_CFG *cfg);
+/*****************************************************************************************
+* Sinegen CPU load, in core clock cycles per block. budget is one block period, the
+* deadline for the fill. Only counted with APP_CFG_SINE_LOAD_EN.
+* 10/19/2026
+*****************************************************************************************/
+typedef struct{
+    INT32U last;
+    INT32U max;
+    INT32U budget;
+}SINE_LOAD;
+void SineGenGetLoad(SINE_LOAD *load);
+/*****************************************************************************************
+* Multitone, up to MT_MAX_TONES sines summed
+* freq is in Hz, amp is the weight of the tone, 0-MT_AMP_MAX, phase_deg its start phase.
+* A tone at 0Hz, or at or over half the sample rate playing, is left out of the sum.
+* With SAMPLE_RATE_AUTO the rate follows the highest tone, so any other tone plays, a
+* fixed rate from SampleRateSet() can leave tones out. The auto rate is held to what the
+* count can fill, over 8 tones it is below 200kHz and a high tone can be left out.
+* With schroeder TRUE the phases are replaced by Schroeder phases, set from the tone
+* powers to keep the crest factor low.
+* The sum is scaled so its peak is the set level. The peak is found by running the tones
+* for MT_PEAK_SAMPLES in the caller, so MultitoneSet() takes a few ms.
+* Returns FALSE and keeps the tones playing for a count of 0 or over MT_MAX_TONES.
+* The default is the SMPTE intermodulation pair, 60Hz and 7kHz at 4:1.
+* 10/19/2026
+*****************************************************************************************/
+#define MT_MAX_TONES 16
+#define MT_AMP_MAX 1000
+typedef struct{
+    INT16U freq;
+    INT16U amp;
+    INT16U phase_deg;
+}MT_TONE;
+INT8U MultitoneSet(const MT_TONE *tones, INT8U count, INT8U schroeder);
+/*****************************************************************************************
+* Bursts of the DAC waveform
+*   BURST_COUNT  each trigger plays cycles whole cycles
+*   BURST_GATED  cycles whole cycles repeat while the gate is open
+* The output rests at the DC midpoint between bursts. Bursts are rendered ahead into a
+* buffer of BURST_MAX_SAMPLES and started by the trigger interrupt, two sample periods
+* after the trigger, see DMABurstFire(). cycles is reduced to fit the buffer, and the
+* frequency is trimmed so the cycles fill a whole number of samples.
+* triggers are DMA_TRIG_* ORed, DMA_TRIG_TIMER repeats every period_ms. BurstTrigger()
+* starts a burst from software, with any triggers. Gated, it opens the gate, or closes
+* it when open. Settings, including the waveform, take effect after a burst finishes.
+* Sweep and modulation do not apply.
+* 10/19/2026
+*****************************************************************************************/
+typedef enum {BURST_OFF, BURST_COUNT, BURST_GATED} BURST_MODE;
+#define BURST_MAX_SAMPLES 8192
+typedef struct{
+    BURST_MODE mode;
+    INT16U cycles;
+    INT8U triggers;
+    INT16U period_ms;
+}BURST_CFG;
+void BurstSet(const BURST_CFG *cfg);
+void BurstGet(BURST_CFG *cfg);
+void BurstTrigger(void);
+/*****************************************************************************************
+* Second output, channel B on DAC1
+* B plays wave, sine to square, at the set frequency and duty and its own level.
+* phase_deg is its phase lead over channel A on DAC0, held at every block while A is
+* not swept or modulated. Both DACs are written by the same DMA trigger, so the
+* outputs are sample-synchronous. The change takes effect at the end of the DMA buffer.
+* While the DMA loops an arbitrary table or a burst rest, B holds its last value.
+* The setter takes WAVE_SINE for a wave past WAVE_SQUARE.
+* 10/19/2026
+*****************************************************************************************/
+typedef struct{
+    INT8U on;
+    WAVE_T wave;
+    INT8U level;
+    INT16U phase_deg;           /* 0-359 */
+}DUAL_CFG;
+void DualSet(const DUAL_CFG *cfg);
+void DualGet(DUAL_CFG *cfg);
+/*****************************************************************************************
+* Sample rate
+* SAMPLE_RATE_AUTO picks the rate from the output: the lowest of the rates, 8kHz to
+* 200kHz, at least SAMPLE_RATE_OVERSAMPLE times the highest frequency played. Low
+* frequencies cost less DMA and CPU, high frequencies keep their images far away.
+* A table with a native rate plays at it, noise plays at 48kHz and sweeps at 24kHz or
+* more. A fixed rate is rounded up to one of the rates.
+* The rate changes at a block boundary with the phase kept. SampleRateGet() is the rate
+* playing now.
+* 10/19/2026
+*****************************************************************************************/
+#define SAMPLE_RATE_AUTO 0
+#define SAMPLE_RATE_OVERSAMPLE 48
+void SampleRateSet(INT32U fs);
+INT32U SampleRateGet(void);
+/*****************************************************************************************
+* Dither of the 12-bit DAC codes, for sine to square and the sweep
+*   DITHER_TPDF     triangular dither of +-1 LSB, the distortion of small levels becomes
+*                   a flat noise floor
+*   DITHER_SHAPE1   with first order error feedback, the noise rises 6dB/octave to fs/2
+*   DITHER_SHAPE2   second order, 12dB/octave. Use a high sample rate so the noise lands
+*                   well above the output frequency.
+* Shaping adds up to 6 LSB of high frequency noise at the peaks.
+* 10/19/2026
+*****************************************************************************************/
+typedef enum {DITHER_OFF, DITHER_TPDF, DITHER_SHAPE1, DITHER_SHAPE2, DITHER_NUM} DITHER_MODE;
+void DitherSet(DITHER_MODE mode);
+DITHER_MODE DitherGet(void);
+/*****************************************************************************************
+* DAC0 calibration. SineCalSet() folds the gain and the per-level trim into the scale of
+* each level, and the offset into the midpoint, so the kernels do no more work per
+* sample. Arbitrary tables play their codes unchanged. DAC1 uses DAC0's calibration.
+* SineCalDrive() holds DAC0 at a raw code to be measured, SINE_CAL_OFF goes back to the
+* waveform. SineCalCompute() sets the gain and offset of cal from the millivolts
+* measured at SINE_CAL_CODE_LO and SINE_CAL_CODE_HI and keeps the trim. It returns
+* FALSE and leaves cal unchanged if the result is out of range.
+* Levels above SINE_LEVEL_MAX are set to it.
+* 10/19/2026
+*****************************************************************************************/
+#define SINE_LEVEL_MAX 20
+#define SINE_CAL_OFF 0xFFFF
+#define SINE_CAL_CODE_LO 512
+#define SINE_CAL_CODE_HI 3584
+void SineCalSet(const DAC_CAL *cal);
+void SineCalGet(DAC_CAL *cal);
+void SineCalDrive(INT16U code);
+INT8U SineCalCompute(INT16U mv_lo, INT16U mv_hi, DAC_CAL *cal);
 
 #endif
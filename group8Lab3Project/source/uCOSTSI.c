@@ -5,7 +5,16 @@
  * and OSFlagPost() is called. The flag is only set, at the start of a sensor press. The current
  * sensor state and last sensor state are compared to determine the edge of the sensor press start.
  *
+ * Scans are interrupt driven. tsiTask starts a sequence, TSI0_IRQHandler reads each
+ * end-of-scan result, starts the next channel and posts the count to the task queue.
+ *
  * 02/17/2022 Aili Emory
+ * 10/19/2026 End-of-scan interrupt with channel sequencing replaces EOSF polling
+ * 10/19/2026 Baseline and noise are tracked continuously with fixed-point IIR filters
+ *            while a pad is untouched. Thresholds follow the noise with hysteresis.
+ * 10/19/2026 Added TSIGetPad() for pad deltas and touch state
+ * 10/19/2026 Calibration repeats until every pad has reported, late results are flushed
+* 10/19/2026 End of scan past the last pad of a sequence is cleared and ignored
  * Includes functions by Todd Morton in Flag notes and TSI notes
  *******************************************************************************/
 #include "os.h"
@@ -17,8 +26,12 @@
 typedef enum {T_ON, T_OFF} T_STATE;
 typedef struct{
     INT16U baseline;
-    INT16U offset;
-    INT16U threshold;
+    INT16U offset;          /* Minimum touch offset from baseline          */
+    INT16U threshold;       /* Touch on above this count                   */
+    INT16U release;         /* Touch off below this count                  */
+    INT32U base_q;          /* Baseline IIR state, TSI_Q fractional bits   */
+    INT32U noise_q;         /* Mean absolute deviation IIR, TSI_Q bits     */
+    INT16U delta;           /* Last count above baseline, 0 if below       */
     T_STATE state;
 }TOUCH_LEVEL_T;
 static OS_FLAG_GRP tsiFlags;
@@ -36,12 +49,28 @@ static CPU_STK tsiTaskStk[APP_CFG_TSI_TASK_STK_SIZE];
 #define E2_TOUCH_OFFSET  0x0400U    // Determined experimentally
 #define TSI0_ENABLE()    TSI0->GENCS |= TSI_GENCS_TSIEN_MASK
 #define TSI0_DISABLE()   TSI0->GENCS &= ~TSI_GENCS_TSIEN_MASK
+#define TSI_NUM_PADS     2U
+#define TSI_SCAN_PERIOD  4U         // Ticks between scan sequences
+#define TSI_SCAN_TOUT    10U        // Ticks before a lost end-of-scan restarts the sequence
+#define TSI_MSG(ch,cnt)  ((void *)(((INT32U)(ch)<<16)|(INT32U)(cnt)))
+#define TSI_MSG_CH(msg)  ((INT8U)((INT32U)(msg)>>16))
+#define TSI_MSG_CNT(msg) ((INT16U)(INT32U)(msg))
+#define TSI_Q            4U         // Fractional bits of the filter states
+#define TSI_BASE_SHIFT   9U         // Baseline time constant, 512 sequences (~3s)
+#define TSI_NOISE_SHIFT  5U         // Noise time constant, 32 sequences
+#define TSI_NOISE_MULT   8U         // Touch offset in units of mean abs. deviation
+#define TSI_HYST_SHIFT   1U         // Release at half the touch offset
 
 static TOUCH_LEVEL_T tsiSensorLevels[MAX_NUM_ELECTRODES];   /*Private Resources*/
+static const INT8U tsiPads[TSI_NUM_PADS] = {BRD_PAD1_CH, BRD_PAD2_CH};  /* Scan sequence */
+static volatile INT8U tsiSeqIndex;                          /* Pad being scanned by the ISR */
+static TSI_STATS tsiStats;
 static void tsiStartScan(INT8U channel);
-static void tsiProcScan(INT8U channel);
-static void tsiChCalibration(INT8U channel);
+static void tsiProcScan(INT8U channel, INT16U tsi_touch_count);
+static void tsiChCalibration(INT8U channel, INT16U tsi_touch_count);
+static void tsiUpdateLevels(TOUCH_LEVEL_T *level, INT16U tsi_touch_count);
 static void tsiTask(void *p_arg);
+void TSI0_IRQHandler(void);
 /********************************************************************************
  * TSIInit: Initializes TSI0 module
  * From TSI notes Todd Morton
@@ -62,10 +91,10 @@ void TSIInit(void){
                    (TSI_GENCS_REFCHRG(5))|      /*16uA ext. charge current, 16uA Ref. charge current, .592V dV*/
                    (TSI_GENCS_DVOLT(1))|
                    (TSI_GENCS_PS(5))|
-                   (TSI_GENCS_NSCN(15)));
+                   (TSI_GENCS_NSCN(15))|
+                   (TSI_GENCS_ESOR(1))|         /*Interrupt at end of scan, not out of range*/
+                   (TSI_GENCS_TSIIEN(1)));
     TSI0_ENABLE();
-    tsiChCalibration(BRD_PAD1_CH);
-    tsiChCalibration(BRD_PAD2_CH);
 
     OSFlagCreate(&tsiFlags,"TSI FLags",0,&os_err);
 
@@ -77,48 +106,159 @@ void TSIInit(void){
                 (CPU_STK    *)&tsiTaskStk[0],
                 (CPU_STK     )(APP_CFG_TSI_TASK_STK_SIZE / 10u),
                 (CPU_STK_SIZE) APP_CFG_TSI_TASK_STK_SIZE,
-                (OS_MSG_QTY  ) 0,
+                (OS_MSG_QTY  ) TSI_NUM_PADS,   /* One result per pad per sequence */
                 (OS_TICK     ) 0,
                 (void       *) 0,
                 (OS_OPT      )(OS_OPT_TASK_STK_CHK | OS_OPT_TASK_STK_CLR),
                 (OS_ERR     *)&os_err);
+    NVIC_EnableIRQ(TSI0_IRQn);
 }
 /********************************************************************************
 * tsiCalibration: Calibration to find non-touch baseline for a channel
 *                 channel - the channel to calibrate, range 0-15
+*                 tsi_touch_count - count from the first scan of the channel
 *                 Note - the sensor must not be pressed when this is executed.
 * From TSI notes Todd Morton
+* 10/19/2026 Takes the count from the interrupt instead of waiting on EOSF
  ********************************************************************************/
-static void tsiChCalibration(INT8U channel){
-    tsiStartScan(channel);
-    while((TSI0->GENCS & TSI_GENCS_EOSF_MASK) == 0){} //wait for scan to finish
-    TSI0->GENCS |= TSI_GENCS_EOSF(1);    //Clear flag
-    tsiSensorLevels[channel].baseline = (INT16U)(TSI0->DATA & TSI_DATA_TSICNT_MASK);
+static void tsiChCalibration(INT8U channel, INT16U tsi_touch_count){
+    tsiSensorLevels[channel].baseline = tsi_touch_count;
+    tsiSensorLevels[channel].base_q = (INT32U)tsi_touch_count << TSI_Q;
+    tsiSensorLevels[channel].noise_q = 0;
+    tsiSensorLevels[channel].delta = 0;
+    tsiSensorLevels[channel].state = T_OFF;
     tsiSensorLevels[channel].threshold = tsiSensorLevels[channel].baseline +
                                          tsiSensorLevels[channel].offset;
+    tsiSensorLevels[channel].release = tsiSensorLevels[channel].baseline +
+                                       (tsiSensorLevels[channel].offset >> TSI_HYST_SHIFT);
+}
+/********************************************************************************
+* tsiUpdateLevels: Tracks the untouched baseline and noise of a pad and derives
+*                  its thresholds. Runs on every scan result.
+*                  Both filters are first order IIR, y += (x - y) >> k, in
+*                  fixed point with TSI_Q fractional bits. They are frozen while
+*                  the count is above the release level so a touch, or a finger
+*                  hovering near the pad, is not absorbed into the baseline.
+*                  Noise is the mean absolute deviation from baseline, a cheap
+*                  stand-in for the standard deviation (about 0.8 sigma). The
+*                  touch offset is TSI_NOISE_MULT times the noise, never less
+*                  than the experimentally determined pad offset. Release is
+*                  half the touch offset above baseline.
+* 10/19/2026
+ ********************************************************************************/
+static void tsiUpdateLevels(TOUCH_LEVEL_T *level, INT16U tsi_touch_count){
+    INT32S dev_q;
+    INT32U touch_offset;
+
+    if(tsi_touch_count < level->release){
+        dev_q = (INT32S)((INT32U)tsi_touch_count << TSI_Q) - (INT32S)level->base_q;
+        level->base_q = (INT32U)((INT32S)level->base_q + (dev_q >> TSI_BASE_SHIFT));
+        if(dev_q < 0){
+            dev_q = -dev_q;
+        }else{
+        }
+        level->noise_q = (INT32U)((INT32S)level->noise_q +
+                                  ((dev_q - (INT32S)level->noise_q) >> TSI_NOISE_SHIFT));
+        level->baseline = (INT16U)(level->base_q >> TSI_Q);
+        touch_offset = (TSI_NOISE_MULT * level->noise_q) >> TSI_Q;
+        if(touch_offset < level->offset){
+            touch_offset = level->offset;
+        }else{
+        }
+        if((level->baseline + touch_offset) > 0xFFFFU){
+            touch_offset = 0xFFFFU - level->baseline;
+        }else{
+        }
+        level->threshold = (INT16U)(level->baseline + touch_offset);
+        level->release = (INT16U)(level->baseline + (touch_offset >> TSI_HYST_SHIFT));
+    }else{                                              /* Touched, hold the levels */
+    }
 }
 /********************************************************************************
 * tsiTask: uCOS Task
-*          TSI sensors are scanned sequentially.
-*          There are two pending service calls to do two things sequentially.
+*          Starts a scan sequence of all pads and pends on the task queue for
+*          each result posted by TSI0_IRQHandler. The first sequence after
+*          boot in which every pad reports calibrates the pads. After a lost
+*          scan the queue is flushed, so a late result of the abandoned
+*          sequence is not taken for the next one. The task sleeps between
+*          sequences.
 * From Flag notes Todd Morton
+* 10/19/2026 Interrupt driven, results arrive through the task queue
   ********************************************************************************/
 static void tsiTask(void *p_arg){
     OS_ERR os_err;
+    OS_MSG_SIZE msg_size;
+    void *msg;
+    INT8U calibrated = FALSE;
+    INT8U seq_ok = TRUE;
+    INT8U pad;
     (void)p_arg;
 
     while(1){
-        tsiStartScan(BRD_PAD1_CH);
-        OSTimeDly(6,OS_OPT_TIME_PERIODIC,&os_err);
-        tsiProcScan(BRD_PAD1_CH);
+        if(!seq_ok){
+            (void)OSTaskQFlush((OS_TCB *)0, &os_err);
+        }else{
+        }
+        seq_ok = TRUE;
+        tsiSeqIndex = 0;
+        tsiStats.seq_tick = OSTimeGet(&os_err);
+        tsiStartScan(tsiPads[0]);
         DB3_TURN_ON();
-        tsiStartScan(BRD_PAD2_CH);
-        OSTimeDly(6,OS_OPT_TIME_PERIODIC,&os_err);
-        tsiProcScan(BRD_PAD2_CH);
+        for(pad = 0; pad < TSI_NUM_PADS; pad++){
+            msg = OSTaskQPend(TSI_SCAN_TOUT, OS_OPT_PEND_BLOCKING, &msg_size, (CPU_TS *)0, &os_err);
+            if(os_err == OS_ERR_NONE){
+                if(calibrated){
+                    tsiProcScan(TSI_MSG_CH(msg), TSI_MSG_CNT(msg));
+                }else{
+                    tsiChCalibration(TSI_MSG_CH(msg), TSI_MSG_CNT(msg));
+                }
+            }else{                                  /* Lost scan, restart the sequence */
+                tsiStats.timeouts++;
+                seq_ok = FALSE;
+                pad = TSI_NUM_PADS;
+            }
+        }
+        if(seq_ok){                                 /* Every pad has a baseline */
+            calibrated = TRUE;
+        }else{
+        }
         DB3_TURN_OFF();
+        OSTimeDly(TSI_SCAN_PERIOD,OS_OPT_TIME_DLY,&os_err);
     }
 }
 /********************************************************************************
+* TSI0_IRQHandler: End of scan. Reads the count of the pad just scanned, starts
+*                  the next pad in tsiPads[] and posts the count to tsiTask.
+*                  DB0 is high while in the handler for CPU time measurement.
+*                  An end of scan after the last pad of the sequence, a late or
+*                  stray one, is only cleared and counted, tsiPads[] is not read
+*                  past its end.
+* 10/19/2026
+ ********************************************************************************/
+void TSI0_IRQHandler(void){
+    OS_ERR os_err;
+    INT16U count;
+    INT8U channel;
+    OSIntEnter();
+    DB0_TURN_ON();
+    TSI0->GENCS |= TSI_GENCS_EOSF(1);           //Clear flag
+    if(tsiSeqIndex >= TSI_NUM_PADS){            //No scan of the sequence pending
+        tsiStats.strays++;
+    }else{
+        count = (INT16U)(TSI0->DATA & TSI_DATA_TSICNT_MASK);
+        channel = tsiPads[tsiSeqIndex];
+        tsiSeqIndex++;
+        if(tsiSeqIndex < TSI_NUM_PADS){
+            tsiStartScan(tsiPads[tsiSeqIndex]); //Sequence to the next pad
+        }else{
+        }
+        tsiStats.isr_count++;
+        OSTaskQPost(&tsiTaskTCB, TSI_MSG(channel, count), sizeof(void *), OS_OPT_POST_FIFO, &os_err);
+    }
+    DB0_TURN_OFF();
+    OSIntExit();
+}
+/********************************************************************************
 * TSIStartScan: Starts a scan of a TSI sensor.
 *               channel - the TSI channel to be started. Range 0-15
 * From TSI notes Todd Morton
@@ -130,30 +270,63 @@ static void tsiStartScan(INT8U channel){
 /********************************************************************************
 * TSIProcScan: TSI scanner signals an event flag group when a sensor is touched.
 *              The sensor must be released before a flag is signaled again.
+*              Touch is above the threshold, release is below the release level.
 * From Flag notes Todd Morton
+* 10/19/2026 Count is passed in from the interrupt, no EOSF wait
  ********************************************************************************/
-static void tsiProcScan(INT8U channel){
+static void tsiProcScan(INT8U channel, INT16U tsi_touch_count){
     OS_ERR os_err;
-    INT16U tsi_touch_count;
     T_STATE cur_state;
-    while((TSI0->GENCS & TSI_GENCS_EOSF_MASK) == 0){}
-        TSI0->GENCS |= TSI_GENCS_EOSF(1); //Clear flag
-        tsi_touch_count = (TSI0->DATA & TSI_DATA_TSICNT_MASK);
-        if((tsi_touch_count > tsiSensorLevels[channel].threshold)){
-            cur_state = T_ON;
+    tsiUpdateLevels(&tsiSensorLevels[channel], tsi_touch_count);
+    if(tsi_touch_count > tsiSensorLevels[channel].baseline){
+        tsiSensorLevels[channel].delta = tsi_touch_count - tsiSensorLevels[channel].baseline;
+    }else{
+        tsiSensorLevels[channel].delta = 0;
+    }
+    if((tsi_touch_count > tsiSensorLevels[channel].threshold)){
+        cur_state = T_ON;
+    }else if(tsi_touch_count < tsiSensorLevels[channel].release){
+        cur_state = T_OFF;
+    }else{
+        cur_state = tsiSensorLevels[channel].state;     /* Hysteresis band, no change */
+    }
+    if((cur_state == T_ON) && (tsiSensorLevels[channel].state == T_OFF)){
+        DB2_TURN_ON();
+        (void)OSFlagPost(&tsiFlags,
+                (OS_FLAGS)(1<<channel),OS_OPT_POST_FLAG_SET, &os_err);
+        DB2_TURN_OFF();
+        tsiSensorLevels[channel].state = T_ON;
+        tsiStats.last_latency = OSTimeGet(&os_err) - tsiStats.seq_tick;
+        if(tsiStats.last_latency > tsiStats.max_latency){
+            tsiStats.max_latency = tsiStats.last_latency;
         }else{
-            cur_state = T_OFF;
         }
-        if((cur_state == T_ON) && (tsiSensorLevels[channel].state == T_OFF)){
-            DB2_TURN_ON();
-            (void)OSFlagPost(&tsiFlags,
-                    (OS_FLAGS)(1<<channel),OS_OPT_POST_FLAG_SET, &os_err);
-            DB2_TURN_OFF();
-            tsiSensorLevels[channel].state = T_ON;
-        }else if(cur_state == T_OFF){
-            tsiSensorLevels[channel].state = T_OFF;
-        }else{
-     }
+    }else if(cur_state == T_OFF){
+        tsiSensorLevels[channel].state = T_OFF;
+    }else{
+    }
+}
+/********************************************************************
+* TSIGetStats(): Copies the TSI interrupt and latency counters.
+* 10/19/2026
+********************************************************************/
+void TSIGetStats(TSI_STATS *stats){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    *stats = tsiStats;
+    CPU_CRITICAL_EXIT();
+}
+/********************************************************************
+* TSIGetPad(): Copies the latest delta and touch state of a pad.
+*              channel - BRD_PAD1_CH or BRD_PAD2_CH
+* 10/19/2026
+********************************************************************/
+void TSIGetPad(INT8U channel, TSI_PAD *pad){
+    CPU_SR_ALLOC();
+    CPU_CRITICAL_ENTER();
+    pad->delta = tsiSensorLevels[channel].delta;
+    pad->touched = (tsiSensorLevels[channel].state == T_ON);
+    CPU_CRITICAL_EXIT();
 }
 /********************************************************************
 * TSIPend(): TSIPend provides access to the TSI buffer via an
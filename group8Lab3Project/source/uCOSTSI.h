@@ -6,6 +6,8 @@
 * sensor state and last sensor state are compared to determine the edge of the sensor press start.
 *
 * 02/17/2022 Aili Emory
+* 10/19/2026 Interrupt driven scanning, added TSIGetStats()
+* 10/19/2026 Added TSIGetPad()
 * Includes functions by Todd Morton in Flag notes and TSI notes
 *******************************************************************************/
 #ifndef UCOSTSI_H_
@@ -28,6 +30,39 @@ OS_FLAGS TSIPend(OS_TICK tout, OS_ERR *os_err);
  * 02/17/2022 Aili Emory
  ********************************************************************************/
 void TSIInit(void); /* TSI Initialization*/
+/********************************************************************************
+ * TSI activity counters, see TSIGetStats()
+ * Latencies are in OS ticks from the start of the scan sequence that saw a
+ * touch to its flag post. CPU time in the ISR is measured on DB0.
+ ********************************************************************************/
+typedef struct{
+    INT32U isr_count;           /* end-of-scan interrupts           */
+    INT32U timeouts;            /* sequences restarted on lost scan */
+    INT32U strays;              /* end-of-scan past the last pad    */
+    OS_TICK seq_tick;           /* start of the current sequence    */
+    OS_TICK last_latency;
+    OS_TICK max_latency;
+}TSI_STATS;
+/********************************************************************************
+ * TSIGetStats: Copy of the TSI counters
+ * -Public
+ * 10/19/2026
+ ********************************************************************************/
+void TSIGetStats(TSI_STATS *stats);
+/********************************************************************************
+ * Pad state, see TSIGetPad()
+ * delta is the last count above the tracked baseline, 0 if below.
+ ********************************************************************************/
+typedef struct{
+    INT16U delta;
+    INT8U touched;
+}TSI_PAD;
+/********************************************************************************
+ * TSIGetPad: Latest delta and touch state of a pad
+ * -Public
+ * 10/19/2026
+ ********************************************************************************/
+void TSIGetPad(INT8U channel, TSI_PAD *pad);
 
 #endif /*UCOSTSI_H_*/
 
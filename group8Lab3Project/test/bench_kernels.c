@@ -0,0 +1,264 @@
+/*****************************************************************************************
+* bench_kernels - Host cost of the waveform kernels per sample
+* sineGenTask runs as a host task for a block at each setting, so sineWs is set up as on
+* the target, then the kernel is timed on its own over BENCH_BLOCKS blocks of
+* SAMPLES_PER_BLOCK. The least of BENCH_RUNS runs is kept, the one least disturbed.
+* Every waveKernels[] and wavePlainKernels[] entry is timed at BENCH_LEVEL and 48kHz, and
+* the original sine loop, oldSinePath() below, as the reference.
+* The sine is also timed at level 0, mid level and full level through waveKernelSelect(),
+* plain and dithered, against the old loop at the same level. Level 0 is waveFlat.
+* waveSineMod is timed for AM, FM and PM at full level, MOD_RATE_MAX and the largest
+* depth, 100%, the carrier frequency and 180 degrees, for each LFO shape.
+* waveMulti is timed for 1 to MT_MAX_TONES tones and fitted to a fixed cost and a cost
+* per tone, in host units and in plain sine samples. A tone is a sine and a multiply
+* add, as a plain sine sample is, so the target cost is taken as M4_SINE_CYCLES a plain
+* sine sample, and the tones that fit MT_LOAD_SHARE of the 48kHz and 200kHz sample
+* periods at SYSTEM_CLOCK are reported.
+* arm_sin_q31() is the CMSIS method here, a 512 step table with linear interpolation,
+* not the exact sin() of the tests, so the sine kernels cost what they do on the target.
+* The counts are host TSC cycles, or ns off x86. They are for comparing the kernels with
+* each other and with the old path, not target cycles.
+* Run with make bench, it is not a pass or fail test.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_UNIT "host TSC cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+#include "arm_math.h"
+static q31_t benchSinQ31(q31_t x);
+#define arm_sin_q31 benchSinQ31
+#include "../source/SineGeneration.c"
+#undef arm_sin_q31
+#include "dma_host.h"
+
+#define BENCH_BLOCKS    64U
+#define BENCH_RUNS      15U
+#define BENCH_FS        48000U
+#define BENCH_FREQ      1000U
+#define BENCH_LEVEL     10U
+#define SIN_TABLE_BITS  9U
+#define SIN_TABLE_SIZE  (1U << SIN_TABLE_BITS)
+#define OLD_TS          44739           /* 2^31/48000, the original phase step */
+#define M4_SINE_CYCLES  60U             /* Plain sine sample on the target, estimated */
+#define MT_LOAD_SHARE   50U             /* Percent of a sample period for the kernel */
+#define MT_TONE_STEP    1400U           /* Hz between tones, all under 24kHz */
+
+static const char *const waveNames[WAVE_NUM] =
+    {"sine", "triangle", "saw", "ramp", "square", "arb", "multi", "white", "pink"};
+static q31_t sinTable[SIN_TABLE_SIZE + 1];
+static HOST_TASK genTask;
+static INT16U capture[SAMPLES_PER_BLOCK];
+static INT16U benchOut[SAMPLES_PER_BLOCK];
+static INT16U arbTable[AWG_MAX_SAMPLES];
+
+/* Table sine as CMSIS arm_sin_q31(), x is 0 to 2^31 for a full turn */
+static q31_t benchSinQ31(q31_t x){
+    INT32U index = (INT32U)x >> (31 - SIN_TABLE_BITS);
+    q31_t fract = (q31_t)(((INT32U)x << SIN_TABLE_BITS) & 0x7FFFFFFFU);
+    q31_t a = sinTable[index];
+    q31_t b = sinTable[index + 1];
+    return (q31_t)(a + (((INT64S)(b - a) * fract) >> 31));
+}
+static void benchSinInit(void){
+    for(INT32U k = 0; k <= SIN_TABLE_SIZE; k++){
+        double v = sin(2.0 * M_PI * k / SIN_TABLE_SIZE) * 2147483647.0;
+        sinTable[k] = (q31_t)floor(v + 0.5);
+    }
+}
+/* Time stamp, TSC cycles on x86, ns elsewhere */
+static INT64U benchNow(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();           /* x86intrin.h clashes with the CMSIS __I */
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((INT64U)ts.tv_sec * 1000000000U) + (INT64U)ts.tv_nsec;
+#endif
+}
+/* The sine loop of sineGenTask before the waveform kernels, 03/03/2022 */
+static void oldSinePath(INT16U *out, INT8U level, INT16U frequency, INT32U *argument){
+    INT32U sine_val;
+    for(INT16U i=0; i<SAMPLES_PER_BLOCK; i++){
+        sine_val = benchSinQ31((q31_t)*argument);
+        if((sine_val & BIT31_MASK) > 0){
+            sine_val = (~sine_val & (~BIT31_MASK));
+            sine_val = ((sine_val + 0x8000U) >> 15);
+            sine_val = (sine_val) * (AMP_SCALE*level);
+            sine_val = ((sine_val + 0x100000U) >> 20);
+            out[i] = (DC_OFF - ((INT16U)(sine_val)));
+        }else{
+            sine_val = ((sine_val + 0x8000U) >> 15);
+            sine_val = (sine_val) * (AMP_SCALE*level);
+            sine_val = ((sine_val + 0x100000U) >> 20);
+            out[i] = ((INT16U)sine_val + DC_OFF);
+        }
+        *argument = ((*argument + (OLD_TS*frequency)) & (~BIT31_MASK));
+    }
+}
+/* sineGenTask makes a block at the settings, which leaves sineWs set up for them */
+static void benchSetup(WAVE_T wave, INT8U level, DITHER_MODE dither){
+    WaveformSetType(wave);
+    SinewaveSetLevel(level);
+    DitherSet(dither);
+    HostDmaCapture(&genTask, capture, SAMPLES_PER_BLOCK);
+}
+/* Least cost per sample of kernel over BENCH_RUNS */
+static double benchKernel(WAVE_KERNEL kernel){
+    INT64U t;
+    INT64U best = ~(INT64U)0;
+    kernel(benchOut, &sineWs);
+    for(INT32U r = 0; r < BENCH_RUNS; r++){
+        t = benchNow();
+        for(INT32U b = 0; b < BENCH_BLOCKS; b++){
+            kernel(benchOut, &sineWs);
+        }
+        t = benchNow() - t;
+        best = (t < best) ? t : best;
+    }
+    return (double)best / (BENCH_BLOCKS * SAMPLES_PER_BLOCK);
+}
+static double benchOld(INT8U level){
+    INT64U t;
+    INT64U best = ~(INT64U)0;
+    INT32U argument = 0;
+    for(INT32U r = 0; r < BENCH_RUNS; r++){
+        t = benchNow();
+        for(INT32U b = 0; b < BENCH_BLOCKS; b++){
+            oldSinePath(benchOut, level, BENCH_FREQ, &argument);
+        }
+        t = benchNow() - t;
+        best = (t < best) ? t : best;
+    }
+    return (double)best / (BENCH_BLOCKS * SAMPLES_PER_BLOCK);
+}
+
+static double benchWaves(void){
+    double old;
+    double plain;
+    double dith;
+    old = benchOld(BENCH_LEVEL);
+    printf("per sample at level %u, %uHz, %ukHz\n", BENCH_LEVEL, BENCH_FREQ, BENCH_FS / 1000);
+    printf("%-10s %9s %9s %7s %7s\n", "kernel", "plain", "dithered", "plain", "dither");
+    printf("%-10s %9.2f %9s %6.2fx %7s\n", "old sine", old, "-", 1.0, "-");
+    for(INT8U w = 0; w < WAVE_NUM; w++){
+        benchSetup((WAVE_T)w, BENCH_LEVEL, DITHER_OFF);
+        plain = benchKernel(wavePlainKernels[w]);
+        benchSetup((WAVE_T)w, BENCH_LEVEL, DITHER_TPDF);
+        dith = benchKernel(waveKernels[w]);
+        printf("%-10s %9.2f %9.2f %6.2fx %6.2fx\n", waveNames[w], plain, dith, plain / old, dith / old);
+    }
+    return old;
+}
+
+static void benchLevels(void){
+    static const INT8U levels[] = {0, SINE_LEVEL_MAX / 2, SINE_LEVEL_MAX};
+    double old;
+    double plain;
+    double dith;
+    printf("sine per sample by level, through waveKernelSelect()\n");
+    printf("%-6s %9s %9s %9s %7s %7s\n", "level", "old", "plain", "dithered", "plain", "dither");
+    for(INT8U k = 0; k < (sizeof(levels) / sizeof(levels[0])); k++){
+        old = benchOld(levels[k]);
+        benchSetup(WAVE_SINE, levels[k], DITHER_OFF);
+        plain = benchKernel(waveKernelSelect(WAVE_SINE, &sineWs));
+        benchSetup(WAVE_SINE, levels[k], DITHER_TPDF);
+        dith = benchKernel(waveKernelSelect(WAVE_SINE, &sineWs));
+        printf("%-6u %9.2f %9.2f %9.2f %6.2fx %6.2fx\n", levels[k], old, plain, dith, plain / old, dith / old);
+    }
+}
+
+static void benchMod(void){
+    static const char *const modNames[MOD_NUM] = {"off", "AM", "FM", "PM"};
+    static const INT16U modDepth[MOD_NUM] = {0, MOD_AM_MAX, BENCH_FREQ, MOD_PM_MAX};
+    MOD_CFG cfg;
+    double old;
+    double t[3];
+    old = benchOld(SINE_LEVEL_MAX);
+    printf("waveSineMod per sample at level %u, %u.%uHz rate, largest depth\n", SINE_LEVEL_MAX,
+           MOD_RATE_MAX / 10, MOD_RATE_MAX % 10);
+    printf("%-6s %9s %9s %9s %7s\n", "mod", "sine lfo", "square", "triangle", "worst");
+    for(INT8U m = MOD_AM; m < MOD_NUM; m++){
+        for(INT8U k = 0; k < 3; k++){
+            cfg.type = (MOD_TYPE)m;
+            cfg.shape = (LFO_SHAPE)k;
+            cfg.rate_dhz = MOD_RATE_MAX;
+            cfg.depth = modDepth[m];
+            ModulationSet(&cfg);
+            benchSetup(WAVE_SINE, SINE_LEVEL_MAX, DITHER_OFF);
+            t[k] = benchKernel(waveSineMod);
+        }
+        printf("%-6s %9.2f %9.2f %9.2f %6.2fx\n", modNames[m], t[LFO_SINE], t[LFO_SQUARE], t[LFO_TRIANGLE],
+               fmax(t[LFO_SINE], fmax(t[LFO_SQUARE], t[LFO_TRIANGLE])) / old);
+    }
+    cfg.type = MOD_OFF;
+    ModulationSet(&cfg);
+}
+
+/* Tones that fit MT_LOAD_SHARE of a sample period at fs, target cycles */
+static double benchMultiFit(INT32U fs, double fixed, double tone){
+    return ((((double)SYSTEM_CLOCK / fs) * MT_LOAD_SHARE / 100.0) - fixed) / tone;
+}
+static void benchMulti(void){
+    MT_TONE tones[MT_MAX_TONES];
+    double t[MT_MAX_TONES + 1];
+    double sine;
+    double sx = 0.0;
+    double sy = 0.0;
+    double sxx = 0.0;
+    double sxy = 0.0;
+    double tone;
+    double fixed;
+    INT8U n;
+
+    benchSetup(WAVE_SINE, BENCH_LEVEL, DITHER_OFF);
+    sine = benchKernel(wavePlainKernels[WAVE_SINE]);
+    for(n = 0; n < MT_MAX_TONES; n++){
+        tones[n].freq = (INT16U)(500U + (MT_TONE_STEP * n));
+        tones[n].amp = MT_AMP_MAX;
+        tones[n].phase_deg = 0;
+    }
+    printf("waveMulti per sample at %ukHz\n", BENCH_FS / 1000);
+    for(n = 1; n <= MT_MAX_TONES; n++){
+        (void)MultitoneSet(tones, n, TRUE);
+        benchSetup(WAVE_MULTI, BENCH_LEVEL, DITHER_OFF);
+        t[n] = benchKernel(waveMulti);
+        printf("%2u tones %9.2f\n", n, t[n]);
+        sx += n;
+        sy += t[n];
+        sxx += (double)n * n;
+        sxy += n * t[n];
+    }
+    tone = (MT_MAX_TONES * sxy - sx * sy) / (MT_MAX_TONES * sxx - sx * sx);
+    fixed = (sy - tone * sx) / MT_MAX_TONES;
+    printf("per tone %.2f, %.2f plain sine samples, fixed %.2f, %.2f plain sine samples\n",
+           tone, tone / sine, fixed, fixed / sine);
+    tone = (tone / sine) * M4_SINE_CYCLES;
+    fixed = (fixed / sine) * M4_SINE_CYCLES;
+    printf("target at %u cycles a sine: %.0f cycles a tone, %u%% of a period fits %.1f tones at "
+           "48kHz, %.1f at 200kHz\n", M4_SINE_CYCLES, tone, MT_LOAD_SHARE,
+           benchMultiFit(48000, fixed, tone), benchMultiFit(200000, fixed, tone));
+}
+
+int main(void){
+    benchSinInit();
+    for(INT32U i = 0; i < AWG_MAX_SAMPLES; i++){    /* A sine period for the arb kernel */
+        arbTable[i] = (INT16U)(DC_OFF + (INT32S)floor(sin(2.0 * M_PI * i / AWG_MAX_SAMPLES) * 1000.0 + 0.5));
+    }
+    SineGenInit();
+    HostTaskStart(&genTask, sineGenTask);
+    SampleRateSet(BENCH_FS);
+    SinewaveSetFreq(BENCH_FREQ);
+    (void)AwgLoadBegin(AWG_MAX_SAMPLES);
+    (void)AwgLoadChunk(arbTable, AWG_MAX_SAMPLES);
+    (void)AwgLoadCommit();
+    printf("units: %s\n", BENCH_UNIT);
+    (void)benchWaves();
+    benchLevels();
+    benchMod();
+    benchMulti();
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*****************************************************************************************
+* spectrum.c - Power spectra of captured DAC codes, see spectrum.h
+* 10/19/2026
+*****************************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include "MCUType.h"
+#include "spectrum.h"
+
+void SpecFft(double *re, double *im, INT32U n){
+    INT32U j = 0;
+    double t;
+    for(INT32U i = 1; i < n; i++){             /* Bit reversed order */
+        INT32U bit = n >> 1;
+        for(; (j & bit) != 0; bit >>= 1){
+            j ^= bit;
+        }
+        j |= bit;
+        if(i < j){
+            t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }else{
+        }
+    }
+    for(INT32U len = 2; len <= n; len <<= 1){
+        double ang = -2.0 * M_PI / (double)len;
+        for(INT32U i = 0; i < n; i += len){
+            for(INT32U k = 0; k < (len / 2); k++){
+                double wr = cos(ang * k);
+                double wi = sin(ang * k);
+                INT32U a = i + k;
+                INT32U b = a + len / 2;
+                double xr = re[b] * wr - im[b] * wi;
+                double xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+void SpecAddPower(const INT16U *x, INT32U n, INT8U hann, double *power){
+    double *re = malloc(n * sizeof(double));
+    double *im = malloc(n * sizeof(double));
+    double mean = 0.0;
+    for(INT32U i = 0; i < n; i++){
+        mean += x[i];
+    }
+    mean /= n;
+    for(INT32U i = 0; i < n; i++){
+        re[i] = x[i] - mean;
+        if(hann){
+            re[i] *= 0.5 - 0.5 * cos(2.0 * M_PI * i / n);
+        }else{
+        }
+        im[i] = 0.0;
+    }
+    SpecFft(re, im, n);
+    for(INT32U k = 0; k <= (n / 2); k++){
+        power[k] += re[k] * re[k] + im[k] * im[k];
+    }
+    free(re);
+    free(im);
+}
+double SpecBand(const double *power, INT32U lo, INT32U hi){
+    double sum = 0.0;
+    for(INT32U k = lo; k <= hi; k++){
+        sum += power[k];
+    }
+    return sum;
+}
+double SpecDb(double num, double den){
+    return 10.0 * log10(num / den);
+}
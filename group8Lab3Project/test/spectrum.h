@@ -0,0 +1,16 @@
+/*****************************************************************************************
+* spectrum.h - Power spectra of captured DAC codes for the host tests
+* 10/19/2026
+*****************************************************************************************/
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+/* In place radix-2 FFT, n a power of two */
+void SpecFft(double *re, double *im, INT32U n);
+/* Adds the power of bins 0 to n/2 of n codes, mean removed, Hann window if hann */
+void SpecAddPower(const INT16U *x, INT32U n, INT8U hann, double *power);
+/* Power of bins lo to hi inclusive */
+double SpecBand(const double *power, INT32U lo, INT32U hi);
+/* Power ratio in dB */
+double SpecDb(double num, double den);
+#endif /* SPECTRUM_H_ */
@@ -0,0 +1,12 @@
+/*****************************************************************************************
+* app_cfg.h - The target configuration with the host test changes
+* The LCD is the LcdEmu controller, there is no PORTD bus on the host.
+* 10/19/2026
+*****************************************************************************************/
+#ifndef HOST_APP_CFG_H_
+#define HOST_APP_CFG_H_
+#include "../../uCOS/uC-CFG/app_cfg.h"
+
+#undef APP_CFG_LCD_EMU_EN
+#define APP_CFG_LCD_EMU_EN                         DEF_ENABLED
+#endif /* HOST_APP_CFG_H_ */
@@ -0,0 +1,15 @@
+/*****************************************************************************************
+* arm_math.h - The CMSIS-DSP calls of the host test build
+* The real header needs an Arm target. arm_sin_q31() is computed with sin() in
+* arm_math_host.c, exact to the last bit, so a measurement shows the kernel and the
+* quantiser and not the library's table.
+* 10/19/2026
+*****************************************************************************************/
+#ifndef HOST_ARM_MATH_H_
+#define HOST_ARM_MATH_H_
+#include <stdint.h>
+
+typedef int32_t q31_t;
+
+q31_t arm_sin_q31(q31_t x);                 /* x is 0 to 2^31 for a full turn */
+#endif /* HOST_ARM_MATH_H_ */
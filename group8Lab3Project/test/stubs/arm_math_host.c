@@ -0,0 +1,16 @@
+/*****************************************************************************************
+* arm_math_host.c - CMSIS-DSP calls of the host test build, see arm_math.h
+* 10/19/2026
+*****************************************************************************************/
+#include <math.h>
+#include "arm_math.h"
+
+q31_t arm_sin_q31(q31_t x){
+    double s = sin((double)(uint32_t)x * (2.0 * M_PI / 2147483648.0));
+    double v = floor(s * 2147483648.0 + 0.5);
+    if(v > 2147483647.0){
+        v = 2147483647.0;
+    }else{
+    }
+    return (q31_t)v;
+}
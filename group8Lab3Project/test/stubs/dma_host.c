@@ -0,0 +1,67 @@
+/*****************************************************************************************
+* dma_host.c - DMA.c of the host test build, see dma_host.h
+* 10/19/2026
+*****************************************************************************************/
+#include "MCUType.h"
+#include "os.h"
+#include "dma_host.h"
+
+static INT16U *dmaCapture;
+static INT32U dmaWant;
+static INT32U dmaHave;
+static INT32U dmaSeq;
+static INT32U dmaFs = DMA_FS_DEFAULT;
+
+void HostDmaCapture(HOST_TASK *task, INT16U *buf, INT32U n){
+    dmaCapture = buf;
+    dmaWant = n;
+    dmaHave = 0;
+    HostTaskResume(task);
+}
+void DMAInit(void){}
+void DMASetConsumer(OS_TCB *tcb){ (void)tcb; }
+INT8U DMAReadyPend(OS_TICK tout, DMA_BLOCK_INFO *info, OS_ERR *os_err_ptr){
+    (void)tout;
+    while((dmaHave >= dmaWant) && HostBlock()){
+    }
+    info->index = (INT8U)(dmaSeq % NUM_BLOCKS);
+    info->seq = dmaSeq;
+    info->tick = hostTick;
+    info->dual = FALSE;
+    dmaSeq++;
+    *os_err_ptr = OS_ERR_NONE;
+    return info->index;
+}
+void DMAGetStats(DMA_STATS *stats){
+    stats->released = dmaSeq;
+    stats->dropped = 0;
+    stats->missed = 0;
+    stats->last_lag = 0;
+    stats->max_lag = 0;
+}
+INT8U DMAPlayLoop(const INT16U *table, INT16U length){ (void)table; (void)length; return FALSE; }
+INT8U DMAPlayBlocks(void){ return TRUE; }
+INT8U DMALoopPending(void){ return FALSE; }
+const INT16U *DMALoopPlaying(void){ return (const INT16U *)0; }
+void DMASetMarker(INT8U index, INT16U offset, INT8U level){ (void)index; (void)offset; (void)level; }
+void DMASetSampleRate(INT8U index, INT32U fs){ (void)index; dmaFs = fs; }
+INT32U DMAGetSampleRate(void){ return dmaFs; }
+INT8U DMABurstArm(const INT16U *buf, INT16U length, INT8U gated){ (void)buf; (void)length; (void)gated; return FALSE; }
+void DMABurstDisarm(void){}
+INT8U DMABurstBusy(void){ return FALSE; }
+void DMABurstFire(void){}
+void DMABurstGateClose(void){}
+void DMABurstSetTrigger(INT8U sources, INT16U period_ms){ (void)sources; (void)period_ms; }
+void DMAFillBuffer(INT8U index, INT16U *samples){
+    (void)index;
+    for(INT16U i = 0; (i < SAMPLES_PER_BLOCK) && (dmaHave < dmaWant); i++){
+        dmaCapture[dmaHave] = samples[i];
+        dmaHave++;
+    }
+}
+INT8U DMASetDual(INT8U on){ (void)on; return FALSE; }
+INT8U DMADualActive(void){ return FALSE; }
+void DMAFillFrames(INT8U index, const INT16U *dac0, const INT16U *dac1){
+    (void)dac1;
+    DMAFillBuffer(index, (INT16U *)dac0);
+}
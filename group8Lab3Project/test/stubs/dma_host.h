@@ -0,0 +1,14 @@
+/*****************************************************************************************
+* dma_host.h - DMA.h of the host test build, blocks go to a capture buffer
+* DMAReadyPend() releases blocks while HostDmaCapture() wants samples and blocks the
+* consumer task otherwise. Filled blocks are appended to the capture in fill order.
+* There are no table loops, bursts or dual output, as with the DAC buffer build.
+* 10/19/2026
+*****************************************************************************************/
+#ifndef HOST_DMA_H_
+#define HOST_DMA_H_
+#include "DMA.h"
+
+/* Runs task, a consumer blocked in DMAReadyPend(), until n samples are in buf */
+void HostDmaCapture(HOST_TASK *task, INT16U *buf, INT32U n);
+#endif /* HOST_DMA_H_ */
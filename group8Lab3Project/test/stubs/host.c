@@ -0,0 +1,28 @@
+/*****************************************************************************************
+* host.c - RAM for the peripherals host.h moves off the bus
+* 10/19/2026
+*****************************************************************************************/
+#include "MCUType.h"
+
+FTM_Type hostFTM3;
+SIM_Type hostSIM;
+DMA_Type hostDMA0;
+DMAMUX_Type hostDMAMUX;
+DAC_Type hostDAC0;
+DAC_Type hostDAC1;
+PIT_Type hostPIT;
+PDB_Type hostPDB0;
+PORT_Type hostPORTA;
+PORT_Type hostPORTB;
+PORT_Type hostPORTC;
+PORT_Type hostPORTD;
+PORT_Type hostPORTE;
+GPIO_Type hostGPIOA;
+GPIO_Type hostGPIOB;
+GPIO_Type hostGPIOC;
+GPIO_Type hostGPIOD;
+GPIO_Type hostGPIOE;
+TSI_Type hostTSI0;
+UART_Type hostUART2;
+CoreDebug_Type hostCoreDebug;
+DWT_Type hostDWT;
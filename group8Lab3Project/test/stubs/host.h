@@ -0,0 +1,109 @@
+/*****************************************************************************************
+* host.h - Force included by the host test build in place of MCUType.h
+* The device header gives the register layouts and field macros. Peripherals the modules
+* under test touch are moved to RAM, the NVIC calls do nothing and the types are the
+* 32 bit widths of the K65, long is 64 bits on the host.
+* 10/19/2026
+*****************************************************************************************/
+#ifndef HOST_H_
+#define HOST_H_
+#include <stdint.h>
+#include "MK65F18.h"
+
+#define MCU_TYPE_PRESENT                /* MCUType.h is empty after this */
+#define ARM_MATH_CM4
+
+typedef char                INT8C;
+typedef uint8_t             INT8U;
+typedef int8_t              INT8S;
+typedef uint16_t            INT16U;
+typedef int16_t             INT16S;
+typedef uint32_t            INT32U;
+typedef int32_t             INT32S;
+typedef uint64_t            INT64U;
+typedef int64_t             INT64S;
+typedef float               FP32;
+typedef double              FP64;
+
+#define FALSE    0
+#define TRUE     1
+/*****************************************************************************************
+* Peripherals in RAM, defined in host.c
+*****************************************************************************************/
+extern FTM_Type hostFTM3;
+extern SIM_Type hostSIM;
+extern DMA_Type hostDMA0;
+extern DMAMUX_Type hostDMAMUX;
+extern DAC_Type hostDAC0;
+extern DAC_Type hostDAC1;
+extern PIT_Type hostPIT;
+extern PDB_Type hostPDB0;
+extern PORT_Type hostPORTA;
+extern PORT_Type hostPORTB;
+extern PORT_Type hostPORTC;
+extern PORT_Type hostPORTD;
+extern PORT_Type hostPORTE;
+extern GPIO_Type hostGPIOA;
+extern GPIO_Type hostGPIOB;
+extern GPIO_Type hostGPIOC;
+extern GPIO_Type hostGPIOD;
+extern GPIO_Type hostGPIOE;
+extern TSI_Type hostTSI0;
+extern UART_Type hostUART2;
+extern CoreDebug_Type hostCoreDebug;
+extern DWT_Type hostDWT;
+#undef FTM3
+#define FTM3 (&hostFTM3)
+#undef SIM
+#define SIM (&hostSIM)
+#undef DMA0
+#define DMA0 (&hostDMA0)
+#undef DMAMUX
+#define DMAMUX (&hostDMAMUX)
+#undef DAC0
+#define DAC0 (&hostDAC0)
+#undef DAC1
+#define DAC1 (&hostDAC1)
+#undef PIT
+#define PIT (&hostPIT)
+#undef PDB0
+#define PDB0 (&hostPDB0)
+#undef PORTA
+#define PORTA (&hostPORTA)
+#undef PORTB
+#define PORTB (&hostPORTB)
+#undef PORTC
+#define PORTC (&hostPORTC)
+#undef PORTD
+#define PORTD (&hostPORTD)
+#undef PORTE
+#define PORTE (&hostPORTE)
+#undef GPIOA
+#define GPIOA (&hostGPIOA)
+#undef GPIOB
+#define GPIOB (&hostGPIOB)
+#undef GPIOC
+#define GPIOC (&hostGPIOC)
+#undef GPIOD
+#define GPIOD (&hostGPIOD)
+#undef GPIOE
+#define GPIOE (&hostGPIOE)
+#undef TSI0
+#define TSI0 (&hostTSI0)
+#undef UART2
+#define UART2 (&hostUART2)
+#undef CoreDebug
+#define CoreDebug (&hostCoreDebug)
+#undef DWT
+#define DWT (&hostDWT)
+
+#undef NVIC_EnableIRQ
+#define NVIC_EnableIRQ(irq) ((void)(irq))
+#undef NVIC_DisableIRQ
+#define NVIC_DisableIRQ(irq) ((void)(irq))
+#undef NVIC_ClearPendingIRQ
+#define NVIC_ClearPendingIRQ(irq) ((void)(irq))
+#undef NVIC_SetPriority
+#define NVIC_SetPriority(irq, prio) ((void)(irq), (void)(prio))
+
+#endif /* HOST_H_ */
@@ -0,0 +1,6 @@
+/*****************************************************************************************
+* k65TWR_GPIO.h - Some modules include the board header by this name, the host file
+* system is case sensitive
+* 10/19/2026
+*****************************************************************************************/
+#include "K65TWR_GPIO.h"
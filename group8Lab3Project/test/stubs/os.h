@@ -0,0 +1,117 @@
+/*****************************************************************************************
+* os.h - uC/OS-III as seen by the modules in the host test build
+* Mutexes and critical sections do nothing. A task started with HostTaskStart() runs on
+* its own stack until it pends on something that is not there, then the test carries
+* on, HostTaskResume() runs it again. Pends outside a task, or non-blocking, time out.
+* There is one task queue, filled by OSTaskQPost() or HostQPost(), and one task
+* semaphore, enough for one consumer of each. OSTimeGet() returns hostTick, set by the
+* test, and timeouts are not counted.
+* 10/19/2026
+*****************************************************************************************/
+#ifndef HOST_OS_H_
+#define HOST_OS_H_
+#include <stddef.h>
+#include <ucontext.h>
+
+#define DEF_DISABLED                0u
+#define DEF_ENABLED                 1u
+#define DEF_FALSE                   0u
+#define DEF_TRUE                    1u
+
+typedef unsigned int    CPU_INT32U;
+typedef unsigned int    CPU_TS;
+typedef unsigned int    CPU_STK;
+typedef unsigned int    CPU_STK_SIZE;
+typedef unsigned int    CPU_SR;
+typedef char            CPU_CHAR;
+typedef unsigned char   CPU_BOOLEAN;
+typedef unsigned int    OS_TICK;
+typedef unsigned int    OS_FLAGS;
+typedef unsigned int    OS_OPT;
+typedef unsigned int    OS_MSG_QTY;
+typedef unsigned int    OS_MSG_SIZE;
+typedef unsigned char   OS_PRIO;
+typedef unsigned int    OS_SEM_CTR;
+typedef void          (*OS_TASK_PTR)(void *p_arg);
+
+typedef enum {OS_ERR_NONE = 0, OS_ERR_TIMEOUT = 29401, OS_ERR_Q_MAX = 24902} OS_ERR;
+
+typedef struct {int unused;} OS_MUTEX;
+typedef struct {OS_SEM_CTR ctr;} OS_SEM;
+typedef struct {OS_FLAGS flags;} OS_FLAG_GRP;
+typedef struct {int unused;} OS_TCB;
+
+#define OS_OPT_NONE                 0x0000u
+#define OS_OPT_PEND_BLOCKING        0x0000u
+#define OS_OPT_PEND_NON_BLOCKING    0x8000u
+#define OS_OPT_PEND_FLAG_SET_ANY    0x0008u
+#define OS_OPT_PEND_FLAG_CONSUME    0x0100u
+#define OS_OPT_POST_NONE            0x0000u
+#define OS_OPT_POST_1               0x0000u
+#define OS_OPT_POST_FIFO            0x0000u
+#define OS_OPT_POST_FLAG_SET        0x0000u
+#define OS_OPT_TASK_NONE            0x0000u
+#define OS_OPT_TASK_STK_CHK         0x0001u
+#define OS_OPT_TASK_STK_CLR         0x0002u
+#define OS_OPT_TIME_DLY             0x0000u
+#define OS_OPT_TIME_PERIODIC        0x0004u
+
+#define CPU_SR_ALLOC()              CPU_SR cpu_sr = 0u
+#define CPU_CRITICAL_ENTER()        ((void)cpu_sr)
+#define CPU_CRITICAL_EXIT()         ((void)cpu_sr)
+#define OS_CRITICAL_ENTER()
+#define OS_CRITICAL_EXIT()
+#define CPU_IntDis()
+#define CPU_IntEn()
+
+/*****************************************************************************************
+* Host tasks
+*****************************************************************************************/
+#define HOST_TASK_STK_SIZE 65536
+typedef struct{
+    ucontext_t ctx;
+    ucontext_t ret;
+    OS_TASK_PTR task;
+    char stk[HOST_TASK_STK_SIZE];
+}HOST_TASK;
+
+void  HostTaskStart(HOST_TASK *task, OS_TASK_PTR fn);   /* Runs fn until it blocks */
+void  HostTaskResume(HOST_TASK *task);                  /* Runs it until it blocks again */
+INT8U HostBlock(void);                                  /* FALSE outside a task */
+void  HostQPost(void *msg);
+void  HostQFlush(void);
+void  HostQSetSize(OS_MSG_QTY size);                    /* OSTaskQPost() fails when full */
+
+extern OS_TICK hostTick;
+
+/*****************************************************************************************
+* uC/OS-III calls
+*****************************************************************************************/
+void  OSInit(OS_ERR *p_err);
+void  OSStart(OS_ERR *p_err);
+void  OSMutexCreate(OS_MUTEX *p_mutex, CPU_CHAR *p_name, OS_ERR *p_err);
+void  OSMutexPend(OS_MUTEX *p_mutex, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+void  OSMutexPost(OS_MUTEX *p_mutex, OS_OPT opt, OS_ERR *p_err);
+void  OSSemCreate(OS_SEM *p_sem, CPU_CHAR *p_name, OS_SEM_CTR cnt, OS_ERR *p_err);
+OS_SEM_CTR OSSemPend(OS_SEM *p_sem, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+OS_SEM_CTR OSSemPost(OS_SEM *p_sem, OS_OPT opt, OS_ERR *p_err);
+void  OSSemSet(OS_SEM *p_sem, OS_SEM_CTR cnt, OS_ERR *p_err);
+void  OSFlagCreate(OS_FLAG_GRP *p_grp, CPU_CHAR *p_name, OS_FLAGS flags, OS_ERR *p_err);
+OS_FLAGS OSFlagPend(OS_FLAG_GRP *p_grp, OS_FLAGS flags, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+OS_FLAGS OSFlagPost(OS_FLAG_GRP *p_grp, OS_FLAGS flags, OS_OPT opt, OS_ERR *p_err);
+void  OSTaskCreate(OS_TCB *p_tcb, CPU_CHAR *p_name, OS_TASK_PTR p_task, void *p_arg,
+                   OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_limit,
+                   CPU_STK_SIZE stk_size, OS_MSG_QTY q_size, OS_TICK time_quanta,
+                   void *p_ext, OS_OPT opt, OS_ERR *p_err);
+void  OSTaskDel(OS_TCB *p_tcb, OS_ERR *p_err);
+void *OSTaskQPend(OS_TICK timeout, OS_OPT opt, OS_MSG_SIZE *p_msg_size, CPU_TS *p_ts, OS_ERR *p_err);
+void  OSTaskQPost(OS_TCB *p_tcb, void *p_void, OS_MSG_SIZE msg_size, OS_OPT opt, OS_ERR *p_err);
+OS_MSG_QTY OSTaskQFlush(OS_TCB *p_tcb, OS_ERR *p_err);
+OS_SEM_CTR OSTaskSemPend(OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err);
+OS_SEM_CTR OSTaskSemPost(OS_TCB *p_tcb, OS_OPT opt, OS_ERR *p_err);
+void  OSTimeDly(OS_TICK dly, OS_OPT opt, OS_ERR *p_err);
+OS_TICK OSTimeGet(OS_ERR *p_err);
+void  OSIntEnter(void);
+void  OSIntExit(void);
+void  OS_CPU_SysTickInitFreq(CPU_INT32U cpu_freq);
+#endif /* HOST_OS_H_ */
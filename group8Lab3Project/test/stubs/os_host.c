@@ -0,0 +1,213 @@
+/*****************************************************************************************
+* os_host.c - The uC/OS-III calls of the host test build, see os.h
+* 10/19/2026
+*****************************************************************************************/
+#include "MCUType.h"
+#include "os.h"
+
+#define HOST_Q_SIZE 64
+
+OS_TICK hostTick;
+static void *hostQ[HOST_Q_SIZE];
+static INT32U hostQIn;
+static INT32U hostQOut;
+static OS_MSG_QTY hostQSize = HOST_Q_SIZE;
+static OS_SEM_CTR hostTaskSem;
+static HOST_TASK *hostCur;                  /* Task running, 0 for the test */
+
+static void hostTaskEntry(void);
+static INT8U hostPendBlocks(OS_OPT opt);
+
+void HostTaskStart(HOST_TASK *task, OS_TASK_PTR fn){
+    task->task = fn;
+    getcontext(&task->ctx);
+    task->ctx.uc_stack.ss_sp = task->stk;
+    task->ctx.uc_stack.ss_size = sizeof(task->stk);
+    task->ctx.uc_link = &task->ret;         /* A task that returns goes back too */
+    makecontext(&task->ctx, hostTaskEntry, 0);
+    HostTaskResume(task);
+}
+void HostTaskResume(HOST_TASK *task){
+    HOST_TASK *prev = hostCur;
+    hostCur = task;
+    swapcontext(&task->ret, &task->ctx);
+    hostCur = prev;
+}
+INT8U HostBlock(void){
+    INT8U blocked = FALSE;
+    if(hostCur != (HOST_TASK *)0){
+        swapcontext(&hostCur->ctx, &hostCur->ret);
+        blocked = TRUE;
+    }else{
+    }
+    return blocked;
+}
+static void hostTaskEntry(void){
+    hostCur->task((void *)0);
+}
+/* A blocking pend in a task waits for the test, anywhere else it times out */
+static INT8U hostPendBlocks(OS_OPT opt){
+    return ((opt & OS_OPT_PEND_NON_BLOCKING) == 0) && HostBlock();
+}
+
+void OSInit(OS_ERR *p_err){
+    *p_err = OS_ERR_NONE;
+}
+void OSStart(OS_ERR *p_err){
+    *p_err = OS_ERR_NONE;
+}
+void OSMutexCreate(OS_MUTEX *p_mutex, CPU_CHAR *p_name, OS_ERR *p_err){
+    (void)p_mutex; (void)p_name;
+    *p_err = OS_ERR_NONE;
+}
+void OSMutexPend(OS_MUTEX *p_mutex, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    (void)p_mutex; (void)timeout; (void)opt; (void)p_ts;
+    *p_err = OS_ERR_NONE;
+}
+void OSMutexPost(OS_MUTEX *p_mutex, OS_OPT opt, OS_ERR *p_err){
+    (void)p_mutex; (void)opt;
+    *p_err = OS_ERR_NONE;
+}
+void OSSemCreate(OS_SEM *p_sem, CPU_CHAR *p_name, OS_SEM_CTR cnt, OS_ERR *p_err){
+    (void)p_name;
+    p_sem->ctr = cnt;
+    *p_err = OS_ERR_NONE;
+}
+OS_SEM_CTR OSSemPend(OS_SEM *p_sem, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    (void)timeout; (void)p_ts;
+    while((p_sem->ctr == 0) && hostPendBlocks(opt)){
+    }
+    if(p_sem->ctr != 0){
+        p_sem->ctr--;
+        *p_err = OS_ERR_NONE;
+    }else{
+        *p_err = OS_ERR_TIMEOUT;
+    }
+    return p_sem->ctr;
+}
+OS_SEM_CTR OSSemPost(OS_SEM *p_sem, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    p_sem->ctr++;
+    *p_err = OS_ERR_NONE;
+    return p_sem->ctr;
+}
+void OSSemSet(OS_SEM *p_sem, OS_SEM_CTR cnt, OS_ERR *p_err){
+    p_sem->ctr = cnt;
+    *p_err = OS_ERR_NONE;
+}
+void OSFlagCreate(OS_FLAG_GRP *p_grp, CPU_CHAR *p_name, OS_FLAGS flags, OS_ERR *p_err){
+    (void)p_name;
+    p_grp->flags = flags;
+    *p_err = OS_ERR_NONE;
+}
+OS_FLAGS OSFlagPend(OS_FLAG_GRP *p_grp, OS_FLAGS flags, OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    OS_FLAGS rdy;
+    (void)timeout; (void)p_ts;
+    while(((p_grp->flags & flags) == 0) && hostPendBlocks(opt)){
+    }
+    rdy = p_grp->flags & flags;
+    if(rdy != 0){
+        if((opt & OS_OPT_PEND_FLAG_CONSUME) != 0){
+            p_grp->flags &= ~rdy;
+        }else{
+        }
+        *p_err = OS_ERR_NONE;
+    }else{
+        *p_err = OS_ERR_TIMEOUT;
+    }
+    return rdy;
+}
+OS_FLAGS OSFlagPost(OS_FLAG_GRP *p_grp, OS_FLAGS flags, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    p_grp->flags |= flags;
+    *p_err = OS_ERR_NONE;
+    return p_grp->flags;
+}
+void OSTaskCreate(OS_TCB *p_tcb, CPU_CHAR *p_name, OS_TASK_PTR p_task, void *p_arg,
+                  OS_PRIO prio, CPU_STK *p_stk_base, CPU_STK_SIZE stk_limit,
+                  CPU_STK_SIZE stk_size, OS_MSG_QTY q_size, OS_TICK time_quanta,
+                  void *p_ext, OS_OPT opt, OS_ERR *p_err){
+    (void)p_tcb; (void)p_name; (void)p_task; (void)p_arg; (void)prio; (void)p_stk_base;
+    (void)stk_limit; (void)stk_size; (void)q_size; (void)time_quanta; (void)p_ext; (void)opt;
+    *p_err = OS_ERR_NONE;                   /* Started by the test with HostTaskStart() */
+}
+void OSTaskDel(OS_TCB *p_tcb, OS_ERR *p_err){
+    (void)p_tcb;
+    *p_err = OS_ERR_NONE;
+}
+void *OSTaskQPend(OS_TICK timeout, OS_OPT opt, OS_MSG_SIZE *p_msg_size, CPU_TS *p_ts, OS_ERR *p_err){
+    void *msg = (void *)0;
+    (void)timeout; (void)p_ts;
+    while((hostQOut == hostQIn) && hostPendBlocks(opt)){
+    }
+    if(hostQOut != hostQIn){
+        msg = hostQ[hostQOut % HOST_Q_SIZE];
+        hostQOut++;
+        *p_msg_size = sizeof(void *);
+        *p_err = OS_ERR_NONE;
+    }else{
+        *p_msg_size = 0;
+        *p_err = OS_ERR_TIMEOUT;
+    }
+    return msg;
+}
+void OSTaskQPost(OS_TCB *p_tcb, void *p_void, OS_MSG_SIZE msg_size, OS_OPT opt, OS_ERR *p_err){
+    (void)p_tcb; (void)msg_size; (void)opt;
+    if((hostQIn - hostQOut) < hostQSize){
+        HostQPost(p_void);
+        *p_err = OS_ERR_NONE;
+    }else{
+        *p_err = OS_ERR_Q_MAX;
+    }
+}
+OS_MSG_QTY OSTaskQFlush(OS_TCB *p_tcb, OS_ERR *p_err){
+    OS_MSG_QTY n = (OS_MSG_QTY)(hostQIn - hostQOut);
+    (void)p_tcb;
+    HostQFlush();
+    *p_err = OS_ERR_NONE;
+    return n;
+}
+OS_SEM_CTR OSTaskSemPend(OS_TICK timeout, OS_OPT opt, CPU_TS *p_ts, OS_ERR *p_err){
+    (void)timeout; (void)p_ts;
+    while((hostTaskSem == 0) && hostPendBlocks(opt)){
+    }
+    if(hostTaskSem != 0){
+        hostTaskSem--;
+        *p_err = OS_ERR_NONE;
+    }else{
+        *p_err = OS_ERR_TIMEOUT;
+    }
+    return hostTaskSem;
+}
+OS_SEM_CTR OSTaskSemPost(OS_TCB *p_tcb, OS_OPT opt, OS_ERR *p_err){
+    (void)p_tcb; (void)opt;
+    hostTaskSem++;
+    *p_err = OS_ERR_NONE;
+    return hostTaskSem;
+}
+void OSTimeDly(OS_TICK dly, OS_OPT opt, OS_ERR *p_err){
+    (void)opt;
+    hostTick += dly;
+    *p_err = OS_ERR_NONE;
+}
+OS_TICK OSTimeGet(OS_ERR *p_err){
+    *p_err = OS_ERR_NONE;
+    return hostTick;
+}
+void OSIntEnter(void){
+}
+void OSIntExit(void){
+}
+void OS_CPU_SysTickInitFreq(CPU_INT32U cpu_freq){
+    (void)cpu_freq;
+}
+void HostQPost(void *msg){
+    hostQ[hostQIn % HOST_Q_SIZE] = msg;
+    hostQIn++;
+}
+void HostQFlush(void){
+    hostQOut = hostQIn;
+}
+void HostQSetSize(OS_MSG_QTY size){
+    hostQSize = (size > HOST_Q_SIZE) ? HOST_Q_SIZE : size;
+}
@@ -0,0 +1,157 @@
+/*****************************************************************************************
+* test_awg_load - ARB table frames over UART2 into AwgLoad*
+* Bytes go in through UART2_RX_TX_IRQHandler() with RDRF set, the last one of a frame
+* with IDLE too, and awgLoadTask is resumed after each so it drains the ring as it would
+* at its priority. Its reply is the byte it leaves in UART2->D. The AwgLoad* calls are
+* stubbed with the checks of SineGeneration.c and keep the committed table.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "../source/AwgLoader.c"
+
+static INT16U stageTbl[AWG_MAX_SAMPLES];
+static INT16U stageLen;
+static INT16U stagePos;
+static INT8U stageLoading;
+static INT8U swapPending;                   /* Committed, not yet swapped in */
+static INT32U commits;
+static HOST_TASK loadTask;
+static int fails;
+
+#define UART2_S1 (*(volatile INT8U *)&UART2->S1)   /* Read only on the target */
+
+INT8U AwgLoadBegin(INT16U length){
+    INT8U started = FALSE;
+    if((swapPending == FALSE) && (length != 0) && (length <= AWG_MAX_SAMPLES)){
+        stageLen = length;
+        stagePos = 0;
+        stageLoading = TRUE;
+        started = TRUE;
+    }else{
+    }
+    return started;
+}
+INT16U AwgLoadChunk(const INT16U *samples, INT16U count){
+    if(!stageLoading){
+        count = 0;
+    }else if(count > (stageLen - stagePos)){
+        count = stageLen - stagePos;
+    }else{
+    }
+    for(INT16U i = 0; i < count; i++){
+        stageTbl[stagePos + i] = samples[i] & 0x0FFF;
+    }
+    stagePos += count;
+    return count;
+}
+INT8U AwgLoadCommit(void){
+    INT8U committed = FALSE;
+    if(stageLoading && (stagePos == stageLen)){
+        stageLoading = FALSE;
+        swapPending = TRUE;
+        commits++;
+        committed = TRUE;
+    }else{
+    }
+    return committed;
+}
+
+static void check(int ok, const char *what){
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok){
+        fails++;
+    }else{
+    }
+}
+/* One received byte, returns the reply the task sent or 0 */
+static INT8U rxByte(INT8U byte, INT8U idle){
+    UART2_S1 = UART_S1_RDRF_MASK | (idle ? UART_S1_IDLE_MASK : 0);
+    UART2->D = byte;
+    UART2_RX_TX_IRQHandler();
+    UART2_S1 = UART_S1_TDRE_MASK;
+    UART2->D = 0;
+    HostTaskResume(&loadTask);
+    return UART2->D;
+}
+/* Frame of n samples, sum_err added to the checksum, returns the last reply */
+static INT8U sendFrame(const INT16U *samples, INT16U n, INT16U sum_err){
+    INT8U buf[8 + (2 * AWG_MAX_SAMPLES)];
+    INT32U len = 0;
+    INT16U sum = sum_err;
+    INT8U reply = 0;
+    INT8U r;
+    buf[len++] = 'A';
+    buf[len++] = 'W';
+    buf[len++] = (INT8U)n;
+    buf[len++] = (INT8U)(n >> 8);
+    for(INT16U i = 0; i < n; i++){
+        buf[len++] = (INT8U)samples[i];
+        buf[len++] = (INT8U)(samples[i] >> 8);
+        sum += samples[i];
+    }
+    buf[len++] = (INT8U)sum;
+    buf[len++] = (INT8U)(sum >> 8);
+    for(INT32U i = 0; i < len; i++){
+        r = rxByte(buf[i], i == (len - 1));
+        reply = (r != 0) ? r : reply;
+    }
+    return reply;
+}
+
+int main(void){
+    static INT16U tbl[AWG_MAX_SAMPLES];
+    AWG_LOAD_STATS stats;
+    INT8U reply;
+    INT32U bad;
+    INT16U len;
+
+    AwgLoaderInit();
+    HostTaskStart(&loadTask, awgLoadTask);
+    for(INT16U i = 0; i < AWG_MAX_SAMPLES; i++){
+        tbl[i] = (INT16U)((i * 37U) & 0x0FFF);
+    }
+    check(UART2->C2 == (UART_C2_TE_MASK|UART_C2_RE_MASK|UART_C2_RIE_MASK|UART_C2_ILIE_MASK),
+          "UART2 transmit, receive and receive interrupts on");
+    check(((UART2->BDL | ((UART2->BDH & UART_BDH_SBR_MASK) << 8)) == 32) &&
+          (UART2->C4 == UART_C4_BRFA(17)), "115200 from the 60MHz bus, SBR 32 BRFA 17/32");
+
+    reply = sendFrame(tbl, AWG_MAX_SAMPLES, 0);
+    bad = (stageLen != AWG_MAX_SAMPLES) || memcmp(stageTbl, tbl, sizeof(tbl));
+    check((reply == AWG_REPLY_OK) && (commits == 1) && !bad, "full table committed intact");
+
+    reply = sendFrame(tbl, 16, 0);
+    check((reply == AWG_REPLY_BUSY) && (commits == 1), "frame refused while the swap is pending");
+    swapPending = FALSE;
+
+    reply = sendFrame(tbl, 100, 1);
+    check((reply == AWG_REPLY_ERR) && (commits == 1), "bad checksum not committed");
+
+    (void)rxByte('x', FALSE);
+    (void)rxByte('A', FALSE);
+    (void)rxByte('A', FALSE);
+    (void)rxByte('q', FALSE);
+    reply = sendFrame(&tbl[5], 33, 0);
+    bad = (stageLen != 33) || memcmp(stageTbl, &tbl[5], 33 * sizeof(INT16U));
+    check((reply == AWG_REPLY_OK) && (commits == 2) && !bad, "noise before the frame skipped");
+    swapPending = FALSE;
+
+    len = AWG_MAX_SAMPLES + 1;
+    (void)rxByte('A', FALSE);
+    (void)rxByte('W', FALSE);
+    (void)rxByte((INT8U)len, FALSE);
+    reply = rxByte((INT8U)(len >> 8), TRUE);
+    check(reply == AWG_REPLY_ERR, "length over AWG_MAX_SAMPLES refused");
+    reply = sendFrame(tbl, 1, 0);
+    check((reply == AWG_REPLY_OK) && (commits == 3) && (stageLen == 1),
+          "next frame in step after a refused length");
+
+    AwgLoaderGetStats(&stats);
+    printf("loads %u busy %u errors %u timeouts %u overruns %u\n", (unsigned)stats.loads,
+           (unsigned)stats.busy, (unsigned)stats.errors, (unsigned)stats.timeouts,
+           (unsigned)stats.overruns);
+    check((stats.loads == 3) && (stats.busy == 1) && (stats.errors == 2) &&
+          (stats.overruns == 0), "counters");
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails != 0;
+}
@@ -0,0 +1,179 @@
+/*****************************************************************************************
+* test_burst_trigger - Time from a burst trigger to the first burst sample
+* PIT0 is modelled as a count of bus clocks, each time it reaches 0 the channel TCD of
+* DMA.c moves one sample, and at the end of a major loop loads the TCD at DLAST_SGA as
+* ESG does. The channel is put in loop mode on a one sample DC rest loop, as sineGenTask
+* rests between bursts, and a burst is armed with DMABurstArm().
+* SW2 edges come at random phases of the sample clock. PORTA_IRQHandler() runs
+* TRIG_LATENCY bus clocks after the edge and DB7 marks the PIT0 restart, as it does on
+* the scope. The edge to the first burst sample must be the same at every phase, two
+* sample periods after the restart. With the restart left out of the model the delay
+* spreads over a sample period, which is what the restart removes.
+* The memory TCD addresses are held in 32 bits by DMA.c, they are looked up the same
+* way here.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "../source/DMA.c"
+
+#define BURST_LEN     8U
+#define TRIALS        1000U
+#define TRIG_LATENCY  30U               /* Bus clocks, edge to the PIT0 restart */
+
+static const INT32U testRates[] = {8000, 48000, 200000};
+static INT16U restBuf[1] = {2048};
+static INT16U burstBuf[BURST_LEN];
+static INT64U busNow;                       /* Bus clocks */
+static INT64U pitNext;                      /* Next PIT0 trigger */
+static INT64U firstAt;                      /* First burst sample of the trial */
+static INT32U burstNext;                    /* Burst sample expected next */
+static INT32U burstBad;                     /* Burst samples out of order */
+static int fails;
+
+static void check(int ok, const char *what){
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok){
+        fails++;
+    }else{
+    }
+}
+/* The memory TCD DLAST_SGA points to, by its 32 bit address as DMA.c writes it */
+static DMA_TCD *tcdAt(INT32U sga){
+    DMA_TCD *tcd = (DMA_TCD *)0;
+    if(sga == (INT32U)&dmaBurstTcd){
+        tcd = &dmaBurstTcd;
+    }else if(sga == (INT32U)&dmaLoopTcd[0]){
+        tcd = &dmaLoopTcd[0];
+    }else if(sga == (INT32U)&dmaLoopTcd[1]){
+        tcd = &dmaLoopTcd[1];
+    }else{
+    }
+    return tcd;
+}
+static void tcdLoad(const DMA_TCD *tcd){
+    DMA0->TCD[DMA_CH].SADDR = tcd->saddr;
+    DMA0->TCD[DMA_CH].SOFF = (INT16U)tcd->soff;
+    DMA0->TCD[DMA_CH].ATTR = tcd->attr;
+    DMA0->TCD[DMA_CH].NBYTES_MLNO = tcd->nbytes;
+    DMA0->TCD[DMA_CH].SLAST = (INT32U)tcd->slast;
+    DMA0->TCD[DMA_CH].DADDR = tcd->daddr;
+    DMA0->TCD[DMA_CH].DOFF = (INT16U)tcd->doff;
+    DMA0->TCD[DMA_CH].CITER_ELINKNO = tcd->citer;
+    DMA0->TCD[DMA_CH].DLAST_SGA = (INT32U)tcd->dlast_sga;
+    DMA0->TCD[DMA_CH].CSR = tcd->csr;
+    DMA0->TCD[DMA_CH].BITER_ELINKNO = tcd->biter;
+}
+/* A PIT0 trigger, one minor loop of the channel */
+static void dmaRequest(void){
+    INT32U saddr = DMA0->TCD[DMA_CH].SADDR;
+    INT32U base = (INT32U)burstBuf;
+    INT16U citer;
+    if((saddr >= base) && (saddr < (base + (BURST_LEN * BYTES_PER_SAMPLE)))){
+        if(((saddr - base) / BYTES_PER_SAMPLE) != burstNext){
+            burstBad++;
+        }else{
+        }
+        if((burstNext == 0) && (firstAt == 0)){
+            firstAt = busNow;
+        }else{
+        }
+        burstNext = (burstNext + 1) % BURST_LEN;
+    }else{
+    }
+    DMA0->TCD[DMA_CH].SADDR = saddr + (INT32U)(INT16S)DMA0->TCD[DMA_CH].SOFF;
+    citer = (INT16U)(DMA0->TCD[DMA_CH].CITER_ELINKNO - 1);
+    if(citer != 0){
+        DMA0->TCD[DMA_CH].CITER_ELINKNO = citer;
+    }else if((DMA0->TCD[DMA_CH].CSR & DMA_CSR_ESG_MASK) != 0){
+        tcdLoad(tcdAt(DMA0->TCD[DMA_CH].DLAST_SGA));
+    }else{
+        DMA0->TCD[DMA_CH].SADDR += DMA0->TCD[DMA_CH].SLAST;
+        DMA0->TCD[DMA_CH].CITER_ELINKNO = DMA0->TCD[DMA_CH].BITER_ELINKNO;
+    }
+}
+/* Runs PIT0 and the channel to bus clock t */
+static void runTo(INT64U t){
+    while(pitNext <= t){
+        busNow = pitNext;
+        dmaRequest();
+        pitNext += PIT->CHANNEL[0].LDVAL + 1;
+    }
+    busNow = t;
+}
+/* Edge to first burst sample over TRIALS random phases, restart TRUE as DB7 shows it */
+static void trials(INT8U restart, INT64U *lo, INT64U *hi, INT32U *restarts){
+    INT32U period = PIT->CHANNEL[0].LDVAL + 1;
+    INT64U edge;
+    INT64U delay;
+    *lo = ~(INT64U)0;
+    *hi = 0;
+    *restarts = 0;
+    for(INT32U i = 0; i < TRIALS; i++){
+        runTo(busNow + (3U * period) + ((INT32U)rand() % period));
+        edge = busNow;
+        runTo(edge + TRIG_LATENCY);
+        firstAt = 0;
+        GPIOB->PSOR = 0;
+        PORTA->ISFR = GPIO_PIN(SW2_BIT);
+        PORTA_IRQHandler();
+        if(((GPIOB->PSOR & GPIO_PIN(DB7_BIT)) != 0) &&
+           (PIT->CHANNEL[0].TCTRL == PIT_TCTRL_TEN(1))){
+            (*restarts)++;
+            if(restart){
+                pitNext = busNow + period;          /* Counts down from LDVAL again */
+            }else{
+            }
+        }else{
+        }
+        runTo(busNow + ((BURST_LEN + 4U) * period));
+        delay = firstAt - edge;
+        *lo = (delay < *lo) ? delay : *lo;
+        *hi = (delay > *hi) ? delay : *hi;
+    }
+}
+
+static void testRate(INT32U fs){
+    INT32U period;
+    INT64U lo;
+    INT64U hi;
+    INT32U restarts;
+    char what[96];
+
+    PIT->CHANNEL[0].LDVAL = FS_LDVAL(fs);
+    period = FS_LDVAL(fs) + 1;
+    burstBad = 0;
+    trials(TRUE, &lo, &hi, &restarts);
+    printf("%6uHz restart: edge to first sample %llu to %llu bus clocks, %.3f to %.3fus, "
+           "%.2f periods after the restart\n", (unsigned)fs, (unsigned long long)lo,
+           (unsigned long long)hi, lo * 1e6 / BUS_FREQ, hi * 1e6 / BUS_FREQ,
+           (double)(lo - TRIG_LATENCY) / period);
+    snprintf(what, sizeof(what), "%uHz every trigger restarts PIT0 and plays the burst in order", (unsigned)fs);
+    check((restarts == TRIALS) && (burstBad == 0), what);
+    snprintf(what, sizeof(what), "%uHz first sample two periods after the restart, no jitter", (unsigned)fs);
+    check((lo == hi) && (lo == (TRIG_LATENCY + (2U * period))), what);
+    trials(FALSE, &lo, &hi, &restarts);
+    printf("%6uHz free running PIT0: %llu to %llu bus clocks, %llu of jitter in a %u period\n",
+           (unsigned)fs, (unsigned long long)lo, (unsigned long long)hi,
+           (unsigned long long)(hi - lo), (unsigned)period);
+}
+
+int main(void){
+    srand(1);
+    for(INT32U i = 0; i < BURST_LEN; i++){
+        burstBuf[i] = (INT16U)(1000U + i);
+    }
+    DMAInit();
+    dmaTcdInit(&dmaLoopTcd[0], restBuf, 1, DMA_LOOP_CSR);   /* The DC rest loop, playing */
+    dmaLoopTcd[0].dlast_sga = (INT32S)&dmaLoopTcd[0];
+    tcdLoad(&dmaLoopTcd[0]);
+    dmaMode = DMA_LOOP;
+    pitNext = PIT->CHANNEL[0].LDVAL + 1;
+    check(DMABurstArm(burstBuf, BURST_LEN, FALSE), "burst armed on the rest loop");
+    DMABurstSetTrigger(DMA_TRIG_SW2, 0);
+    for(INT32U k = 0; k < (sizeof(testRates) / sizeof(testRates[0])); k++){
+        testRate(testRates[k]);
+    }
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails != 0;
+}
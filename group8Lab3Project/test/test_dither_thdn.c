@@ -0,0 +1,105 @@
+/*****************************************************************************************
+* test_dither_thdn - THD+N of the sine kernel with each dither setting
+* sineGenTask runs as a host task and its blocks are captured, 2^16 samples of a 750Hz
+* sine at 48kHz, 64 samples a period, so every bin is exact without a window. The error
+* of plain rounding repeats every period and lands on the harmonics, dither turns it
+* into noise. Per setting and level:
+*   THD     harmonics 2 to 7, those below fs/8, to the fundamental
+*   THD+N   everything but DC and the fundamental
+*   N<fs/8  THD+N below 6kHz, where shaped dither moves its noise out of
+*   model   THD+N of ideal TPDF, 1/4 LSB^2 of noise, 1/12 rounding and 1/6 dither
+* Dither must take the harmonics of a small level down 20dB, TPDF must match the model
+* within 1dB and the shaped settings must lower the noise below fs/8.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include "../source/SineGeneration.c"
+#include "dma_host.h"
+#include "spectrum.h"
+
+#define TEST_FS     48000U
+#define TEST_FREQ   750U
+#define TEST_N      65536U
+#define TEST_K0     (TEST_FREQ * TEST_N / TEST_FS)  /* Fundamental bin, 1024 */
+#define TEST_HARM   7U                              /* Last harmonic below fs/8 */
+#define TPDF_NOISE  0.25                            /* LSB^2 */
+#define LEVEL_LOW   1U
+#define LEVEL_HIGH  SINE_LEVEL_MAX
+
+typedef struct{
+    double thd;
+    double thdn;
+    double inband;
+    double model;
+}THDN_T;
+
+static const char *const ditherNames[DITHER_NUM] = {"off", "tpdf", "shape1", "shape2"};
+static HOST_TASK genTask;
+static INT16U capture[TEST_N];
+static double power[TEST_N / 2 + 1];
+static int fails;
+
+static void check(int ok, const char *what){
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok){
+        fails++;
+    }else{
+    }
+}
+static THDN_T measure(DITHER_MODE mode, INT8U level){
+    THDN_T r;
+    double fund;
+    double harm = 0.0;
+    double all;
+
+    DitherSet(mode);
+    SinewaveSetLevel(level);
+    HostDmaCapture(&genTask, capture, TEST_N);
+    for(INT32U k = 0; k <= (TEST_N / 2); k++){
+        power[k] = 0.0;
+    }
+    SpecAddPower(capture, TEST_N, FALSE, power);
+    fund = power[TEST_K0];
+    for(INT32U h = 2; h <= TEST_HARM; h++){
+        harm += power[h * TEST_K0];
+    }
+    all = SpecBand(power, 1, TEST_N / 2) - fund;
+    r.thd = SpecDb(harm, fund);
+    r.thdn = SpecDb(all, fund);
+    r.inband = SpecDb(SpecBand(power, 1, TEST_N / 8) - fund, fund);
+    r.model = SpecDb(TPDF_NOISE, 2.0 * fund / ((double)TEST_N * TEST_N));   /* Sine A^2/2 */
+    printf("level %2u %-7s THD %7.1fdB  THD+N %7.1fdB  N<fs/8 %7.1fdB  model %7.1fdB\n",
+           level, ditherNames[mode], r.thd, r.thdn, r.inband, r.model);
+    return r;
+}
+
+int main(void){
+    THDN_T low[DITHER_NUM];
+    THDN_T high[DITHER_NUM];
+
+    SineGenInit();
+    HostTaskStart(&genTask, sineGenTask);
+    SampleRateSet(TEST_FS);
+    SinewaveSetFreq(TEST_FREQ);
+    for(INT8U m = 0; m < DITHER_NUM; m++){
+        low[m] = measure((DITHER_MODE)m, LEVEL_LOW);
+    }
+    for(INT8U m = 0; m < DITHER_NUM; m++){
+        high[m] = measure((DITHER_MODE)m, LEVEL_HIGH);
+    }
+    for(INT8U m = DITHER_TPDF; m < DITHER_NUM; m++){
+        printf("level %2u %-7s harmonics %.1fdB below off\n", LEVEL_LOW, ditherNames[m],
+               low[DITHER_OFF].thd - low[m].thd);
+        check(low[m].thd < (low[DITHER_OFF].thd - 20.0), "dither takes the low level harmonics down 20dB");
+    }
+    check(fabs(low[DITHER_TPDF].thdn - low[DITHER_TPDF].model) < 1.0,
+          "low level TPDF THD+N within 1dB of the model");
+    check(fabs(high[DITHER_TPDF].thdn - high[DITHER_TPDF].model) < 1.0,
+          "full level TPDF THD+N within 1dB of the model");
+    check(low[DITHER_SHAPE1].inband < (low[DITHER_TPDF].inband - 3.0),
+          "first order shaping lowers the noise below fs/8 3dB");
+    check(low[DITHER_SHAPE2].inband < low[DITHER_SHAPE1].inband,
+          "second order shaping lowers it further");
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails != 0;
+}
@@ -0,0 +1,138 @@
+/*****************************************************************************************
+* test_dma_handoff - Block handoff from DMA0_DMA16_IRQHandler() to DMAReadyPend()
+* The ISR of DMA.c is called for each half and full major loop, with CSR DONE as the
+* channel leaves it, and a consumer host task pends for the blocks as sineGenTask does.
+* The task queue holds DMA_BLOCK_Q_SIZE messages, as sineGenTask is created with:
+*   running  - the consumer picks each block up at once, the blocks alternate 0 and 1
+*              with consecutive sequence numbers and no lag
+*   stalled  - the consumer sleeps while a full queue of blocks is released, each is
+*              delivered once and in order when it runs, the lag is the stall
+*   overrun  - the consumer sleeps over more blocks than the queue holds, the extra
+*              are dropped, the ones queued are still delivered intact and in order,
+*              and the gap shows as missed at the next block
+* BLOCK_TICKS is a block at 48kHz in 1ms OS ticks.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include "../source/DMA.c"
+
+#define BLOCK_TICKS  21U
+#define LOG_SIZE     64U
+#define OVERRUN      (3U * DMA_BLOCK_Q_SIZE)    /* Past the queue and the slot ring */
+
+static OS_TCB consumerTCB;
+static HOST_TASK consumerTask;
+static DMA_BLOCK_INFO blockLog[LOG_SIZE];
+static INT32U blockLogN;
+static INT8U dmaHalf;                       /* Next interrupt is the half major loop */
+static int fails;
+
+static void check(int ok, const char *what){
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok){
+        fails++;
+    }else{
+    }
+}
+/* Records every block it is given, as sineGenTask fills them */
+static void consumer(void *p_arg){
+    OS_ERR os_err;
+    (void)p_arg;
+    while(1){
+        (void)DMAReadyPend(0, &blockLog[blockLogN % LOG_SIZE], &os_err);
+        if(os_err == OS_ERR_NONE){
+            blockLogN++;
+        }else{
+        }
+    }
+}
+/* A block of time, then the next interrupt of the ping-pong major loop */
+static void dmaInterrupt(void){
+    hostTick += BLOCK_TICKS;
+    if(dmaHalf){
+        DMA0->TCD[DMA_CH].CSR &= ~DMA_CSR_DONE_MASK;
+    }else{
+        DMA0->TCD[DMA_CH].CSR |= DMA_CSR_DONE_MASK;
+    }
+    dmaHalf = !dmaHalf;
+    DMA0_DMA16_IRQHandler();
+}
+/* TRUE if the log from first has n blocks, consecutive from seq and alternating */
+static int logInOrder(INT32U first, INT32U n, INT32U seq){
+    int ok = ((blockLogN - first) == n);
+    for(INT32U i = 0; ok && (i < n); i++){
+        ok = (blockLog[first + i].seq == (seq + i)) &&
+             (blockLog[first + i].index == ((blockLog[first].index + i) & 1U));
+    }
+    return ok;
+}
+
+static void testRunning(void){
+    DMA_STATS stats;
+    INT32U first = blockLogN;
+    for(INT32U i = 0; i < 16; i++){
+        dmaInterrupt();
+        HostTaskResume(&consumerTask);
+    }
+    DMAGetStats(&stats);
+    printf("running: %u released, %u dropped, %u missed, max lag %u ticks\n", (unsigned)stats.released,
+           (unsigned)stats.dropped, (unsigned)stats.missed, (unsigned)stats.max_lag);
+    check(logInOrder(first, 16, 1) && (blockLog[first].index == 0), "running blocks in order, 0 then 1");
+    check((stats.dropped == 0) && (stats.missed == 0) && (stats.max_lag == 0), "running drops and lags nothing");
+}
+
+static void testStalled(void){
+    DMA_STATS stats;
+    INT32U first = blockLogN;
+    INT32U seq = blockLog[first - 1].seq + 1;
+    for(INT32U i = 0; i < DMA_BLOCK_Q_SIZE; i++){
+        dmaInterrupt();
+    }
+    HostTaskResume(&consumerTask);
+    DMAGetStats(&stats);
+    printf("stalled %u blocks: %u delivered, %u dropped, %u missed, max lag %u ticks\n",
+           DMA_BLOCK_Q_SIZE, (unsigned)(blockLogN - first), (unsigned)stats.dropped,
+           (unsigned)stats.missed, (unsigned)stats.max_lag);
+    check(logInOrder(first, DMA_BLOCK_Q_SIZE, seq), "a full queue is delivered once and in order");
+    check((stats.dropped == 0) && (stats.missed == 0), "a full queue drops nothing");
+    check(stats.max_lag == ((DMA_BLOCK_Q_SIZE - 1) * BLOCK_TICKS), "lag of the oldest block is the stall");
+}
+
+static void testOverrun(void){
+    DMA_STATS before;
+    DMA_STATS stats;
+    INT32U first = blockLogN;
+    INT32U seq = blockLog[first - 1].seq + 1;
+    DMAGetStats(&before);
+    for(INT32U i = 0; i < OVERRUN; i++){
+        dmaInterrupt();
+    }
+    HostTaskResume(&consumerTask);
+    DMAGetStats(&stats);
+    printf("overrun %u blocks: %u delivered, %u dropped\n", OVERRUN,
+           (unsigned)(blockLogN - first), (unsigned)(stats.dropped - before.dropped));
+    check(logInOrder(first, DMA_BLOCK_Q_SIZE, seq), "queued blocks intact and in order after an overrun");
+    check((stats.dropped - before.dropped) == (OVERRUN - DMA_BLOCK_Q_SIZE), "blocks past the queue dropped");
+    check(stats.max_lag == ((OVERRUN - 1) * BLOCK_TICKS), "lag of the oldest block is the stall");
+
+    first = blockLogN;
+    dmaInterrupt();
+    HostTaskResume(&consumerTask);
+    DMAGetStats(&stats);
+    printf("overrun: next block seq %u, %u missed\n", (unsigned)blockLog[first].seq, (unsigned)stats.missed);
+    check(logInOrder(first, 1, seq + OVERRUN), "next block carries on the sequence");
+    check(stats.missed == (OVERRUN - DMA_BLOCK_Q_SIZE), "dropped blocks counted as missed");
+}
+
+int main(void){
+    DMAInit();
+    DMASetConsumer(&consumerTCB);
+    HostQSetSize(DMA_BLOCK_Q_SIZE);
+    HostTaskStart(&consumerTask, consumer);
+    dmaHalf = TRUE;
+    testRunning();
+    testStalled();
+    testOverrun();
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails != 0;
+}
@@ -0,0 +1,279 @@
+/*****************************************************************************************
+* test_lcd_screens - Golden screens and LCD bus writes of each UI interaction
+* The app, key, parameter and LCD tasks of AppLab3.c and LcdLayered.c run as host tasks
+* on LcdEmu. Each step feeds key events, or a level as the touch task would post it,
+* runs the tasks until they wait again and records what is on the glass, the cursor
+* and the lcdWrite() calls and frames the step cost. The record is compared with
+* golden/lcd_screens.txt, run with -u to write it after an intended change.
+* The DAC, EEPROM, keypad and TSI modules are stubbed here, PulseTrain.c is the real one.
+* The channel B level must follow a sine level set while the quadrature output is on.
+* The pulse duty shows in the mode it is set in, level, permille or width.
+* * + 0 must fire the burst once, from appParamTask.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#define main appLab3Main                    /* The target main(), not run */
+#include "../source/AppLab3.c"
+#undef main
+#include "../board/LcdLayered.c"
+#include "LcdEmu.h"
+
+#define GOLDEN_FILE "golden/lcd_screens.txt"
+#define RECORD_SIZE 8192
+#define KEY_SCRIPT_SIZE 32
+
+/*****************************************************************************************
+* Module stubs, the sine generator keeps only what it is set to
+*****************************************************************************************/
+static INT16U sineFreq;
+static INT8U sineLevel;
+static WAVE_T sineWave;
+static INT8U sineDuty;
+
+void SineGenInit(void){}
+void SinewaveSetFreq(INT16U freq){ sineFreq = freq; }
+void SinewaveSetLevel(INT8U level){ sineLevel = level; }
+INT16U SinewaveGetFreq(void){ return sineFreq; }
+INT8U SinewaveGetLevel(void){ return sineLevel; }
+void WaveformSetType(WAVE_T wave){ sineWave = wave; }
+WAVE_T WaveformGetType(void){ return sineWave; }
+void WaveformSetDuty(INT8U duty){ sineDuty = duty; }
+INT8U WaveformGetDuty(void){ return sineDuty; }
+void SweepStart(const SWEEP_CFG *cfg){ (void)cfg; }
+void SweepStop(void){}
+INT8U SweepIsActive(void){ return FALSE; }
+void ModulationSet(const MOD_CFG *cfg){ (void)cfg; }
+void BurstSet(const BURST_CFG *cfg){ (void)cfg; }
+static INT32U burstFires;
+void BurstTrigger(void){ burstFires++; }
+static DUAL_CFG dualCfg;
+void DualSet(const DUAL_CFG *cfg){ dualCfg = *cfg; }
+void SineCalSet(const DAC_CAL *cal){ (void)cal; }
+void SineCalGet(DAC_CAL *cal){ (void)cal; }
+void SineCalDrive(INT16U code){ (void)code; }
+INT16U AwgGetLength(void){ return 0; }              /* No table, the * cycle skips ARB */
+void AwgLoaderInit(void){}
+INT8U SineCalCompute(INT16U mv_lo, INT16U mv_hi, DAC_CAL *cal){ (void)mv_lo; (void)mv_hi; (void)cal; return FALSE; }
+void DMAInit(void){}
+void EEPROMInit(void){}
+SAVED_CONFIG EEPROMGetConfig(void){
+    SAVED_CONFIG config;
+    memset(&config, 0, sizeof(config));
+    config.state = 0;
+    config.sine_freq = DEFAULT_FREQ;
+    config.sine_level = DEFAULT_LEVEL;
+    config.pulse_freq = DEFAULT_FREQ;
+    config.pulse_level = DEFAULT_LEVEL;
+    config.sine_wave = WAVE_SINE;
+    config.sine_duty = DEFAULT_DUTY;
+    config.pulse_duty_mode = PULSE_DUTY_LEVEL;
+    return config;
+}
+void EEPROMSetConfig(const SAVED_CONFIG *config){ (void)config; }
+INT8U EEPROMGetCal(DAC_CAL *cal){ memset(cal, 0, sizeof(*cal)); return FALSE; }
+void EEPROMSetCal(const DAC_CAL *cal){ (void)cal; }
+void TSIInit(void){}
+OS_FLAGS TSIPend(OS_TICK tout, OS_ERR *os_err){ (void)tout; *os_err = OS_ERR_TIMEOUT; return 0; }
+void TSIGetPad(INT8U channel, TSI_PAD *pad){ (void)channel; pad->delta = 0; pad->touched = FALSE; }
+void K65TWR_BootClock(void){}
+void GpioDBugBitsInit(void){}
+/*****************************************************************************************
+* Keypad stub, events are scripted by the steps
+*****************************************************************************************/
+static const INT8C keyCodes[16] =
+   {'1','2','3',DC1,'4','5','6',DC2,'7','8','9',DC3,'*','0','#',DC4};
+static KEY_EVENT keyScript[KEY_SCRIPT_SIZE];
+static INT32U keyIn;
+static INT32U keyOut;
+
+void KeyInit(void){}
+INT16U KeyCodeMask(INT8C code){
+    INT16U mask = 0;
+    for(INT8U i = 0; i < 16; i++){
+        if(keyCodes[i] == code){
+            mask = (INT16U)(1U << i);
+        }else{
+        }
+    }
+    return mask;
+}
+void KeyEventWait(INT16U tout, OS_ERR *os_err){
+    (void)tout;
+    while((keyIn == keyOut) && HostBlock()){
+    }
+    *os_err = OS_ERR_NONE;
+}
+INT8U KeyEventGet(KEY_EVENT *event){
+    INT8U got = FALSE;
+    if(keyOut != keyIn){
+        *event = keyScript[keyOut % KEY_SCRIPT_SIZE];
+        keyOut++;
+        got = TRUE;
+    }else{
+    }
+    return got;
+}
+static void keyEvent(INT8C code, KEY_EV_TYPE type, INT16U mask){
+    keyScript[keyIn % KEY_SCRIPT_SIZE].code = code;
+    keyScript[keyIn % KEY_SCRIPT_SIZE].type = type;
+    keyScript[keyIn % KEY_SCRIPT_SIZE].mask = mask;
+    keyScript[keyIn % KEY_SCRIPT_SIZE].ts = hostTick;
+    keyIn++;
+}
+/* Taps each key of keys, as uCOSKey sends a press and release */
+static void keyTaps(const char *keys){
+    for(; *keys != '\0'; keys++){
+        keyEvent(*keys, KEY_EV_PRESS, KeyCodeMask(*keys));
+        keyEvent(*keys, KEY_EV_RELEASE, KeyCodeMask(*keys));
+    }
+}
+/* * held and key added, the * release follows when both are up */
+static void keyChord(INT8C key){
+    keyEvent('*', KEY_EV_PRESS, KeyCodeMask('*'));
+    keyEvent(0, KEY_EV_CHORD, KeyCodeMask('*')|KeyCodeMask(key));
+    keyEvent('*', KEY_EV_RELEASE, KeyCodeMask('*'));
+}
+/*****************************************************************************************
+* Steps
+*****************************************************************************************/
+static HOST_TASK keyTask;
+static HOST_TASK paramTask;
+static HOST_TASK lcdTask;
+static char record[RECORD_SIZE];
+static size_t recordLen;
+static LCD_BUS_STATS lastStats;             /* Zero at boot, LcdInit() is counted */
+
+/* Runs the tasks in priority order until all wait, then records the glass */
+static void step(const char *name){
+    LCD_BUS_STATS before = lastStats;
+    LCD_BUS_STATS after;
+    LCD_EMU_CURSOR cursor;
+    INT8C row[LCD_EMU_COLS + 1];
+
+    HostTaskResume(&lcdTask);
+    HostTaskResume(&keyTask);
+    HostTaskResume(&paramTask);
+    HostTaskResume(&lcdTask);
+    LcdGetBusStats(&after);
+    lastStats = after;
+    cursor = LcdEmuGetCursor();
+    recordLen += (size_t)snprintf(&record[recordLen], RECORD_SIZE - recordLen,
+                                  "== %s\n", name);
+    for(INT8U r = 1; r <= LCD_EMU_ROWS; r++){
+        LcdEmuGetRow(r, row);
+        recordLen += (size_t)snprintf(&record[recordLen], RECORD_SIZE - recordLen,
+                                      "|%s|\n", row);
+    }
+    recordLen += (size_t)snprintf(&record[recordLen], RECORD_SIZE - recordLen,
+                                  "cursor %u,%u on %u blink %u\nwrites %u frames %u\n",
+                                  cursor.row, cursor.col, cursor.on, cursor.blink,
+                                  (unsigned)(after.writes - before.writes),
+                                  (unsigned)(after.frames - before.frames));
+    printf("%-24s %4u writes %2u frames\n", name, (unsigned)(after.writes - before.writes),
+           (unsigned)(after.frames - before.frames));
+}
+
+int main(int argc, char **argv){
+    static char golden[RECORD_SIZE];
+    FILE *file;
+    size_t len;
+    int fail = 0;
+
+    appStartTask((void *)0);                /* Returns at its OSTaskDel() */
+    HostTaskStart(&lcdTask, lcdLayeredTask);
+    HostTaskStart(&keyTask, appProcessKeyTask);
+    HostTaskStart(&paramTask, appParamTask);
+    step("boot");
+    keyTaps("250");
+    step("entry 250");
+    keyTaps("#");
+    step("enter 250 Hz");
+    keyTaps("*");
+    step("wave triangle");
+    keyTaps("***");
+    step("wave square");
+    keyTaps("30*");
+    step("square duty 30");
+    appParamPost(PARAM_SET_LEVEL, SINEWAVE, PARAM_SAVE, 20);
+    step("touch level 20");
+    appParamPost(PARAM_SET_LEVEL, SINEWAVE, PARAM_SAVE, 5);
+    step("touch level 5");
+    keyTaps("45");
+    keyTaps("\x13");
+    step("entry 45 backspace");
+    keyTaps("\x13");
+    step("backspace to empty");
+    keyTaps("\x12");
+    step("pulse mode");
+    appParamPost(PARAM_SET_LEVEL, PULSE_TRAIN, PARAM_SAVE, 20);
+    step("pulse level 100%");
+    keyChord('#');
+    step("mute");
+    keyChord('#');
+    step("unmute");
+    keyTaps("12#");
+    step("pulse 12 Hz");
+    keyTaps("250*");
+    step("pulse duty 25.0%");
+    keyTaps("1500");
+    keyChord('1');
+    step("pulse width 1500us");
+    keyTaps("*");
+    step("pulse duty level");
+    keyTaps("10000");
+    keyChord('1');
+    step("pulse width 10.0ms");
+    keyTaps("\x11");
+    step("sine mode");
+    keyTaps("*");
+    step("wave skips ARB");
+    keyEvent(DC1, KEY_EV_PRESS, KeyCodeMask(DC1));
+    keyEvent(DC1, KEY_EV_LONG, KeyCodeMask(DC1));
+    keyEvent(DC1, KEY_EV_RELEASE, KeyCodeMask(DC1));
+    step("hold A, B on");
+    appParamPost(PARAM_SET_LEVEL, SINEWAVE, PARAM_SAVE, 15);
+    step("touch level 15");
+    if(!dualCfg.on || (dualCfg.level != 15)){
+        printf("FAIL B level %u, on %u, does not follow A's 15\n", dualCfg.level, dualCfg.on);
+        fail = 1;
+    }else{
+    }
+    keyChord('0');
+    step("burst fire");
+    if(burstFires != 1){
+        printf("FAIL burst fired %u times by appParamTask, not once\n", (unsigned)burstFires);
+        fail = 1;
+    }else{
+    }
+    keyTaps("\x14");
+    step("defaults");
+
+    if((argc > 1) && (strcmp(argv[1], "-u") == 0)){
+        file = fopen(GOLDEN_FILE, "w");
+        if(file != NULL){
+            fwrite(record, 1, recordLen, file);
+            fclose(file);
+            printf("wrote %s\n", GOLDEN_FILE);
+        }else{
+            printf("FAIL cannot write %s\n", GOLDEN_FILE);
+            fail = 1;
+        }
+    }else{
+        file = fopen(GOLDEN_FILE, "r");
+        len = 0;
+        if(file != NULL){
+            len = fread(golden, 1, sizeof(golden) - 1, file);
+            fclose(file);
+        }else{
+        }
+        golden[len] = '\0';
+        if((len != recordLen) || (memcmp(golden, record, len) != 0)){
+            printf("FAIL screens differ from %s, got:\n%s", GOLDEN_FILE, record);
+            fail = 1;
+        }else{
+        }
+    }
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
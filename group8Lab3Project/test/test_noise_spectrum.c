@@ -0,0 +1,150 @@
+/*****************************************************************************************
+* test_noise_spectrum - Spectra and levels of the white and pink noise kernels
+* sineGenTask runs as a host task at its own noise rate, NOISE_FS, and its blocks are
+* captured. Spectra are averaged over Hann windowed segments:
+*   white - 16 equal bands to fs/2 must be within 1dB of each other
+*   pink  - octave bands from 47Hz to 12kHz must fall 3dB an octave, within 0.5dB,
+*           and each within 1dB of the fitted line
+*   RMS   - both must match the RMS of the sine at the same level within 5%, as
+*           NOISE_WHITE_GAIN and NOISE_PINK_GAIN are set for, with no clipped sample
+* The level leaves the pink peaks clear of the DAC range.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include "../source/SineGeneration.c"
+#include "dma_host.h"
+#include "spectrum.h"
+
+#define TEST_LEVEL   5U
+#define TEST_N       (1UL << 20)        /* 22s at NOISE_FS */
+#define WHITE_SEG    4096U
+#define WHITE_BANDS  16U
+#define PINK_SEG     8192U
+#define PINK_LO_BIN  8U                 /* 47Hz at NOISE_FS */
+#define PINK_OCTAVES 8U                 /* To 12kHz */
+
+static HOST_TASK genTask;
+static INT16U capture[TEST_N];
+static double power[PINK_SEG / 2 + 1];
+static int fails;
+
+static void check(int ok, const char *what){
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok){
+        fails++;
+    }else{
+    }
+}
+/* Captures n samples of wave, returns the RMS about the mean in DAC codes */
+static double captureWave(WAVE_T wave, INT32U n, INT32U *clipped){
+    double mean = 0.0;
+    double sq = 0.0;
+    WaveformSetType(wave);
+    HostDmaCapture(&genTask, capture, n);
+    *clipped = 0;
+    for(INT32U i = 0; i < n; i++){
+        mean += capture[i];
+        if((capture[i] == 0) || (capture[i] == (DAC_CODES - 1))){
+            (*clipped)++;
+        }else{
+        }
+    }
+    mean /= n;
+    for(INT32U i = 0; i < n; i++){
+        sq += (capture[i] - mean) * (capture[i] - mean);
+    }
+    return sqrt(sq / n);
+}
+/* Averaged power of the capture in segments of seg */
+static void welch(INT32U seg){
+    for(INT32U k = 0; k <= (seg / 2); k++){
+        power[k] = 0.0;
+    }
+    for(INT32U i = 0; (i + seg) <= TEST_N; i += seg){
+        SpecAddPower(&capture[i], seg, TRUE, power);
+    }
+}
+
+static void testRms(void){
+    double sine;
+    double white;
+    double pink;
+    INT32U clip_w;
+    INT32U clip_p;
+    INT32U clip_s;
+
+    sine = captureWave(WAVE_SINE, 48000, &clip_s);
+    white = captureWave(WAVE_WHITE, TEST_N, &clip_w);
+    pink = captureWave(WAVE_PINK, TEST_N, &clip_p);
+    printf("RMS level %u: sine %.1f white %.1f (%+.2f%%) pink %.1f (%+.2f%%) codes\n",
+           TEST_LEVEL, sine, white, 100.0 * (white / sine - 1.0), pink, 100.0 * (pink / sine - 1.0));
+    check((clip_s == 0) && (clip_w == 0) && (clip_p == 0), "no clipped samples");
+    check(fabs(white / sine - 1.0) < 0.05, "white RMS matches the sine within 5%");
+    check(fabs(pink / sine - 1.0) < 0.05, "pink RMS matches the sine within 5%");
+}
+
+static void testWhite(void){
+    INT32U per = (WHITE_SEG / 2) / WHITE_BANDS;
+    double band;
+    double lo = 1e300;
+    double hi = 0.0;
+    INT32U clipped;
+
+    (void)captureWave(WAVE_WHITE, TEST_N, &clipped);
+    welch(WHITE_SEG);
+    for(INT32U b = 0; b < WHITE_BANDS; b++){
+        band = SpecBand(power, (b == 0) ? 2 : b * per, (b + 1) * per - 1) /
+               (double)(((b + 1) * per) - ((b == 0) ? 2 : b * per));
+        lo = (band < lo) ? band : lo;
+        hi = (band > hi) ? band : hi;
+    }
+    printf("white: %u bands to %ukHz within %.2fdB\n", WHITE_BANDS, NOISE_FS / 2000, SpecDb(hi, lo));
+    check(SpecDb(hi, lo) < 1.0, "white bands within 1dB");
+}
+
+static void testPink(void){
+    double db[PINK_OCTAVES];
+    double sx = 0.0;
+    double sy = 0.0;
+    double sxx = 0.0;
+    double sxy = 0.0;
+    double slope;
+    double icpt;
+    double worst = 0.0;
+    INT32U lo;
+    INT32U clipped;
+
+    (void)captureWave(WAVE_PINK, TEST_N, &clipped);
+    welch(PINK_SEG);
+    for(INT32U j = 0; j < PINK_OCTAVES; j++){
+        lo = PINK_LO_BIN << j;
+        db[j] = 10.0 * log10(SpecBand(power, lo, 2 * lo - 1) / lo);
+        sx += j;
+        sy += db[j];
+        sxx += (double)j * j;
+        sxy += j * db[j];
+    }
+    slope = (PINK_OCTAVES * sxy - sx * sy) / (PINK_OCTAVES * sxx - sx * sx);
+    icpt = (sy - slope * sx) / PINK_OCTAVES;
+    for(INT32U j = 0; j < PINK_OCTAVES; j++){
+        double dev = fabs(db[j] - (icpt + slope * j));
+        printf("pink: octave from %5.0fHz %+6.2fdB from the fit\n",
+               (double)(PINK_LO_BIN << j) * NOISE_FS / PINK_SEG, db[j] - (icpt + slope * j));
+        worst = (dev > worst) ? dev : worst;
+    }
+    printf("pink: slope %.2fdB/octave, worst octave %.2fdB off the fit\n", slope, worst);
+    check(fabs(slope + 3.0) < 0.5, "pink falls 3dB an octave within 0.5dB");
+    check(worst < 1.0, "pink octaves within 1dB of the fit");
+}
+
+int main(void){
+    SineGenInit();
+    HostTaskStart(&genTask, sineGenTask);
+    SinewaveSetFreq(1000);
+    SinewaveSetLevel(TEST_LEVEL);
+    testRms();
+    testWhite();
+    testPink();
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails != 0;
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************************
+* test_pulse_solve - Frequency error of the FTM3 settings pulseSolve() picks
+* Every frequency of the UI range is solved and the frequency the setting makes is
+* compared with the one asked for. Prints the worst error and where it is and fails
+* over PULSE_ERR_PPM_MAX. Also checks PulseTrainInit() leaves channel 3 in edge aligned
+* PWM, not input capture, and that a prescaler change waits for the overflow. At 1000
+* permille CnV must be MOD+1 at every frequency, a constant high.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include <math.h>
+#include "../source/PulseTrain.c"
+
+#define FREQ_MIN 10
+#define FREQ_MAX 10000
+#define PULSE_ERR_PPM_MAX 100.0
+
+int main(void){
+    PULSE_SETTING set;
+    INT32U ticks;
+    double actual;
+    double ppm;
+    double worst = 0.0;
+    INT16U worst_freq = 0;
+    int fail = 0;
+
+    for(INT32U f = FREQ_MIN; f <= FREQ_MAX; f++){
+        pulseSolve((INT16U)f, &set);
+        ticks = pulseCounts(&set) << set.ps;
+        actual = (double)BUS_FREQ / ticks;
+        ppm = fabs(actual - f) * 1e6 / f;
+        if(ppm > worst){
+            worst = ppm;
+            worst_freq = (INT16U)f;
+        }else{
+        }
+        CurrentSpecs.duty_mode = PULSE_DUTY_PERMILLE;
+        CurrentSpecs.duty = PULSE_PERMILLE_MAX;
+        if(pulseCnV(&set) != ((INT32U)set.mod + 1)){
+            printf("FAIL %u Hz: 100%% CnV %u, MOD %u\n", (unsigned)f, (unsigned)pulseCnV(&set), set.mod);
+            fail = 1;
+        }else{
+        }
+        if((set.mod < 1) || (set.ps > PULSE_PS_MAX)){
+            printf("FAIL %u Hz: mod %u ps %u\n", (unsigned)f, set.mod, set.ps);
+            fail = 1;
+        }else{
+        }
+    }
+    printf("worst error %.1f ppm at %u Hz over %u-%u Hz\n", worst, worst_freq,
+           FREQ_MIN, FREQ_MAX);
+    if(worst > PULSE_ERR_PPM_MAX){
+        printf("FAIL worst error over %.0f ppm\n", PULSE_ERR_PPM_MAX);
+        fail = 1;
+    }else{
+    }
+
+    PulseTrainInit();
+    if((FTM3->CONTROLS[3].CnSC & (FTM_CnSC_MSB_MASK|FTM_CnSC_ELSB_MASK|FTM_CnSC_ELSA_MASK)) !=
+       (FTM_CnSC_MSB_MASK|FTM_CnSC_ELSB_MASK)){
+        printf("FAIL CnSC 0x%08x is not high-true PWM\n", (unsigned)FTM3->CONTROLS[3].CnSC);
+        fail = 1;
+    }else{
+    }
+    PulseTrainSet(1000, 10);
+    if((FTM3->SC & (FTM_SC_CLKS_MASK|FTM_SC_CPWMS_MASK)) != FTM_SC_CLKS(1)){
+        printf("FAIL FTM3 not started edge aligned, SC 0x%08x\n", (unsigned)FTM3->SC);
+        fail = 1;
+    }else{
+    }
+    PulseTrainSetFreq(10);                      /* Needs a larger prescaler */
+    if(((FTM3->SC & FTM_SC_TOIE_MASK) == 0) || (pulseScNext == FTM3->SC)){
+        printf("FAIL prescaler change not left to the overflow, SC 0x%08x\n", (unsigned)FTM3->SC);
+        fail = 1;
+    }else{
+    }
+    FTM3_IRQHandler();
+    if((FTM3->SC & (FTM_SC_TOIE_MASK|FTM_SC_CPWMS_MASK)) != 0){
+        printf("FAIL overflow left SC 0x%08x\n", (unsigned)FTM3->SC);
+        fail = 1;
+    }else{
+    }
+    printf("%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
@@ -0,0 +1,160 @@
+/*****************************************************************************************
+* test_tsi_levels - Baseline, noise and threshold tracking of uCOSTSI.c
+* Count traces are fed through tsiProcScan() as tsiTask does with each scan result,
+* one call per scan sequence:
+*   drift - the untouched count creeps up, the baseline must follow with no touch
+*   noise - the touch offset must follow TSI_NOISE_MULT times the mean absolute
+*           deviation, release half of it, and never drop below the pad offset
+*   touch - a long touch and a hover above release must not move the baseline, a
+*           touch posts its flag once and the state only changes outside the band
+*   stray - an end of scan after the last pad of a sequence is cleared and counted,
+*           with no count posted and no scan started
+* The noise is a fixed uniform pseudo random sequence so the runs repeat.
+* 10/19/2026
+*****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "../source/uCOSTSI.c"
+
+#define PAD         BRD_PAD1_CH
+#define BASE_COUNT  0x1000U
+
+static INT32U rndState = 1;
+static int fails;
+
+/* Uniform noise in -amp..amp */
+static INT32S noise(INT32S amp){
+    rndState = rndState * 1103515245U + 12345U;
+    return (amp == 0) ? 0 : (INT32S)((rndState >> 16) % (INT32U)(2 * amp + 1)) - amp;
+}
+static void check(int ok, const char *what){
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if(!ok){
+        fails++;
+    }else{
+    }
+}
+/* Calibrates the pad at count and clears its flag */
+static void padReset(INT16U count){
+    tsiSensorLevels[PAD].offset = E1_TOUCH_OFFSET;
+    tsiChCalibration(PAD, count);
+    tsiFlags.flags = 0;
+}
+/* Feeds count for n sequences, returns the touch flags posted */
+static INT32U feed(INT16U count, INT32S amp, INT32U n){
+    INT32U posts = 0;
+    for(INT32U i = 0; i < n; i++){
+        tsiProcScan(PAD, (INT16U)((INT32S)count + noise(amp)));
+        if((tsiFlags.flags & (1U << PAD)) != 0){
+            posts++;
+            tsiFlags.flags = 0;
+        }else{
+        }
+    }
+    return posts;
+}
+
+static void testDrift(void){
+    INT32U posts = 0;
+    INT32S worst = 0;
+    INT32S err;
+    INT16U count = BASE_COUNT;
+
+    padReset(BASE_COUNT);
+    for(INT32U i = 0; i < 16000; i++){      /* +1000 counts, 1 count per 16 sequences */
+        count = (INT16U)(BASE_COUNT + i / 16);
+        posts += feed(count, 40, 1);
+        err = abs((INT32S)count - (INT32S)tsiSensorLevels[PAD].baseline);
+        if((i > 1000) && (err > worst)){
+            worst = err;
+        }else{
+        }
+    }
+    printf("drift: worst baseline lag %d counts, end baseline 0x%04x count 0x%04x\n",
+           (int)worst, tsiSensorLevels[PAD].baseline, count);
+    check(posts == 0, "drift posts no touch");
+    check(worst < 64, "baseline follows the drift within 64 counts");
+}
+
+static void testNoise(void){
+    INT32U posts;
+    INT32U offset;
+    INT32U expect;
+
+    padReset(BASE_COUNT);
+    posts = feed(BASE_COUNT, 8, 2000);
+    offset = tsiSensorLevels[PAD].threshold - tsiSensorLevels[PAD].baseline;
+    printf("noise +-8: offset %u release %u\n", (unsigned)offset,
+           (unsigned)(tsiSensorLevels[PAD].release - tsiSensorLevels[PAD].baseline));
+    check((posts == 0) && (offset == E1_TOUCH_OFFSET), "low noise keeps the pad offset");
+    check((tsiSensorLevels[PAD].release - tsiSensorLevels[PAD].baseline) == (E1_TOUCH_OFFSET >> TSI_HYST_SHIFT),
+          "low noise release is half the pad offset");
+
+    padReset(BASE_COUNT);
+    posts = feed(BASE_COUNT, 400, 4000);    /* Mean absolute deviation 200 */
+    offset = tsiSensorLevels[PAD].threshold - tsiSensorLevels[PAD].baseline;
+    expect = TSI_NOISE_MULT * 200U;
+    printf("noise +-400: offset %u, expected about %u, release %u\n", (unsigned)offset,
+           (unsigned)expect, (unsigned)(tsiSensorLevels[PAD].release - tsiSensorLevels[PAD].baseline));
+    check(posts == 0, "high noise posts no touch");
+    check((offset > expect * 85 / 100) && (offset < expect * 115 / 100),
+          "high noise offset follows the noise within 15%");
+    check((tsiSensorLevels[PAD].release - tsiSensorLevels[PAD].baseline) == (offset >> TSI_HYST_SHIFT),
+          "high noise release is half the offset");
+}
+
+static void testTouch(void){
+    INT32U posts;
+    INT16U base;
+    INT16U threshold;
+
+    padReset(BASE_COUNT);
+    (void)feed(BASE_COUNT, 8, 500);
+    base = tsiSensorLevels[PAD].baseline;
+    threshold = tsiSensorLevels[PAD].threshold;
+
+    posts = feed(BASE_COUNT + 2000, 8, 2000);   /* Held for 4 baseline time constants */
+    check(posts == 1, "a held touch posts once");
+    check(tsiSensorLevels[PAD].baseline == base, "baseline frozen while touched");
+    check(tsiSensorLevels[PAD].threshold == threshold, "threshold frozen while touched");
+    check(tsiSensorLevels[PAD].delta >= 1900, "delta reports the touch");
+
+    posts = feed(BASE_COUNT + 700, 8, 100);     /* In the band, release 512, touch 1024 */
+    check((posts == 0) && (tsiSensorLevels[PAD].state == T_ON), "band after touch stays on");
+    posts = feed(BASE_COUNT + 300, 8, 10);
+    check((posts == 0) && (tsiSensorLevels[PAD].state == T_OFF), "below release turns off");
+    base = tsiSensorLevels[PAD].baseline;       /* Tracks again below release */
+
+    posts = feed(BASE_COUNT + 700, 8, 2000);    /* Hover, in the band from below */
+    check((posts == 0) && (tsiSensorLevels[PAD].state == T_OFF), "hover in the band stays off");
+    check(tsiSensorLevels[PAD].baseline == base, "baseline frozen while hovering");
+
+    posts = feed(BASE_COUNT + 2000, 8, 10);
+    check(posts == 1, "a second touch posts again");
+}
+
+static void testStray(void){
+    OS_ERR os_err;
+    OS_MSG_SIZE msg_size;
+    TSI_STATS stats;
+
+    tsiSeqIndex = TSI_NUM_PADS;
+    TSI0->DATA = 0;
+    TSI0->GENCS = 0;
+    TSI0_IRQHandler();
+    TSIGetStats(&stats);
+    (void)OSTaskQPend(0, OS_OPT_PEND_NON_BLOCKING, &msg_size, (CPU_TS *)0, &os_err);
+    check((stats.strays == 1) && (stats.isr_count == 0), "stray end of scan counted as stray");
+    check(os_err != OS_ERR_NONE, "stray end of scan posts no count");
+    check((tsiSeqIndex == TSI_NUM_PADS) && (TSI0->DATA == 0), "stray end of scan starts no scan");
+    check((TSI0->GENCS & TSI_GENCS_EOSF_MASK) != 0, "stray end of scan flag cleared");
+}
+
+int main(void){
+    testDrift();
+    testNoise();
+    testTouch();
+    testStray();
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    return fails != 0;
+}
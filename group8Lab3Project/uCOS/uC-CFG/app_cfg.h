@@ -38,6 +38,11 @@
 */
 
 #define  APP_CFG_SERIAL_EN                          DEF_DISABLED //Change to disabled. TDM
+#define  APP_CFG_LCD_EMU_EN                         DEF_DISABLED //LcdLayered drives LcdEmu instead of PORTD
+#define  APP_CFG_KEY_IRQ_EN                         DEF_ENABLED  //Keypad wakes on PORTC interrupt, else 8ms polling
+#define  APP_CFG_SINE_LOAD_EN                       DEF_ENABLED  //DWT cycle count of each sinegen block fill
+#define  APP_CFG_DAC_BUFFER_EN                      DEF_DISABLED //DAC0 data buffer clocked by PDB0, no loops, bursts or DAC1
+#define  APP_CFG_AWG_LOAD_EN                        DEF_ENABLED  //ARB tables loaded over UART2, the TWR debug port
 
 
 /*
@@ -50,8 +55,10 @@
 #define APP_CFG_APP_PROCESS_KEY_TASK_PRIO    10u
 #define APP_CFG_TSI_TASK_PRIO                11U
 #define APP_CFG_APP_TOUCH_SENSOR_TASK_PRIO   12u
+#define APP_CFG_APP_PARAM_TASK_PRIO          13u
 #define APP_CFG_KEY_TASK_PRIO		         15u
 #define APP_CFG_SINEGEN_TASK_PRIO            16u
+#define APP_CFG_AWG_LOAD_TASK_PRIO           17u
 
 
 /*
@@ -63,9 +70,11 @@
 #define APP_CFG_START_TASK_STK_SIZE					 	128u
 #define APP_CFG_APP_PROCESS_KEY_TASK_STK_SIZE       	128u
 #define APP_CFG_APP_TOUCH_SENSOR_TASK_STK_SIZE       	128u
+#define APP_CFG_APP_PARAM_TASK_STK_SIZE              	128u
 #define APP_CFG_LCD_TASK_STK_SIZE   					128u
 #define APP_CFG_KEY_TASK_STK_SIZE   					128u
-#define APP_CFG_SINEGEN_TASK_STK_SIZE                   128u
+#define APP_CFG_SINEGEN_TASK_STK_SIZE                   256u
 #define APP_CFG_TSI_TASK_STK_SIZE                       128u
+#define APP_CFG_AWG_LOAD_TASK_STK_SIZE                  128u
 
 #endif